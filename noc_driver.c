@@ -1,60 +1,226 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
+#include <unistd.h>
+#include <signal.h>
+#include <pthread.h>
 #include "noc_header.h"
 
-int main(int argc, char *argv[]) {
+// Set by SIGINT/SIGTERM -- the optimiser stops at the next generation boundary and reports its best schedule
+static volatile sig_atomic_t stop_requested = 0;
 
-    int M_rows = 0, N_columns = 0;   // Mesh network dimensions
-    int num_cores = 0;               // Total number of cores in the mesh network
-    int num_io_pairs = 0;            // Number of io pairs available
-    int num_test_cores = 0;          // Number of test cores
-    NoC_node *noc_nodes;             // Pointer to NoC node structure array
-    IO_pairs *io_pairs;              // Pointer to IO pairs structure array
-    int *soln_vector;                // PSO solution vector
-    FILE *fptr;                      // Input file pointer
+static void handle_stop_signal (int signal_no) {
+    (void) signal_no;
+    stop_requested = 1;
+}
 
-    // Open and read input file
-    fptr = fopen ("input.txt","r");
-    if (fptr == NULL) {
-        printf(" ERROR: Could not open the input file\n");
-        return -1;
-    }
+int main(int argc, char *argv[]) {
+
+    NoC_design design;                       // Parsed SoC description (mesh, io pairs, test core parameters)
+    PSO_context context;                     // PSO run settings and random state
+    const char *input_file = "input.txt";    // SoC description file
+    const char *manifest_file = NULL;        // Batch manifest file (batch mode only)
+    int num_threads = 0;                     // Number of batch worker threads (0 --> one per online CPU)
+    Batch_job *jobs;                         // Batch jobs read from the manifest
+    int num_jobs = 0;                        // Number of batch jobs
+    int num_failed = 0;                      // Number of batch jobs that could not be scheduled
+    unsigned int seed = (unsigned int) time(0);   // Random seed (batch jobs use seed + job index)
+    int benchmark = 0;                       // Set to compare the search engines instead of a single run
+    int benchmark_runs = BENCHMARK_RUNS;     // Runs per engine in a benchmark
+    int serve = 0;                           // Set to serve requests on stdin/stdout instead of a single run
+    const char *socket_path = NULL;          // Unix socket to serve requests on (server mode only)
+    Schedule_server server;                  // Resident designs and tables (server mode only)
+    int place_io = 0;                        // Set to search for the io pair placement before scheduling
+    int place_rounds = PLACEMENT_ROUNDS;     // Rounds of the placement search
+    int place_generations = PLACEMENT_GENERATIONS;   // Generations of the inner search scoring each placement
+    IO_placement placement;                  // Best io pair placement found
+    struct sigaction stop_action;            // SIGINT/SIGTERM handler
 
     // All frequencies normalized wrt default test freq
     double freq[1] = {1.0};
 
-    // Read network dimensions, number of i/o pairs
-    fscanf (fptr,"%d\t%d", &M_rows, &N_columns);
-    fscanf (fptr,"%d", &num_io_pairs);
+    // PSO settings
+    init_pso_context (&context, stdout);
+    context.stop_requested = &stop_requested;
+
+    // Usage: noc_driver [options] [input file]
+    //        noc_driver [options] --batch <manifest file> [--threads N]
+    // Options: --generations N, --particles N, --seed S, --checkpoint <file>, --checkpoint-every K, --resume <file>, --time-limit SECONDS,
+    //          --refine-every K, --target-gap FRACTION, --routing xy|yx|west-first|torus, --validate, --check,
+    //          --export binary|csv|json, --export-file <file>, --engine pso|sa|ga|tabu|bnb [--threads N], --fixed-coefficients,
+    //          --random-start, --regions, --warm-start <schedule.nocs>, --profile <file> (profiling builds)
+    //        noc_driver [options] --benchmark [--benchmark-runs N] [input file]
+    //        noc_driver [options] --serve [--socket <path>]
+    //        noc_driver [options] --place-io [--place-rounds N] [--place-generations N] [--threads N] [input file]
+    for (int i = 1; i < argc; i++) {
+        if (strcmp (argv[i], "--batch") == 0 && i + 1 < argc)
+            manifest_file = argv[++i];
+        else if (strcmp (argv[i], "--threads") == 0 && i + 1 < argc)
+            num_threads = atoi (argv[++i]);
+        else if (strcmp (argv[i], "--generations") == 0 && i + 1 < argc)
+            context.max_generations = atoi (argv[++i]);
+        else if (strcmp (argv[i], "--particles") == 0 && i + 1 < argc) {
+            context.num_particles = atoi (argv[++i]);
+            if (context.num_particles < 1) {
+                printf(" ERROR: The swarm needs at least one particle\n");
+                return -1;
+            }
+        }
+        else if (strcmp (argv[i], "--seed") == 0 && i + 1 < argc)
+            seed = (unsigned int) strtoul (argv[++i], NULL, 10);
+        else if (strcmp (argv[i], "--checkpoint") == 0 && i + 1 < argc)
+            context.checkpoint_file = argv[++i];
+        else if (strcmp (argv[i], "--checkpoint-every") == 0 && i + 1 < argc)
+            context.checkpoint_interval = atoi (argv[++i]);
+        else if (strcmp (argv[i], "--resume") == 0 && i + 1 < argc)
+            context.resume_file = argv[++i];
+        else if (strcmp (argv[i], "--time-limit") == 0 && i + 1 < argc)
+            context.time_limit = atof (argv[++i]);
+        else if (strcmp (argv[i], "--refine-every") == 0 && i + 1 < argc)
+            context.refine_interval = atoi (argv[++i]);
+        else if (strcmp (argv[i], "--target-gap") == 0 && i + 1 < argc)
+            context.target_gap = atof (argv[++i]);
+        else if (strcmp (argv[i], "--validate") == 0)
+            context.validate = 1;
+        else if (strcmp (argv[i], "--check") == 0)
+            context.check = 1;
+        else if (strcmp (argv[i], "--export-file") == 0 && i + 1 < argc)
+            context.export_file = argv[++i];
+        else if (strcmp (argv[i], "--export") == 0 && i + 1 < argc) {
+            context.export_format = find_export_format (argv[++i]);
+            if (context.export_format < 0) {
+                printf(" ERROR: Unknown export format %s\n", argv[i]);
+                return -1;
+            }
+        }
+        else if (strcmp (argv[i], "--fixed-coefficients") == 0)
+            context.adaptive = 0;
+        else if (strcmp (argv[i], "--random-start") == 0)
+            context.seeding = 0;
+        else if (strcmp (argv[i], "--warm-start") == 0 && i + 1 < argc)
+            context.warm_start_file = argv[++i];
+        else if (strcmp (argv[i], "--regions") == 0)
+            context.hierarchical = 1;
+        else if (strcmp (argv[i], "--profile") == 0 && i + 1 < argc)
+            context.profile_file = argv[++i];
+        else if (strcmp (argv[i], "--serve") == 0)
+            serve = 1;
+        else if (strcmp (argv[i], "--socket") == 0 && i + 1 < argc)
+            socket_path = argv[++i];
+        else if (strcmp (argv[i], "--place-io") == 0)
+            place_io = 1;
+        else if (strcmp (argv[i], "--place-rounds") == 0 && i + 1 < argc)
+            place_rounds = atoi (argv[++i]);
+        else if (strcmp (argv[i], "--place-generations") == 0 && i + 1 < argc)
+            place_generations = atoi (argv[++i]);
+        else if (strcmp (argv[i], "--benchmark") == 0)
+            benchmark = 1;
+        else if (strcmp (argv[i], "--benchmark-runs") == 0 && i + 1 < argc)
+            benchmark_runs = atoi (argv[++i]);
+        else if (strcmp (argv[i], "--engine") == 0 && i + 1 < argc) {
+            context.engine = find_search_engine (argv[++i]);
+            if (context.engine < 0) {
+                printf(" ERROR: Unknown search engine %s\n", argv[i]);
+                return -1;
+            }
+        }
+        else if (strcmp (argv[i], "--routing") == 0 && i + 1 < argc) {
+            context.routing = find_routing_algorithm (argv[++i]);
+            if (context.routing < 0) {
+                printf(" ERROR: Unknown routing algorithm %s\n", argv[i]);
+                return -1;
+            }
+        }
+        else
+            input_file = argv[i];
+    }
+
+#ifndef NOC_PROFILE
+    if (context.profile_file != NULL) {
+        printf(" WARNING: --profile needs a build with -DNOC_PROFILE, no profile is recorded\n");
+        context.profile_file = NULL;
+    }
+#endif
 
-    // Allocate memory for noc nodes array
-    num_cores = M_rows * N_columns;
-    noc_nodes = (NoC_node *) malloc (num_cores * sizeof (NoC_node));
+    // The exact solver uses as many threads as the batch pool would
+    context.num_threads = num_threads;
 
-    // Allocate memory for i/o pairs array
-    io_pairs = (IO_pairs *) malloc (num_io_pairs * sizeof (IO_pairs));
+    // A checkpoint file without an interval checkpoints every generation
+    if (context.checkpoint_file != NULL && context.checkpoint_interval <= 0)
+        context.checkpoint_interval = 1;
 
-    // Initialize all the nodes (NoC tiles) in the network by assigning cores and ids
-    initialize_nodes (noc_nodes, num_cores, M_rows, N_columns);
+    // SIGINT/SIGTERM end the run at the next generation boundary instead of killing it
+    memset (&stop_action, 0, sizeof (stop_action));
+    stop_action.sa_handler = handle_stop_signal;
+    sigemptyset (&stop_action.sa_mask);
+    sigaction (SIGINT, &stop_action, NULL);
+    sigaction (SIGTERM, &stop_action, NULL);
 
-    // Configure i/o pairs and store i/o pair info in io_pairs array for quick ref
-    configure_io_pairs (fptr, io_pairs, noc_nodes, num_io_pairs);
+    // Server mode: keep designs and tables resident and answer requests (stdin/stdout, or clients of a Unix socket)
+    if (serve || socket_path != NULL) {
+        seed_pso_context (&context, seed);
+        init_schedule_server (&server, freq, 1/*num_freq*/, &context);
+        if (socket_path != NULL && serve_unix_socket (&server, socket_path) != 0) {
+            printf(" ERROR: Could not listen on %s\n", socket_path);
+            free_schedule_server (&server);
+            return -1;
+        }
+        if (socket_path == NULL)
+            serve_requests (&server, stdin, stdout);
+        free_schedule_server (&server);
+        return 0;
+    }
 
-    // Determine total test cores and read number of test patterns and scan chain lengths for each of them
-    num_test_cores = num_cores - 2 * num_io_pairs;
-    read_test_core_parameters (fptr, io_pairs, noc_nodes, num_cores, num_test_cores);
+    // Batch mode: schedule every SoC description listed in the manifest, one result file per job
+    if (manifest_file != NULL) {
+        num_jobs = read_batch_manifest (manifest_file, &jobs);
+        if (num_jobs < 0) {
+            printf(" ERROR: Could not open the manifest file\n");
+            return -1;
+        }
+        if (num_threads <= 0)
+            num_threads = (int) sysconf (_SC_NPROCESSORS_ONLN);
 
-    // Close input file
-    fclose (fptr);
+        // Each job gets its own random stream
+        for (int i = 0; i < num_jobs; i++)
+            jobs[i].seed = seed + i;
+
+        num_failed = (num_jobs > 0) ? run_batch (jobs, num_jobs, num_threads, freq, 1/*num_freq*/, &context) : 0;
+        printf(" Batch done: %d of %d jobs scheduled\n", num_jobs - num_failed, num_jobs);
+
+        free (jobs);
+        return (num_failed == 0) ? 0 : -1;
+    }
+
+    // Open and read input file
+    if (read_noc_design (input_file, &design) != 0) {
+        printf(" ERROR: Could not read the input file (missing, malformed or too large a design)\n");
+        return -1;
+    }
+
+    // IO placement: search for the io pairs with the shortest total testtime first, then schedule the design with them
+    if (place_io) {
+        init_io_placement (&placement, design.num_io_pairs);
+        search_io_placement (&design, freq, 1/*num_freq*/, &context, (num_threads > 0) ? num_threads : (int) sysconf (_SC_NPROCESSORS_ONLN),
+                             place_rounds, place_generations, seed, &placement);
+        apply_io_placement (&design, &placement);
+        free_io_placement (&placement);
+    }
+
+    // Benchmark mode: every engine on the same design, seeds and time budget
+    if (benchmark) {
+        benchmark_search_engines (&design, freq, 1/*num_freq*/, &context, seed, (benchmark_runs > 0) ? benchmark_runs : 1, stdout);
+        free_noc_design (&design);
+        return 0;
+    }
 
-    // Generate PSO particles
-    srand(time(0));
-    particle_swarm_optimization(noc_nodes, num_cores, M_rows, freq, 1/*num_freq*/, io_pairs, num_io_pairs);
+    // Search for the best mapping with the selected engine (PSO unless given on the command line)
+    seed_pso_context (&context, seed);
+    run_search_engine (design.noc_nodes, design.num_cores, design.M_rows, freq, 1/*num_freq*/, design.io_pairs, design.num_io_pairs, &context);
 
     // Free allocated memory
-    free (noc_nodes);
-    free (io_pairs);
+    free_noc_design (&design);
 
     return 0;
 }
@@ -1,10 +1,23 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <limits.h>
+#include <string.h>
+#include <errno.h>
 #include <math.h>
+#include <time.h>
+#include <signal.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <fcntl.h>
+#include <unistd.h>
+#if defined(NOC_PROFILE) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#endif
 #include "noc_header.h"
 
-int times_list_size = 0;
-
 // Assign core numbers and coordinates for each node struct
 
 void initialize_nodes (NoC_node *noc_nodes, int num_cores, int M_rows, int N_columns) {		
@@ -19,14 +32,18 @@ void initialize_nodes (NoC_node *noc_nodes, int num_cores, int M_rows, int N_col
 }
 
 // Reads the input and output core numbers from the file and configures corresponding nodes
+// Returns the number of io pairs configured -- fewer than num_io_pairs if a line is missing, names a core outside the mesh or
+// a core that is already an io core
 
-void configure_io_pairs (FILE* in_file, IO_pairs *io_pairs, NoC_node *noc_nodes, int num_io_pairs) {
+int configure_io_pairs (FILE* in_file, IO_pairs *io_pairs, NoC_node *noc_nodes, int num_cores, int num_io_pairs) {
 
     int temp_in = 0;    // temporary variable to store input core no
     int temp_out = 0;   // temporary variable to store output core no
 
     for (int i = 0 ; i < num_io_pairs ; i++) {
-        fscanf (in_file,"%d\t%d", &temp_in, &temp_out);
+        if (fscanf (in_file,"%d\t%d", &temp_in, &temp_out) != 2 || temp_in < 1 || temp_in > num_cores || temp_out < 1 || temp_out > num_cores ||
+            temp_in == temp_out || noc_nodes[temp_in - 1].core_type != TEST_CORE || noc_nodes[temp_out - 1].core_type != TEST_CORE)
+            return i;
 
         // Update node structure array with core type
         noc_nodes[temp_in - 1].core_type = INPUT_CORE;
@@ -38,44 +55,499 @@ void configure_io_pairs (FILE* in_file, IO_pairs *io_pairs, NoC_node *noc_nodes,
         io_pairs[i].output_core_no = temp_out;
         io_pairs[i].io_head = create_IO_list_head();
     }
+    return num_io_pairs;
 }
 
 // Reads the number of test patterns, scan chain length and max power budget for each test core from the file and configures corresponding nodes
+// Returns -1 if the parameters of a test core are missing or negative
 
-void read_test_core_parameters (FILE* in_file, IO_pairs *io_pairs, NoC_node *noc_nodes, int num_cores, int num_test_cores) {
+int read_test_core_parameters (FILE* in_file, IO_pairs *io_pairs, NoC_node *noc_nodes, int num_cores, int num_test_cores) {
 
     for (int i = 0; i < num_cores; i++) {
         if (noc_nodes[i].core_type == TEST_CORE) {
-            fscanf (in_file,"%d\t%d\n", &noc_nodes[i].test_patterns, &noc_nodes[i].scan_chain_length);
+            if (fscanf (in_file,"%d\t%d\n", &noc_nodes[i].test_patterns, &noc_nodes[i].scan_chain_length) != 2 ||
+                noc_nodes[i].test_patterns < 0 || noc_nodes[i].scan_chain_length < 0)
+                return -1;
+        }
+    }
+    return 0;
+}
+
+// Reads a complete SoC description (mesh dimensions, io pairs, test core parameters) from the given file
+// Returns -1 if the file cannot be read or the design does not fit the scheduler (at most MAX_NUM_CORES cores, MAX_IO_PAIRS io pairs
+// and routes of MAX_ROUTE_HOPS hops, at least one test core; io cores inside the mesh and distinct)
+
+int read_noc_design (const char *file_name, NoC_design *design) {
+
+    FILE *fptr;                      // Input file pointer
+    int num_configured = 0;          // Number of io pairs read
+
+    // Open and read input file
+    fptr = fopen (file_name, "r");
+    if (fptr == NULL)
+        return -1;
+
+    // Read network dimensions, number of i/o pairs
+    if (fscanf (fptr,"%d\t%d", &design->M_rows, &design->N_columns) != 2 || fscanf (fptr,"%d", &design->num_io_pairs) != 1 ||
+        design->M_rows <= 0 || design->N_columns <= 0 || design->num_io_pairs <= 0 || design->num_io_pairs > MAX_IO_PAIRS ||
+        design->M_rows + design->N_columns - 2 > MAX_ROUTE_HOPS || design->M_rows * design->N_columns > MAX_NUM_CORES ||
+        design->M_rows * design->N_columns - 2 * design->num_io_pairs < 1) {
+        fclose (fptr);
+        return -1;
+    }
+
+    // Allocate memory for noc nodes and i/o pairs arrays
+    design->num_cores = design->M_rows * design->N_columns;
+    design->num_test_cores = design->num_cores - 2 * design->num_io_pairs;
+    design->noc_nodes = (NoC_node *) calloc (design->num_cores, sizeof (NoC_node));
+    design->io_pairs = (IO_pairs *) malloc (design->num_io_pairs * sizeof (IO_pairs));
+
+    // Initialize all the nodes (NoC tiles) in the network by assigning cores and ids
+    initialize_nodes (design->noc_nodes, design->num_cores, design->M_rows, design->N_columns);
+
+    // Configure i/o pairs and store i/o pair info in io_pairs array for quick ref
+    num_configured = configure_io_pairs (fptr, design->io_pairs, design->noc_nodes, design->num_cores, design->num_io_pairs);
+
+    // Read number of test patterns and scan chain lengths for each test core
+    if (num_configured < design->num_io_pairs ||
+        read_test_core_parameters (fptr, design->io_pairs, design->noc_nodes, design->num_cores, design->num_test_cores) != 0) {
+        design->num_io_pairs = num_configured;
+        free_noc_design (design);
+        fclose (fptr);
+        return -1;
+    }
+
+    // Close input file
+    fclose (fptr);
+
+    return 0;
+}
+
+// Frees the node structs, io pairs and IO schedule lists of a design
+
+void free_noc_design (NoC_design *design) {
+    for (int i = 0; i < design->num_io_pairs; i++) {
+        clear_IO_list (design->io_pairs[i].io_head);
+        free (design->io_pairs[i].io_head);
+    }
+    free (design->noc_nodes);
+    free (design->io_pairs);
+    design->noc_nodes = NULL;
+    design->io_pairs = NULL;
+}
+
+// Hop length b/w two cores as used by the testtime model (1 if the cores share a row or column, 2 otherwise)
+
+int find_hop_length (int x1, int y1, int x2, int y2) {
+    if ((x1 == x2) || (y1 == y2))
+        return 1;
+    else
+        return 2;
+}
+
+// Finds a dimension-ordered route starting at src_core and stores it as a sequence of hops, returns the number of hops
+// The route takes num_x_hops steps of x_step (+1 --> EAST, -1 --> WEST) and num_y_hops steps of y_step (+1 --> NORTH, -1 --> SOUTH),
+// X before Y if x_first is set; steps off the edge of the mesh wrap around (torus links, mesh routes never leave the mesh)
+// Every hop passes one router (input port --> output port) and the link leaving it; the router of dst_core is not part of the route
+
+int find_dimension_order_route (int M_rows, int N_columns, int src_core, int x_first, int x_step, int num_x_hops, int y_step, int num_y_hops, Route_hop *hops) {
+
+    int num_hops = 0;                                         // Number of hops found so far
+    int in_port = INJECTION;                                  // Port through which the route enters the next router
+    int x = (src_core - 1) % N_columns;                       // Coordinates of the next router (as in initialize_nodes)
+    int y = (src_core - 1) / N_columns;
+    int x_moving = 0;                                         // Set while the route moves in x-direction
+
+    for (int phase = 0; phase < 2; phase++) {
+        x_moving = (phase == 0) ? x_first : !x_first;
+
+        for (int i = 0; i < (x_moving ? num_x_hops : num_y_hops); i++) {
+            hops[num_hops].router = y * N_columns + x + 1;
+            hops[num_hops].in_port = in_port;
+            if (x_moving) {
+                hops[num_hops].out_port = (x_step > 0) ? EAST : WEST;
+                in_port = (x_step > 0) ? WEST : EAST;
+                x += x_step;
+                x = (x < 0) ? x + N_columns : (x >= N_columns) ? x - N_columns : x;
+            }
+            else {
+                hops[num_hops].out_port = (y_step > 0) ? NORTH : SOUTH;
+                in_port = (y_step > 0) ? SOUTH : NORTH;
+                y += y_step;
+                y = (y < 0) ? y + M_rows : (y >= M_rows) ? y - M_rows : y;
+            }
+            hops[num_hops].next = y * N_columns + x + 1;
+            num_hops++;
+        }
+    }
+
+    return num_hops;
+}
+
+// Steps and number of hops of the minimal ways from coordinate c1 to c2 along one dimension of the given size, returns the number of ways
+// (mesh: one way; torus: the shorter way round the ring, both ways if they are equally long)
+
+static int find_minimal_steps (int c1, int c2, int size, int wrap, int *steps, int *num_hops) {
+    int forward = (c2 - c1 + size) % size;                    // Hops going round in positive direction
+    int backward = (size - forward) % size;                   // Hops going round in negative direction
+    int num_ways = 0;
+
+    if (!wrap || c1 == c2) {
+        steps[0] = (c2 >= c1) ? 1 : -1;
+        num_hops[0] = (c2 >= c1) ? c2 - c1 : c1 - c2;
+        return 1;
+    }
+    if (forward <= backward) {
+        steps[num_ways] = 1;
+        num_hops[num_ways++] = forward;
+    }
+    if (backward <= forward) {
+        steps[num_ways] = -1;
+        num_hops[num_ways++] = backward;
+    }
+    return num_ways;
+}
+
+// Collects the legal minimal routes b/w two cores under the given routing algorithm, returns the number of routes
+// Route r is described by x_first[r], x_step[r], num_x_hops[r], y_step[r] and num_y_hops[r] (see find_dimension_order_route)
+
+static int find_candidate_routes (int M_rows, int N_columns, int routing, int src, int dst, int *x_first, int *x_step, int *num_x_hops, int *y_step, int *num_y_hops) {
+
+    int x_steps[2], x_hops[2], y_steps[2], y_hops[2];         // Minimal ways along each dimension
+    int num_x_ways = 0;
+    int num_y_ways = 0;
+    int num_routes = 0;
+    int wrap = (routing == ROUTING_TORUS);
+
+    num_x_ways = find_minimal_steps (src % N_columns, dst % N_columns, N_columns, wrap, x_steps, x_hops);
+    num_y_ways = find_minimal_steps (src / N_columns, dst / N_columns, M_rows, wrap, y_steps, y_hops);
+
+    for (int i = 0; i < num_x_ways; i++) {
+        for (int j = 0; j < num_y_ways; j++) {
+            for (int order = 0; order < 2; order++) {
+
+                // Orders only differ if the route turns (routes without a turn are listed in X-first order)
+                if (x_hops[i] == 0 || y_hops[j] == 0) {
+                    if (order == 1)
+                        continue;
+                }
+
+                // XY: X first only; YX: Y first only; west-first: no turn into WEST, so routes going WEST go X first
+                else if ((routing == ROUTING_XY && order == 1) || (routing == ROUTING_YX && order == 0) ||
+                         (routing == ROUTING_WEST_FIRST && order == 1 && x_steps[i] < 0))
+                    continue;
+
+                x_first[num_routes] = (order == 0);
+                x_step[num_routes] = x_steps[i];
+                num_x_hops[num_routes] = x_hops[i];
+                y_step[num_routes] = y_steps[j];
+                num_y_hops[num_routes] = y_hops[j];
+                num_routes++;
+            }
+        }
+    }
+
+    return num_routes;
+}
+
+// Builds the route table (hop lengths and candidate routes) for the given mesh dimensions and routing algorithm
+// One entry per offset (dx, dy) b/w two cores, dx in [-(N_columns - 1), N_columns - 1] and dy in [-(M_rows - 1), M_rows - 1]:
+// the minimal ways along a dimension only depend on the difference of the coordinates (modulo the ring size on a torus)
+
+Route_table *create_route_table (int M_rows, int N_columns, int routing) {
+
+    Route_table *route_table = (Route_table *) malloc (sizeof (Route_table));
+    int num_offsets = (2 * M_rows - 1) * (2 * N_columns - 1);                                   // Number of offsets b/w two cores
+    int x_first[MAX_ROUTE_CHOICES], x_step[MAX_ROUTE_CHOICES], num_x_hops[MAX_ROUTE_CHOICES];    // Candidate routes at one offset
+    int y_step[MAX_ROUTE_CHOICES], num_y_hops[MAX_ROUTE_CHOICES];
+    int num_routes = 0;
+    int src = 0;                                                                               // Pair of cores at the offset
+    int dst = 0;
+    int idx = 0;
+
+    route_table->M_rows = M_rows;
+    route_table->N_columns = N_columns;
+    route_table->num_cores = M_rows * N_columns;
+    route_table->routing = routing;
+    route_table->hop_length = (int *) malloc (num_offsets * sizeof (int));
+    route_table->num_routes = (int *) malloc (num_offsets * sizeof (int));
+    route_table->routes = (Route_shape *) malloc (num_offsets * MAX_ROUTE_CHOICES * sizeof (Route_shape));
+    route_table->next = NULL;
+
+    // Coordinates follow initialize_nodes
+    for (int dy = -(M_rows - 1); dy < M_rows; dy++) {
+        for (int dx = -(N_columns - 1); dx < N_columns; dx++) {
+            idx = (dy + M_rows - 1) * (2 * N_columns - 1) + (dx + N_columns - 1);
+            src = ((dy < 0) ? -dy : 0) * N_columns + ((dx < 0) ? -dx : 0);
+            dst = src + dy * N_columns + dx;
+            route_table->hop_length[idx] = find_hop_length (0, 0, dx, dy);
+
+            num_routes = find_candidate_routes (M_rows, N_columns, routing, src, dst, x_first, x_step, num_x_hops, y_step, num_y_hops);
+            route_table->num_routes[idx] = num_routes;
+            for (int r = 0; r < num_routes; r++) {
+                route_table->routes[idx * MAX_ROUTE_CHOICES + r].x_first = (signed char) x_first[r];
+                route_table->routes[idx * MAX_ROUTE_CHOICES + r].x_step = (signed char) x_step[r];
+                route_table->routes[idx * MAX_ROUTE_CHOICES + r].y_step = (signed char) y_step[r];
+                route_table->routes[idx * MAX_ROUTE_CHOICES + r].num_x_hops = (short) num_x_hops[r];
+                route_table->routes[idx * MAX_ROUTE_CHOICES + r].num_y_hops = (short) num_y_hops[r];
+            }
+        }
+    }
+
+    return route_table;
+}
+
+// Index of the offset b/w two cores in the route table
+
+int find_route_offset (Route_table *route_table, int src_core, int dst_core) {
+    int N_columns = route_table->N_columns;
+    int dx = (dst_core - 1) % N_columns - (src_core - 1) % N_columns;
+    int dy = (dst_core - 1) / N_columns - (src_core - 1) / N_columns;
+
+    return (dy + route_table->M_rows - 1) * (2 * N_columns - 1) + (dx + N_columns - 1);
+}
+
+// Hop length b/w two cores as used by the testtime model, looked up in the route table
+
+int find_route_hop_length (Route_table *route_table, int src_core, int dst_core) {
+    return route_table->hop_length[find_route_offset (route_table, src_core, dst_core)];
+}
+
+// Stores the hops of candidate route route_no b/w two cores in hops (room for MAX_ROUTE_HOPS), returns their number
+
+int find_candidate_route (Route_table *route_table, int src_core, int dst_core, int route_no, Route_hop *hops) {
+    Route_shape *route = &route_table->routes[find_route_offset (route_table, src_core, dst_core) * MAX_ROUTE_CHOICES + route_no];
+
+    return find_dimension_order_route (route_table->M_rows, route_table->N_columns, src_core, route->x_first, route->x_step, route->num_x_hops,
+                                       route->y_step, route->num_y_hops, hops);
+}
+
+// Number of hops of candidate route route_no b/w two cores
+
+int find_candidate_route_length (Route_table *route_table, int src_core, int dst_core, int route_no) {
+    Route_shape *route = &route_table->routes[find_route_offset (route_table, src_core, dst_core) * MAX_ROUTE_CHOICES + route_no];
+
+    return route->num_x_hops + route->num_y_hops;
+}
+
+// Frees a route table
+
+void free_route_table (Route_table *route_table) {
+    free (route_table->hop_length);
+    free (route_table->num_routes);
+    free (route_table->routes);
+    free (route_table);
+}
+
+// Routing algorithm for the given name (xy, yx, west-first, torus), -1 if the name is unknown
+
+int find_routing_algorithm (const char *name) {
+    if (strcmp (name, "xy") == 0)
+        return ROUTING_XY;
+    else if (strcmp (name, "yx") == 0)
+        return ROUTING_YX;
+    else if (strcmp (name, "west-first") == 0)
+        return ROUTING_WEST_FIRST;
+    else if (strcmp (name, "torus") == 0)
+        return ROUTING_TORUS;
+    else
+        return -1;
+}
+
+// Builds the testtime table for the given design using the hop lengths of the given route table
+
+Testtime_table *create_testtime_table (NoC_design *design, Route_table *route_table) {
+
+    Testtime_table *testtime_table = (Testtime_table *) malloc (sizeof (Testtime_table));
+    int num_cores = design->num_cores;
+    int num_io_pairs = design->num_io_pairs;
+    int hop_length_ic = 0;
+    int hop_length_co = 0;
+    int idx = 0;
+
+    testtime_table->num_cores = num_cores;
+    testtime_table->num_io_pairs = num_io_pairs;
+    testtime_table->cycles_per_pattern = (int *) calloc (num_cores * num_io_pairs, sizeof (int));
+    testtime_table->tail_cycles = (int *) calloc (num_cores * num_io_pairs, sizeof (int));
+    testtime_table->route_table = route_table;
+    testtime_table->ref_count = 0;
+    testtime_table->next = NULL;
+
+    // Key: | M_rows | N_columns | routing | num_io_pairs | io pair core nos | test patterns and scan chain length per core |
+    testtime_table->key_length = 4 + 2 * num_io_pairs + 2 * num_cores;
+    testtime_table->key = (int *) malloc (testtime_table->key_length * sizeof (int));
+    testtime_table->key[idx++] = design->M_rows;
+    testtime_table->key[idx++] = design->N_columns;
+    testtime_table->key[idx++] = route_table->routing;
+    testtime_table->key[idx++] = num_io_pairs;
+    for (int i = 0; i < num_io_pairs; i++) {
+        testtime_table->key[idx++] = design->io_pairs[i].input_core_no;
+        testtime_table->key[idx++] = design->io_pairs[i].output_core_no;
+    }
+    for (int i = 0; i < num_cores; i++) {
+        testtime_table->key[idx++] = design->noc_nodes[i].test_patterns;
+        testtime_table->key[idx++] = design->noc_nodes[i].scan_chain_length;
+    }
+
+    // Testtime coefficients for every test core and io pair
+    for (int i = 0; i < num_cores; i++) {
+        if (design->noc_nodes[i].core_type != TEST_CORE)
+            continue;
+        for (int k = 0; k < num_io_pairs; k++) {
+            hop_length_ic = find_route_hop_length (route_table, design->io_pairs[k].input_core_no, i + 1);
+            hop_length_co = find_route_hop_length (route_table, i + 1, design->io_pairs[k].output_core_no);
+            testtime_table->cycles_per_pattern[i * num_io_pairs + k] = 1 + max (hop_length_ic, hop_length_co) + (design->noc_nodes[i].scan_chain_length - 1);
+            testtime_table->tail_cycles[i * num_io_pairs + k] = (hop_length_ic >= hop_length_co) ? hop_length_co : hop_length_ic;
+        }
+    }
+
+    return testtime_table;
+}
+
+// Initializes an empty table cache
+
+void init_table_cache (Table_cache *cache) {
+    cache->route_tables = NULL;
+    cache->testtime_tables = NULL;
+    pthread_mutex_init (&cache->lock, NULL);
+}
+
+// Returns the testtime table for a design, reusing cached route and testtime tables wherever the design matches
+
+Testtime_table *acquire_testtime_table (Table_cache *cache, NoC_design *design, int routing) {
+
+    Testtime_table *testtime_table = NULL;
+    Testtime_table *candidate = NULL;
+    Route_table *route_table = NULL;
+
+    // Tables are built outside the lock -- only the lookups and insertions are serialized
+    pthread_mutex_lock (&cache->lock);
+    for (route_table = cache->route_tables; route_table != NULL; route_table = route_table->next)
+        if (route_table->M_rows == design->M_rows && route_table->N_columns == design->N_columns && route_table->routing == routing)
+            break;
+    pthread_mutex_unlock (&cache->lock);
+
+    if (route_table == NULL) {
+        Route_table *new_table = create_route_table (design->M_rows, design->N_columns, routing);
+
+        pthread_mutex_lock (&cache->lock);
+        for (route_table = cache->route_tables; route_table != NULL; route_table = route_table->next)
+            if (route_table->M_rows == design->M_rows && route_table->N_columns == design->N_columns && route_table->routing == routing)
+                break;
+
+        // Another worker may have inserted the same mesh in the meantime
+        if (route_table == NULL) {
+            route_table = new_table;
+            route_table->next = cache->route_tables;
+            cache->route_tables = route_table;
+            new_table = NULL;
         }
+        pthread_mutex_unlock (&cache->lock);
+
+        if (new_table != NULL)
+            free_route_table (new_table);
+    }
+
+    candidate = create_testtime_table (design, route_table);
+
+    pthread_mutex_lock (&cache->lock);
+    for (testtime_table = cache->testtime_tables; testtime_table != NULL; testtime_table = testtime_table->next)
+        if (testtime_table->key_length == candidate->key_length && memcmp (testtime_table->key, candidate->key, candidate->key_length * sizeof (int)) == 0)
+            break;
+    if (testtime_table == NULL) {
+        testtime_table = candidate;
+        testtime_table->next = cache->testtime_tables;
+        cache->testtime_tables = testtime_table;
+        candidate = NULL;
+    }
+    testtime_table->ref_count++;
+    pthread_mutex_unlock (&cache->lock);
+
+    // Identical design already cached -- drop the duplicate
+    if (candidate != NULL) {
+        free (candidate->cycles_per_pattern);
+        free (candidate->tail_cycles);
+        free (candidate->key);
+        free (candidate);
+    }
+
+    return testtime_table;
+}
+
+// Releases a testtime table obtained from acquire_testtime_table
+// (Tables stay cached until free_table_cache so that later jobs of the batch can reuse them)
+
+void release_testtime_table (Table_cache *cache, Testtime_table *testtime_table) {
+    pthread_mutex_lock (&cache->lock);
+    testtime_table->ref_count--;
+    pthread_mutex_unlock (&cache->lock);
+}
+
+// Frees all tables held by the cache
+
+void free_table_cache (Table_cache *cache) {
+    Testtime_table *testtime_table = cache->testtime_tables;
+    Route_table *route_table = cache->route_tables;
+
+    while (testtime_table != NULL) {
+        Testtime_table *next = testtime_table->next;
+        free (testtime_table->cycles_per_pattern);
+        free (testtime_table->tail_cycles);
+        free (testtime_table->key);
+        free (testtime_table);
+        testtime_table = next;
+    }
+    while (route_table != NULL) {
+        Route_table *next = route_table->next;
+        free_route_table (route_table);
+        route_table = next;
     }
+    cache->testtime_tables = NULL;
+    cache->route_tables = NULL;
+    pthread_mutex_destroy (&cache->lock);
+}
+
+// Number of patterns per segment when a test is preempted at the given preemption point (fraction of its patterns per segment)
+// Every segment applies at least one pattern, and a test is split into at most MAX_SEGMENTS_PER_CORE segments
+
+int find_segment_patterns (int test_patterns, double preemption_point) {
+    int segment_patterns = (int)(test_patterns * preemption_point);
+
+    if (segment_patterns < 1)
+        segment_patterns = 1;
+    if (test_patterns > segment_patterns * MAX_SEGMENTS_PER_CORE)
+        segment_patterns = (test_patterns + MAX_SEGMENTS_PER_CORE - 1) / MAX_SEGMENTS_PER_CORE;
+
+    return segment_patterns;
+}
+
+// Number of segments a test is split into at the given preemption point (a test without patterns still takes one segment)
+
+int find_num_segments (int test_patterns, double preemption_point) {
+    int segment_patterns = find_segment_patterns (test_patterns, preemption_point);
+
+    return (test_patterns <= segment_patterns) ? 1 : (test_patterns + segment_patterns - 1) / segment_patterns;
 }
 
-// Finds testtime for the given mapping assuming there are no resource conflicts involved (XY routing, circuit switching)
+// Finds testtime for a segment of num_patterns test patterns assuming there are no resource conflicts involved (circuit switching)
 
-double find_individual_testtime (NoC_node *noc_nodes, int input_core, int output_core, int test_core, double frequency, double preemption_point) {
+double find_segment_testtime (NoC_node *noc_nodes, int input_core, int output_core, int test_core, double frequency, int num_patterns) {
 
     int hop_length_ic = 0;        // Distance in terms of hops from input core to test core
     int hop_length_co = 0;        // Distance in terms of hops from output core to test core
     double testtime = 0;          // Testtime = [1 + Max{hop_length_ic, hop_length_co}] × no_test_patterns + [Min{hop_length_ic, hop_length_co}]
 
     // Input core to test core
-    if ((noc_nodes[input_core - 1].x_cord == noc_nodes[test_core - 1].x_cord) || (noc_nodes[input_core - 1].y_cord == noc_nodes[test_core - 1].y_cord))
-        hop_length_ic = 1;
-    else
-        hop_length_ic = 2;
+    hop_length_ic = find_hop_length (noc_nodes[input_core - 1].x_cord, noc_nodes[input_core - 1].y_cord, noc_nodes[test_core - 1].x_cord, noc_nodes[test_core - 1].y_cord);
 
     // Test core to output core
-    if ((noc_nodes[test_core - 1].x_cord == noc_nodes[output_core - 1].x_cord) || (noc_nodes[test_core - 1].y_cord == noc_nodes[output_core - 1].y_cord))
-        hop_length_co = 1;
-    else
-        hop_length_co = 2;
+    hop_length_co = find_hop_length (noc_nodes[test_core - 1].x_cord, noc_nodes[test_core - 1].y_cord, noc_nodes[output_core - 1].x_cord, noc_nodes[output_core - 1].y_cord);
 
     // Testtime calculation - [ref Thermal-aware Test Scheduling Strategy for Network-on-Chip based Systems]
     if (hop_length_ic >= hop_length_co)
-        testtime = (1 + hop_length_ic + (noc_nodes[test_core-1].scan_chain_length - 1)) * (int)(noc_nodes[test_core-1].test_patterns * preemption_point) + hop_length_co;
+        testtime = (1 + hop_length_ic + (noc_nodes[test_core-1].scan_chain_length - 1)) * num_patterns + hop_length_co;
     else
-        testtime = (1 + hop_length_co + (noc_nodes[test_core-1].scan_chain_length - 1)) * (int)(noc_nodes[test_core-1].test_patterns * preemption_point) + hop_length_ic;
+        testtime = (1 + hop_length_co + (noc_nodes[test_core-1].scan_chain_length - 1)) * num_patterns + hop_length_ic;
 
     // Accounting for the frequency (frequency --> normalized wrt the base testing freq)
     testtime = testtime / frequency;
@@ -83,6 +555,16 @@ double find_individual_testtime (NoC_node *noc_nodes, int input_core, int output
     return testtime;
 }
 
+// Same as find_segment_testtime, using the precomputed coefficients of a testtime table
+
+double lookup_segment_testtime (Testtime_table *testtime_table, int test_core, int io_pair, double frequency, int num_patterns) {
+    int idx = (test_core - 1) * testtime_table->num_io_pairs + (io_pair - 1);
+    double testtime = testtime_table->cycles_per_pattern[idx] * num_patterns + testtime_table->tail_cycles[idx];
+
+    // Accounting for the frequency (frequency --> normalized wrt the base testing freq)
+    return testtime / frequency;
+}
+
 // Finds the communication cost for a given PSO particle mapping --> consider hops (circuit switching scenario) --> use testtime (non-preemptive, single frequency)
 
 void find_communication_cost (PSO_particle *pso_particle, NoC_node *noc_nodes, int num_cores, IO_pairs *io_pairs, int num_io_pairs) {
@@ -96,9 +578,9 @@ void find_communication_cost (PSO_particle *pso_particle, NoC_node *noc_nodes, i
     // For all test cores
     for (int i = 0; i < num_test_cores; i++) {
 
-        test_core = (int)pso_particle->mapping[i];
-        input_core = io_pairs[(int)(pso_particle->mapping[i + num_test_cores]) - 1].input_core_no;
-        output_core = io_pairs[(int)(pso_particle->mapping[i + num_test_cores]) - 1].output_core_no;
+        test_core = pso_particle->mapping.test_core[i];
+        input_core = io_pairs[pso_particle->mapping.io_pair[i] - 1].input_core_no;
+        output_core = io_pairs[pso_particle->mapping.io_pair[i] - 1].output_core_no;
 
         // Find communication costs
 
@@ -119,9 +601,9 @@ void find_communication_cost (PSO_particle *pso_particle, NoC_node *noc_nodes, i
 // Maintains a sorted list of all starttimes and endtimes 
 // (giving intervals for which CLAP inputs need to be generated)
 
-void update_times_list (All_times **head, double time) {
+void update_times_list (Eval_arena *arena, All_times **head, double time) {
     All_times* temp;
-    All_times* new_node = (All_times*) malloc (sizeof (All_times));
+    All_times* new_node = (All_times*) arena_alloc (arena, sizeof (All_times));
     new_node->time = time;
 
     // If list is EMPTY or the new node is to be inserted at the head of the list
@@ -138,9 +620,6 @@ void update_times_list (All_times **head, double time) {
         new_node->next = temp->next;
         temp->next = new_node;
     }
-
-    // Increment the list size (global var)
-    times_list_size++;
 }
 
 // Creates an EMPTY IO Schedule list
@@ -160,17 +639,27 @@ IO_head *create_IO_list_head () {
     return head;
 }
 
+// Empties an IO schedule list (its nodes belong to the evaluation arena and are released with it)
+
+void clear_IO_list (IO_head *head) {
+    head->head_node = NULL;
+    head->size = 0;
+    head->max_busytime = 0.0;
+}
+
 // Updates IO Schedule lists
 
-void update_IO_list (IO_head *head, double starttime, double endtime, int test_core) {
+void update_IO_list (Eval_arena *arena, IO_head *head, double starttime, double endtime, int test_core, int segment_no, int num_segments) {
 
     IO_node* temp;
 
-    // Allocate memory for the new node and set node parameters
-    IO_node* new_node = (IO_node *) malloc (sizeof (IO_node));
+    // Take the new node from the evaluation arena and set node parameters
+    IO_node* new_node = (IO_node *) arena_alloc (arena, sizeof (IO_node));
     new_node->starttime = starttime;
     new_node->endtime = endtime;
     new_node->test_core = test_core;
+    new_node->segment_no = segment_no;
+    new_node->num_segments = num_segments;
     head->size++;
     head->max_busytime = endtime;
 
@@ -190,603 +679,961 @@ void update_IO_list (IO_head *head, double starttime, double endtime, int test_c
     }
 }
 
-// Populates the resource matrix with busytimes for all resources [links and router ports] in accordance with the XY-routing algorithm
+// Finds the XY route from src_core to dst_core and stores it as a sequence of hops, returns the number of hops
+// Every hop passes one router (input port --> output port) and the link leaving it; the router of dst_core is not part of the route
 
-void find_resource_busytimes (PSO_particle *pso_particle, NoC_node *noc_nodes, int N_columns, int num_cores, IO_pairs *io_pairs, int num_io_pairs) {
+int find_xy_route (NoC_node *noc_nodes, int N_columns, int src_core, int dst_core, Route_hop *hops) {
+    int dx = noc_nodes[dst_core - 1].x_cord - noc_nodes[src_core - 1].x_cord;    // Hops in x-direction (+x --> EAST, -x --> WEST)
+    int dy = noc_nodes[dst_core - 1].y_cord - noc_nodes[src_core - 1].y_cord;    // Hops in y-direction (+y --> NORTH, -y --> SOUTH)
 
-    int num_test_cores = num_cores - (2 * num_io_pairs);      // Number of test cores in the NoC mesh network
-    Resource resource_matrix[num_cores][num_cores];           // Resource matrix contains staus and busytime info (FIXME: could cause segmentation fault)
-    double individual_testtime = 0.0;                         // Individual testtime for a given test core assuming no resource conflicts
-    int test_core = 0;                                        // Temporary variable to store test core number
-    int input_core = 0;                                       // Temporary variable to store input core number
-    int output_core = 0;                                      // Temporary variable to store output core number
-    double frequency = 0.0;                                   // Temporary variable to store test frequency
-    double preemption = 0.0;                                  // Temporary variable to store preemption point
-    int ic_core = 0;                                          // Stores the intermediate core obtained after matching x coordinates of input core and test core
-    int co_core = 0;                                          // Stores the intermediate core obtained after matching x coordinates of test core and output core 
-    double max_busytime = 0.0;                                // Maximum busytime for all resources conflicting with the given input/output port
-    int xrouting_port_ic = -1;                                // Temporary variable to store the (EAST/WEST) routing port used at the last core after X routing
-    int xrouting_port_co = -1;                                // Temporary variable to store the (EAST/WEST) routing port used at the last core after X routing
-    All_times *times_head = NULL; 
-    int io_pair = 0;
-    double starttime = 0.0;
-    double endtime = 0.0;
-    double io_busytime = 0.0;
+    // Mesh routes never wrap around, so M_rows is not needed
+    return find_dimension_order_route (0, N_columns, src_core, 1, (dx >= 0) ? 1 : -1, abs (dx), (dy >= 0) ? 1 : -1, abs (dy), hops);
+}
 
-    // Initializing the resource matrix
-    for (int i = 0; i < num_cores; i++) {
-        for (int j = 0; j < num_cores; j++) {
-            resource_matrix[i][j].busytime = 0.0;
-
-            // Initializing input output port assignments and busytimes
-            for (int k = 0; k < 5; k++) {
-                resource_matrix[i][j].busyports[k][INPUT].busytime = 0.0;
-                resource_matrix[i][j].busyports[k][OUTPUT].busytime = 0.0;
-                resource_matrix[i][j].busyports[k][INPUT].port = UNALLOCATED;
-                resource_matrix[i][j].busyports[k][OUTPUT].port = UNALLOCATED;
-            }
-        }
-    }
+// Allocates from the evaluation arena if one is given, from the heap otherwise
 
-    // Populating resource matrix with busytime (latest time till which the resource is busy) for all test cores
-    for (int i = 0; i < num_test_cores; i++) {
+static void *eval_alloc (Eval_arena *arena, size_t size) {
+    return (arena != NULL) ? arena_alloc (arena, size) : malloc (size);
+}
 
-        // Use temporary variables to store core numbers and parameters -- just for convenience
-        test_core = (int)pso_particle->mapping[i];
-        io_pair = (int)(pso_particle->mapping[i + num_test_cores]);
-        input_core = io_pairs[io_pair - 1].input_core_no;
-        output_core = io_pairs[io_pair - 1].output_core_no;
-        frequency = pso_particle->mapping[i + (2 * num_test_cores)];
-        preemption = pso_particle->mapping[i + (3 * num_test_cores)];
+// Builds an evaluation state in the evaluation arena (released with it) or on the heap (released by free_eval_state)
+
+static Eval_state *build_eval_state (Eval_arena *arena, NoC_node *noc_nodes, int N_columns, int num_cores, IO_pairs *io_pairs, int num_io_pairs, PSO_context *context, int journaling) {
+
+    Eval_state *state = (Eval_state *) eval_alloc (arena, sizeof (Eval_state));
+
+    state->noc_nodes = noc_nodes;
+    state->N_columns = N_columns;
+    state->num_cores = num_cores;
+    state->num_test_cores = num_cores - (2 * num_io_pairs);
+    state->io_pairs = io_pairs;
+    state->num_io_pairs = num_io_pairs;
+    state->context = context;
+    state->route_table = context->route_table;
+    state->profile = context->profile;
+    state->busytimes = (double *) eval_alloc (arena, num_cores * ROUTER_STATE_SLOTS * sizeof (double));
+    state->port_maps = (unsigned int *) eval_alloc (arena, num_cores * sizeof (unsigned int));
+    state->io_busytime = (double *) eval_alloc (arena, num_io_pairs * sizeof (double));
+    state->remaining_workload = (double *) eval_alloc (arena, num_io_pairs * sizeof (double));
+    state->testtime = (double *) eval_alloc (arena, state->num_test_cores * sizeof (double));
+    state->starttime = (double *) eval_alloc (arena, state->num_test_cores * sizeof (double));
+    state->endtime = (double *) eval_alloc (arena, state->num_test_cores * sizeof (double));
+    state->segments = (Test_segment *) eval_alloc (arena, state->num_test_cores * MAX_SEGMENTS_PER_CORE * sizeof (Test_segment));
+    state->segment_mark = (int *) eval_alloc (arena, (state->num_test_cores + 1) * sizeof (int));
+    state->journal_mark = (int *) eval_alloc (arena, (state->num_test_cores + 1) * sizeof (int));
+    state->pending = (Segment_event *) eval_alloc (arena, state->num_test_cores * sizeof (Segment_event));
+
+    // A segment changes at most 6 values per hop (router port pair, router and link busytimes, the makespan twice) on two legs of
+    // at most M_rows + N_columns hops each, plus its io pair busytime
+    state->journaling = journaling;
+    state->journal_capacity = journaling ? state->num_test_cores * MAX_SEGMENTS_PER_CORE * (12 * (num_cores / N_columns + N_columns) + 1) : 0;
+    state->journal = journaling ? (Journal_entry *) eval_alloc (arena, state->journal_capacity * sizeof (Journal_entry)) : NULL;
+
+    reset_eval_state (state);
+    return state;
+}
 
-        // Get max busytime corresponding to the IO pair used to test the given core
-        io_busytime = io_pairs[io_pair - 1].io_head->max_busytime;
-        printf("\n IO (%d): %lf\n", io_pair - 1, io_busytime);
+// Creates an evaluation state for the given design
+// With journaling enabled every change is logged, so that the state can be rolled back to any position of the test core sequence
 
-        // Find core individual testtime (assuming no resource conflicts)
-        individual_testtime = find_individual_testtime (noc_nodes, input_core, output_core, test_core, frequency, preemption);
-        printf(" Test: %lf\n\n", individual_testtime);
+Eval_state *create_eval_state (NoC_node *noc_nodes, int N_columns, int num_cores, IO_pairs *io_pairs, int num_io_pairs, PSO_context *context, int journaling) {
+    return build_eval_state (NULL, noc_nodes, N_columns, num_cores, io_pairs, num_io_pairs, context, journaling);
+}
 
-        // ------------------------------------------------------------------- ROUTING LOGIC -------------------------------------------------------------------
+// Resets the evaluation state to an empty NoC (no test core scheduled)
 
-        // ------------------------------------------------------------------ X ROUTING LOGIC ------------------------------------------------------------------
+void reset_eval_state (Eval_state *state) {
 
-        // If input core x coordinate < test core x coordinate, update busytime for resources b/w cores
-        if (noc_nodes[input_core - 1].x_cord < noc_nodes[test_core - 1].x_cord) {
+    int num_cores = state->num_cores;
 
-            xrouting_port_ic = EAST;
+    // Initializing router, port pair and link busytimes
+    for (int i = 0; i < num_cores * ROUTER_STATE_SLOTS; i++)
+        state->busytimes[i] = 0.0;
 
-            // Update LINK busytimes between the input core and its adjacent core (link direction +x)
-            // resource_matrix[input_core - 1][input_core].busytime += individual_testtime;
-            resource_matrix[input_core - 1][input_core].busytime = max(resource_matrix[input_core - 1][input_core].busytime, io_busytime) + individual_testtime;
+    // Initializing input output port assignments
+    for (int i = 0; i < num_cores; i++)
+        state->port_maps[i] = PORT_MAP_UNALLOCATED;
 
-            // Update test endtime
-            endtime = max(endtime, resource_matrix[input_core - 1][input_core].busytime);
+    for (int i = 0; i < state->num_io_pairs; i++)
+        state->io_busytime[i] = 0.0;
 
-            // Update ROUTER busytimes and statuses (routing direction +x i.e. input port INJECTION to output port EAST)
-            resource_matrix[input_core - 1][input_core - 1].busyports[EAST][INPUT].busytime = max(resource_matrix[input_core - 1][input_core - 1].busyports[EAST][INPUT].busytime, io_busytime);
-            resource_matrix[input_core - 1][input_core - 1].busyports[INJECTION][OUTPUT].busytime = max(resource_matrix[input_core - 1][input_core - 1].busyports[INJECTION][OUTPUT].busytime, io_busytime);
-            max_busytime = max(resource_matrix[input_core - 1][input_core - 1].busyports[EAST][INPUT].busytime, resource_matrix[input_core - 1][input_core - 1].busyports[INJECTION][OUTPUT].busytime);
-            resource_matrix[input_core - 1][input_core - 1].busyports[EAST][INPUT].busytime = max_busytime + individual_testtime;
-            resource_matrix[input_core - 1][input_core - 1].busyports[INJECTION][OUTPUT].busytime = max_busytime + individual_testtime;
-            resource_matrix[input_core - 1][input_core - 1].busyports[EAST][INPUT].port = INJECTION;
-            resource_matrix[input_core - 1][input_core - 1].busyports[INJECTION][OUTPUT].port = EAST;            
+    state->makespan = 0.0;
+    state->cutoff = NO_CUTOFF;
+    state->bound = 0.0;
+    state->num_segments = 0;
+    state->num_scheduled = 0;
+    state->num_valid = 0;
+    state->journal_size = 0;
+}
 
-            // Update test endtime
-            endtime = max(endtime, max_busytime + individual_testtime);
-            
-            if (resource_matrix[input_core - 1][input_core - 1].busytime < max_busytime + individual_testtime)
-                resource_matrix[input_core - 1][input_core - 1].busytime = max_busytime + individual_testtime;
-
-            // From (input core + 1) to (input core + (difference in x-coordinates - 1))
-            // * Index of input core + 1 is input_core
-            for (int j = 0; j < (noc_nodes[test_core - 1].x_cord - noc_nodes[input_core - 1].x_cord - 1); j++) {
-                
-                // Update LINK busytimes between adjacent cores (link direction +x)
-                // resource_matrix[input_core + j][input_core + j + 1].busytime += individual_testtime;
-                resource_matrix[input_core + j][input_core + j + 1].busytime = max(resource_matrix[input_core + j][input_core + j + 1].busytime, io_busytime) + individual_testtime;
-
-                // Update test endtime
-                endtime = max(endtime, resource_matrix[input_core + j][input_core + j + 1].busytime);
-
-                // Update ROUTER busytimes and statuses (routing direction +x i.e. input port WEST to output port EAST)
-                resource_matrix[input_core + j][input_core + j].busyports[EAST][INPUT].busytime = max(resource_matrix[input_core + j][input_core + j].busyports[EAST][INPUT].busytime, io_busytime);
-                resource_matrix[input_core + j][input_core + j].busyports[WEST][OUTPUT].busytime = max(resource_matrix[input_core + j][input_core + j].busyports[WEST][OUTPUT].busytime, io_busytime);
-                max_busytime = max (resource_matrix[input_core + j][input_core + j].busyports[EAST][INPUT].busytime, resource_matrix[input_core + j][input_core + j].busyports[WEST][OUTPUT].busytime);
-                resource_matrix[input_core + j][input_core + j].busyports[EAST][INPUT].busytime = max_busytime + individual_testtime;
-                resource_matrix[input_core + j][input_core + j].busyports[WEST][OUTPUT].busytime = max_busytime + individual_testtime;
-                resource_matrix[input_core + j][input_core + j].busyports[EAST][INPUT].port = WEST;
-                resource_matrix[input_core + j][input_core + j].busyports[WEST][OUTPUT].port = EAST;
-
-                // Update test endtime
-                endtime = max(endtime, max_busytime + individual_testtime);
-
-                if (resource_matrix[input_core + j][input_core + j].busytime < max_busytime + individual_testtime)
-                    resource_matrix[input_core + j][input_core + j].busytime = max_busytime + individual_testtime;
-            }
-        }
+// Frees an evaluation state
+
+void free_eval_state (Eval_state *state) {
+    free (state->busytimes);
+    free (state->port_maps);
+    free (state->io_busytime);
+    free (state->remaining_workload);
+    free (state->testtime);
+    free (state->starttime);
+    free (state->endtime);
+    free (state->segments);
+    free (state->segment_mark);
+    free (state->journal_mark);
+    free (state->pending);
+    free (state->journal);
+    free (state);
+}
+
+// Creates an evaluation arena with an arena block of the given size
 
-        // If input core x coordinate > test core x coordinate, update busytime for links b/w cores
-        else if (noc_nodes[input_core - 1].x_cord > noc_nodes[test_core - 1].x_cord) {
+Eval_arena *create_eval_arena (size_t size) {
+    Eval_arena *arena = (Eval_arena *) malloc (sizeof (Eval_arena));
 
-            xrouting_port_ic = WEST;
+    arena->size = (size + EVAL_ARENA_ALIGN - 1) & ~((size_t) EVAL_ARENA_ALIGN - 1);
+    arena->base = (char *) malloc (arena->size);
+    arena->used = 0;
+    arena->spilled = 0;
+    arena->overflow = NULL;
+    arena->num_heap_calls = 1;
+    return arena;
+}
 
-            // Update LINK busytimes between the test core and its adjacent core (link direction -x)
-            // resource_matrix[input_core - 1][input_core - 2].busytime += individual_testtime;
-            resource_matrix[input_core - 1][input_core - 2].busytime = max(resource_matrix[input_core - 1][input_core - 2].busytime, io_busytime) + individual_testtime;
+// Hands out size bytes from the evaluation arena -- a bump of the used size, or an overflow block if the arena block is full
 
-            // Update test endtime
-            endtime = max(endtime, resource_matrix[input_core - 1][input_core - 2].busytime);
+void *arena_alloc (Eval_arena *arena, size_t size) {
+    Arena_block *block;
+    void *ptr;
 
-            // Update ROUTER busytimes and statuses (routing direction -x i.e. input port INJECTION to output port WEST)
-            resource_matrix[input_core - 1][input_core - 1].busyports[WEST][INPUT].busytime = max(resource_matrix[input_core - 1][input_core - 1].busyports[WEST][INPUT].busytime, io_busytime);
-            resource_matrix[input_core - 1][input_core - 1].busyports[INJECTION][OUTPUT].busytime = max(resource_matrix[input_core - 1][input_core - 1].busyports[INJECTION][OUTPUT].busytime, io_busytime);
-            max_busytime = max (resource_matrix[input_core - 1][input_core - 1].busyports[WEST][INPUT].busytime, resource_matrix[input_core - 1][input_core - 1].busyports[INJECTION][OUTPUT].busytime);
-            resource_matrix[input_core - 1][input_core - 1].busyports[WEST][INPUT].busytime = max_busytime + individual_testtime;
-            resource_matrix[input_core - 1][input_core - 1].busyports[INJECTION][OUTPUT].busytime = max_busytime + individual_testtime;
-            resource_matrix[input_core - 1][input_core - 1].busyports[WEST][INPUT].port = INJECTION;
-            resource_matrix[input_core - 1][input_core - 1].busyports[INJECTION][OUTPUT].port = WEST;
+    size = (size + EVAL_ARENA_ALIGN - 1) & ~((size_t) EVAL_ARENA_ALIGN - 1);
 
-            // Update test endtime
-            endtime = max(endtime, max_busytime + individual_testtime);
+    if (arena->used + size <= arena->size) {
+        ptr = arena->base + arena->used;
+        arena->used += size;
+        return ptr;
+    }
 
-            if (resource_matrix[input_core - 1][input_core - 1].busytime < max_busytime + individual_testtime)
-                resource_matrix[input_core - 1][input_core - 1].busytime = max_busytime + individual_testtime;
+    // Spill into an overflow block, the next reset makes room for it in the arena block
+    block = (Arena_block *) malloc (sizeof (Arena_block) + size);
+    block->next = arena->overflow;
+    arena->overflow = block;
+    arena->spilled += size;
+    arena->num_heap_calls++;
+    return block->data;
+}
 
-            // From (input core - 1) to (input core - (difference in x-coordinates - 1))
-            // * Index of input core - 1 is input_core - 2
-            for (int j = 0; j < (noc_nodes[input_core - 1].x_cord - noc_nodes[test_core - 1].x_cord - 1); j++) {
+// Releases everything handed out by the evaluation arena in O(1)
+// After an evaluation that spilled, the overflow blocks are freed and the arena block grows to the largest evaluation seen
 
-                // Update link busytimes between adjacent cores (link direction -x)
-                // resource_matrix[input_core - j - 2][input_core - j - 3].busytime += individual_testtime;
-                resource_matrix[input_core - j - 2][input_core - j - 3].busytime = max(resource_matrix[input_core - j - 2][input_core - j - 3].busytime, io_busytime) + individual_testtime;
+void reset_eval_arena (Eval_arena *arena) {
+    Arena_block *block;
 
-                // Update test endtime
-                endtime = max(endtime, resource_matrix[input_core - j - 2][input_core - j - 3].busytime);
+    if (arena->overflow != NULL) {
+        while (arena->overflow != NULL) {
+            block = arena->overflow;
+            arena->overflow = block->next;
+            free (block);
+        }
+        free (arena->base);
+        arena->size = (arena->used + arena->spilled > 2 * arena->size) ? arena->used + arena->spilled : 2 * arena->size;
+        arena->base = (char *) malloc (arena->size);
+        arena->num_heap_calls++;
+    }
+    arena->used = 0;
+    arena->spilled = 0;
+}
 
-                // Update ROUTER busytimes and statuses (routing direction -x i.e. input port EAST to output port WEST)
-                resource_matrix[input_core - j - 2][input_core - j - 2].busyports[WEST][INPUT].busytime = max(resource_matrix[input_core - j - 2][input_core - j - 2].busyports[WEST][INPUT].busytime, io_busytime);
-                resource_matrix[input_core - j - 2][input_core - j - 2].busyports[EAST][OUTPUT].busytime = max(resource_matrix[input_core - j - 2][input_core - j - 2].busyports[EAST][OUTPUT].busytime, io_busytime);
-                max_busytime = max (resource_matrix[input_core - j - 2][input_core - j - 2].busyports[WEST][INPUT].busytime, resource_matrix[input_core - j - 2][input_core - j - 2].busyports[EAST][OUTPUT].busytime);
-                resource_matrix[input_core - j - 2][input_core - j - 2].busyports[WEST][INPUT].busytime = max_busytime + individual_testtime;
-                resource_matrix[input_core - j - 2][input_core - j - 2].busyports[EAST][OUTPUT].busytime = max_busytime + individual_testtime;
-                resource_matrix[input_core - j - 2][input_core - j - 2].busyports[WEST][INPUT].port = EAST;
-                resource_matrix[input_core - j - 2][input_core - j - 2].busyports[EAST][OUTPUT].port = WEST;
+// Frees an evaluation arena and all of its blocks
 
-                // Update test endtime
-                endtime = max(endtime, max_busytime + individual_testtime);
+void free_eval_arena (Eval_arena *arena) {
+    reset_eval_arena (arena);
+    free (arena->base);
+    free (arena);
+}
 
-                if (resource_matrix[input_core - j - 2][input_core - j - 2].busytime < max_busytime + individual_testtime)
-                    resource_matrix[input_core - j - 2][input_core - j - 2].busytime = max_busytime + individual_testtime;
-            }
+// Names of the profiling sites in folded stacks and the profile summary
+static const char *profile_site_names[NUM_PROFILE_SITES] = {
+    "search", "generation", "swap_io_pair", "swap_frequency", "swap_sequence", "swap_test_cores", "local_search", "adapt",
+    "full_evaluation", "delta_evaluation", "prepare", "schedule_test", "resume", "select_route",
+    "router_north", "router_east", "router_south", "router_west", "link_north", "link_east", "link_south", "link_west"
+};
+
+#ifdef NOC_PROFILE
+// Cycle counter of the profiling build -- the time stamp counter on x86, monotonic nanoseconds elsewhere
+
+static inline unsigned long long read_cycle_counter (void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc ();
+#else
+    struct timespec now;
+
+    clock_gettime (CLOCK_MONOTONIC, &now);
+    return (unsigned long long) now.tv_sec * 1000000000ULL + (unsigned long long) now.tv_nsec;
+#endif
+}
+
+// Opens a profiling site on top of the open ones (no-op without a profile)
+
+static inline void profile_enter (Profile *profile, int site) {
+    int node = -1;
+
+    if (profile == NULL)
+        return;
+    if (profile->depth >= MAX_PROFILE_DEPTH) {
+        profile->depth++;
+        profile->num_dropped++;
+        return;
+    }
+
+    // Stack of the open sites plus this one -- an existing child of the current node, or a new one from the pool
+    if (profile->current >= 0) {
+        for (node = profile->nodes[profile->current].first_child; node >= 0 && profile->nodes[node].site != site; node = profile->nodes[node].next_sibling)
+            ;
+        if (node < 0 && profile->num_nodes < MAX_PROFILE_NODES) {
+            node = profile->num_nodes++;
+            profile->nodes[node].site = site;
+            profile->nodes[node].parent = profile->current;
+            profile->nodes[node].first_child = -1;
+            profile->nodes[node].next_sibling = profile->nodes[profile->current].first_child;
+            profile->nodes[node].cycles = 0;
+            profile->nodes[node].calls = 0;
+            profile->nodes[profile->current].first_child = node;
         }
-                
-        else
-            xrouting_port_ic = INJECTION;
+    }
+    if (node < 0)
+        profile->num_dropped++;
+
+    profile->open_site[profile->depth] = site;
+    profile->open_node[profile->depth] = node;
+    profile->current = node;
+    profile->depth++;
+    profile->open_time[profile->depth - 1] = read_cycle_counter ();
+}
 
-        // If test core x coordinate < output core x coordinate, update busytime for resources b/w cores
-        if (noc_nodes[test_core - 1].x_cord < noc_nodes[output_core - 1].x_cord) {
+// Closes the innermost open profiling site and adds its cycles to the site, its histogram and its stack
 
-            xrouting_port_co = EAST;
+static inline void profile_exit (Profile *profile) {
+    unsigned long long cycles = read_cycle_counter ();
+    int bucket = 0;
+    int site = 0;
+    int node = 0;
 
-            // Update LINK busytimes between the test core and its adjacent core (link direction +x)
-            // resource_matrix[test_core - 1][test_core].busytime += individual_testtime;
-            resource_matrix[test_core - 1][test_core].busytime = max(resource_matrix[test_core - 1][test_core].busytime, io_busytime) + individual_testtime;
+    if (profile == NULL)
+        return;
+    if (profile->depth > MAX_PROFILE_DEPTH) {
+        profile->depth--;
+        return;
+    }
 
-            // Update test endtime
-            endtime = max(endtime, resource_matrix[test_core - 1][test_core].busytime);
+    profile->depth--;
+    cycles -= profile->open_time[profile->depth];
+    site = profile->open_site[profile->depth];
+    node = profile->open_node[profile->depth];
+
+    bucket = 63 - __builtin_clzll (cycles | 1);
+    profile->histogram[site][(bucket < PROFILE_BUCKETS) ? bucket : PROFILE_BUCKETS - 1]++;
+    profile->site_cycles[site] += cycles;
+    profile->site_calls[site]++;
+    if (node >= 0) {
+        profile->nodes[node].cycles += cycles;
+        profile->nodes[node].calls++;
+    }
+    profile->current = (profile->depth > 0) ? profile->open_node[profile->depth - 1] : 0;
+}
+#endif
 
-            // Update ROUTER busytimes and statuses (routing direction +x i.e. input port INJECTION to output port EAST)
-            resource_matrix[test_core - 1][test_core - 1].busyports[EAST][INPUT].busytime = max(resource_matrix[test_core - 1][test_core - 1].busyports[EAST][INPUT].busytime, io_busytime);
-            resource_matrix[test_core - 1][test_core - 1].busyports[INJECTION][OUTPUT].busytime = max(resource_matrix[test_core - 1][test_core - 1].busyports[INJECTION][OUTPUT].busytime, io_busytime);
-            max_busytime = max (resource_matrix[test_core - 1][test_core - 1].busyports[EAST][INPUT].busytime, resource_matrix[test_core - 1][test_core - 1].busyports[INJECTION][OUTPUT].busytime);
-            resource_matrix[test_core - 1][test_core - 1].busyports[EAST][INPUT].busytime = max_busytime + individual_testtime;
-            resource_matrix[test_core - 1][test_core - 1].busyports[INJECTION][OUTPUT].busytime = max_busytime + individual_testtime;
-            resource_matrix[test_core - 1][test_core - 1].busyports[EAST][INPUT].port = INJECTION;
-            resource_matrix[test_core - 1][test_core - 1].busyports[INJECTION][OUTPUT].port = EAST;
+// Creates an empty cycle profile
 
-            // Update test endtime
-            endtime = max(endtime, max_busytime + individual_testtime);
+Profile *create_profile (void) {
+    Profile *profile = (Profile *) calloc (1, sizeof (Profile));
 
-            if (resource_matrix[test_core - 1][test_core - 1].busytime < max_busytime + individual_testtime)
-                resource_matrix[test_core - 1][test_core - 1].busytime = max_busytime + individual_testtime;
+    profile->nodes[0].site = -1;
+    profile->nodes[0].parent = -1;
+    profile->nodes[0].first_child = -1;
+    profile->nodes[0].next_sibling = -1;
+    profile->num_nodes = 1;
+    return profile;
+}
 
-            // From (test core + 1) to (test core + (difference in x-coordinates - 1))
-            // * Index of test core + 1 is input_core
-            for (int j = 0; j < (noc_nodes[output_core - 1].x_cord - noc_nodes[test_core - 1].x_cord - 1); j++) {
+// Upper end of the histogram bucket holding the given fraction of a site's calls
 
-                // Update LINK busytimes between adjacent cores (link direction +x)
-                // resource_matrix[test_core + j][test_core + j + 1].busytime += individual_testtime;
-                resource_matrix[test_core + j][test_core + j + 1].busytime = max(resource_matrix[test_core + j][test_core + j + 1].busytime, io_busytime) + individual_testtime;
+static unsigned long long find_profile_percentile (Profile *profile, int site, double fraction) {
+    unsigned long long calls = 0;
 
-                // Update test endtime
-                endtime = max(endtime, resource_matrix[test_core + j][test_core + j + 1].busytime);
+    for (int b = 0; b < PROFILE_BUCKETS; b++) {
+        calls += profile->histogram[site][b];
+        if (calls >= fraction * profile->site_calls[site])
+            return (2ULL << b) - 1;
+    }
+    return (2ULL << (PROFILE_BUCKETS - 1)) - 1;
+}
 
-                // Update ROUTER busytimes and statuses (routing direction +x i.e. input port WEST to output port EAST)
-                resource_matrix[test_core + j][test_core + j].busyports[EAST][INPUT].busytime = max(resource_matrix[test_core + j][test_core + j].busyports[EAST][INPUT].busytime, io_busytime);
-                resource_matrix[test_core + j][test_core + j].busyports[WEST][OUTPUT].busytime = max(resource_matrix[test_core + j][test_core + j].busyports[WEST][OUTPUT].busytime, io_busytime);
-                max_busytime = max (resource_matrix[test_core + j][test_core + j].busyports[EAST][INPUT].busytime, resource_matrix[test_core + j][test_core + j].busyports[WEST][OUTPUT].busytime);
-                resource_matrix[test_core + j][test_core + j].busyports[EAST][INPUT].busytime = max_busytime + individual_testtime;
-                resource_matrix[test_core + j][test_core + j].busyports[WEST][OUTPUT].busytime = max_busytime + individual_testtime;
-                resource_matrix[test_core + j][test_core + j].busyports[EAST][INPUT].port = WEST;
-                resource_matrix[test_core + j][test_core + j].busyports[WEST][OUTPUT].port = EAST;
+// Writes the stack of sites leading to a profile node as "site;site;site"
 
-                // Update test endtime
-                endtime = max(endtime, max_busytime + individual_testtime);
+static void write_profile_stack (FILE *fptr, Profile *profile, int node) {
+    if (profile->nodes[node].parent > 0) {
+        write_profile_stack (fptr, profile, profile->nodes[node].parent);
+        fprintf(fptr, ";");
+    }
+    fprintf(fptr, "%s", profile_site_names[profile->nodes[node].site]);
+}
 
-                if (resource_matrix[test_core + j][test_core + j].busytime < max_busytime + individual_testtime)
-                    resource_matrix[test_core + j][test_core + j].busytime = max_busytime + individual_testtime;
-            }
+// Prints the per-site cycle summary of a profile and writes its folded stacks (one "site;site;site cycles" line per stack, for
+// flame graph tools) to the given file, returns -1 if the file could not be written
+// Sites are inclusive of the sites opened inside them; the folded stacks hold the self cycles of each stack, so they add up to the total
+
+int report_profile (Profile *profile, FILE *out_file, const char *folded_file) {
+    unsigned long long self_cycles = 0;
+    FILE *fptr;
+
+    // Without an output stream only the folded stacks are written
+    if (out_file != NULL) {
+        fprintf(out_file, "\n Profile (cycles per call, percentiles are histogram bucket bounds):\n");
+        fprintf(out_file, " %-18s %12s %16s %12s %12s %12s\n", "site", "calls", "total", "mean", "p50", "p99");
+        for (int site = 0; site < NUM_PROFILE_SITES; site++) {
+            if (profile->site_calls[site] == 0)
+                continue;
+            fprintf(out_file, " %-18s %12llu %16llu %12.1lf %12llu %12llu\n", profile_site_names[site], profile->site_calls[site], profile->site_cycles[site],
+                    (double) profile->site_cycles[site] / profile->site_calls[site], find_profile_percentile (profile, site, 0.5), find_profile_percentile (profile, site, 0.99));
         }
+        if (profile->num_dropped > 0)
+            fprintf(out_file, " %ld calls are missing from the folded stacks\n", profile->num_dropped);
+    }
 
-        // If test core x coordinate > output core x coordinate, update busytime for links b/w cores
-        else if (noc_nodes[test_core - 1].x_cord > noc_nodes[output_core - 1].x_cord) {
-                
-            xrouting_port_co = WEST;
+    fptr = fopen (folded_file, "w");
+    if (fptr == NULL)
+        return -1;
+    for (int node = 1; node < profile->num_nodes; node++) {
+        self_cycles = profile->nodes[node].cycles;
+        for (int child = profile->nodes[node].first_child; child >= 0; child = profile->nodes[child].next_sibling)
+            self_cycles -= (profile->nodes[child].cycles < self_cycles) ? profile->nodes[child].cycles : self_cycles;
+        if (self_cycles == 0)
+            continue;
+        write_profile_stack (fptr, profile, node);
+        fprintf(fptr, " %llu\n", self_cycles);
+    }
+    if (fclose (fptr) != 0)
+        return -1;
+    if (out_file != NULL)
+        fprintf(out_file, " Folded stacks written to %s\n", folded_file);
+    return 0;
+}
 
-            // Update LINK busytimes between the test core and its adjacent core (link direction -x)
-            // resource_matrix[test_core - 1][test_core - 2].busytime += individual_testtime;
-            resource_matrix[test_core - 1][test_core - 2].busytime = max(resource_matrix[test_core - 1][test_core - 2].busytime, io_busytime) + individual_testtime;
+// Logs the current value of a busytime (and optionally a packed port pair word) before it is modified
 
-            // Update test endtime
-            endtime = max(endtime, resource_matrix[test_core - 1][test_core - 2].busytime);
+static void journal_change (Eval_state *state, double *time, unsigned int *port_map) {
+    if (state->journaling) {
+        state->journal[state->journal_size].time = time;
+        state->journal[state->journal_size].old_time = *time;
+        state->journal[state->journal_size].port_map = port_map;
+        state->journal[state->journal_size].old_port_map = (port_map != NULL) ? *port_map : 0;
+        state->journal_size++;
+    }
+}
 
-            // Update ROUTER busytimes and statuses (routing direction -x i.e. input port INJECTION to output port WEST)
-            resource_matrix[test_core - 1][test_core - 1].busyports[WEST][INPUT].busytime = max(resource_matrix[test_core - 1][test_core - 1].busyports[WEST][INPUT].busytime, io_busytime);
-            resource_matrix[test_core - 1][test_core - 1].busyports[INJECTION][OUTPUT].busytime = max(resource_matrix[test_core - 1][test_core - 1].busyports[INJECTION][OUTPUT].busytime, io_busytime);
-            max_busytime = max (resource_matrix[test_core - 1][test_core - 1].busyports[WEST][INPUT].busytime, resource_matrix[test_core - 1][test_core - 1].busyports[INJECTION][OUTPUT].busytime);
-            resource_matrix[test_core - 1][test_core - 1].busyports[WEST][INPUT].busytime = max_busytime + individual_testtime;
-            resource_matrix[test_core - 1][test_core - 1].busyports[INJECTION][OUTPUT].busytime = max_busytime + individual_testtime;
-            resource_matrix[test_core - 1][test_core - 1].busyports[WEST][INPUT].port = INJECTION;
-            resource_matrix[test_core - 1][test_core - 1].busyports[INJECTION][OUTPUT].port = WEST;
+// Stores the port for a port pair in a packed port pair word
 
-            // Update test endtime
-            endtime = max(endtime, max_busytime + individual_testtime);
+static inline unsigned int set_pair_port (unsigned int port_map, int port, int type, int value) {
+    int shift = PORT_PAIR_SLOT(port, type) * PORT_FIELD_BITS;
+    return (port_map & ~((unsigned int)PORT_FIELD_MASK << shift)) | ((unsigned int)(value & PORT_FIELD_MASK) << shift);
+}
 
-            if (resource_matrix[test_core - 1][test_core - 1].busytime < max_busytime + individual_testtime)
-                resource_matrix[test_core - 1][test_core - 1].busytime = max_busytime + individual_testtime;
+// Raises the makespan to the given busytime
 
-            // From (test core - 1) to (test core - (difference in x-coordinates - 1))
-            // * Index of test core - 1 is input_core - 2
-            for (int j = 2; j < (noc_nodes[test_core - 1].x_cord - noc_nodes[output_core - 1].x_cord - 1); j++) {
+static void update_makespan (Eval_state *state, double busytime) {
+    if (state->makespan < busytime) {
+        journal_change (state, &state->makespan, NULL);
+        state->makespan = busytime;
+    }
+}
 
-                // Update link busytimes between adjacent cores (link direction -x)
-                // resource_matrix[test_core - j - 2][test_core - j - 3].busytime += individual_testtime;
-                resource_matrix[test_core - j - 2][test_core - j - 3].busytime = max(resource_matrix[test_core - j - 2][test_core - j - 3].busytime, io_busytime) + individual_testtime;
+// Occupies the LINK leaving the router through out_port for the given testtime, returns the time till which the link is busy
 
-                // Update test endtime
-                endtime = max(endtime, resource_matrix[test_core - j - 2][test_core - j - 3].busytime);
+static double occupy_link (Eval_state *state, int router, int out_port, double io_busytime, double testtime) {
+    double *link = &state->busytimes[(router - 1) * ROUTER_STATE_SLOTS + LINK_SLOT(out_port)];
 
-                // Update ROUTER busytimes and statuses (routing direction -x i.e. input port EAST to output port WEST)
-                resource_matrix[test_core - j - 2][test_core - j - 2].busyports[WEST][INPUT].busytime = max(resource_matrix[test_core - j - 2][test_core - j - 2].busyports[WEST][INPUT].busytime, io_busytime);
-                resource_matrix[test_core - j - 2][test_core - j - 2].busyports[EAST][OUTPUT].busytime = max(resource_matrix[test_core - j - 2][test_core - j - 2].busyports[EAST][OUTPUT].busytime, io_busytime);
-                max_busytime = max (resource_matrix[test_core - j - 2][test_core - j - 2].busyports[WEST][INPUT].busytime, resource_matrix[test_core - j - 2][test_core - j - 2].busyports[EAST][OUTPUT].busytime);
-                resource_matrix[test_core - j - 2][test_core - j - 2].busyports[WEST][INPUT].busytime = max_busytime + individual_testtime;
-                resource_matrix[test_core - j - 2][test_core - j - 2].busyports[EAST][OUTPUT].busytime = max_busytime + individual_testtime;
-                resource_matrix[test_core - j - 2][test_core - j - 2].busyports[WEST][INPUT].port = EAST;
-                resource_matrix[test_core - j - 2][test_core - j - 2].busyports[EAST][OUTPUT].port = WEST;
+    journal_change (state, link, NULL);
+    *link = max(*link, io_busytime) + testtime;
+    update_makespan (state, *link);
 
-                // Update test endtime
-                endtime = max(endtime, max_busytime + individual_testtime);
+    return *link;
+}
 
-                if (resource_matrix[test_core - j - 2][test_core - j - 2].busytime < max_busytime + individual_testtime)
-                    resource_matrix[test_core - j - 2][test_core - j - 2].busytime = max_busytime + individual_testtime;
-            }
-        }
-                
-        else
-            xrouting_port_co = INJECTION;
+// Occupies the ROUTER port pair in_port --> out_port for the given testtime, returns the time till which the port pair is busy
+// (port pair (out_port, INPUT) tracks the input port connected to out_port, (in_port, OUTPUT) the output port connected to in_port)
+
+static double occupy_router (Eval_state *state, int router, int in_port, int out_port, double io_busytime, double testtime) {
+    double *busytimes = &state->busytimes[(router - 1) * ROUTER_STATE_SLOTS];      // Router state record
+    unsigned int *port_map = &state->port_maps[router - 1];
+    double *in_pair = &busytimes[PORT_PAIR_SLOT(out_port, INPUT)];
+    double *out_pair = &busytimes[PORT_PAIR_SLOT(in_port, OUTPUT)];
+    double max_busytime = max(max(*in_pair, *out_pair), io_busytime);
+
+    journal_change (state, in_pair, port_map);
+    journal_change (state, out_pair, NULL);
+    *in_pair = max_busytime + testtime;
+    *out_pair = max_busytime + testtime;
+    *port_map = set_pair_port (set_pair_port (*port_map, out_port, INPUT, in_port), in_port, OUTPUT, out_port);
+
+    if (busytimes[ROUTER_SLOT] < max_busytime + testtime) {
+        journal_change (state, &busytimes[ROUTER_SLOT], NULL);
+        busytimes[ROUTER_SLOT] = max_busytime + testtime;
+    }
+    update_makespan (state, max_busytime + testtime);
 
-        // ------------------------------------------------------------------ Y ROUTING LOGIC ------------------------------------------------------------------
-            
-        // Core in XY routing intermediate step (i.e. after traversing X part)
-        ic_core = input_core + (noc_nodes[test_core - 1].x_cord - noc_nodes[input_core - 1].x_cord);    // ic_core y coordinate = input core y coordinate
-        co_core = test_core + (noc_nodes[output_core - 1].x_cord - noc_nodes[test_core - 1].x_cord);    // co_core y coordinate = test core y coordinate
-
-        // If intermediate core y coordinate < test core y coordinate, update busytime for resources b/w cores 
-        if (noc_nodes[input_core - 1].y_cord < noc_nodes[test_core - 1].y_cord) {
-
-            // Update LINK busytimes between the input core and its adjacent core (link direction +y)
-            // resource_matrix[ic_core - 1][ic_core - 1 + N_columns].busytime += individual_testtime;
-            resource_matrix[ic_core - 1][ic_core - 1 + N_columns].busytime = max(resource_matrix[ic_core - 1][ic_core - 1 + N_columns].busytime, io_busytime) + individual_testtime;
-
-            // Update test endtime
-            endtime = max(endtime, resource_matrix[ic_core - 1][ic_core - 1 + N_columns].busytime);
-
-            // Update ROUTER busytimes and statuses (routing direction +y i.e. input port EAST/WEST (xrouting_port_ic) to output port NORTH)
-            resource_matrix[ic_core - 1][ic_core - 1].busyports[NORTH][INPUT].busytime = max(resource_matrix[ic_core - 1][ic_core - 1].busyports[NORTH][INPUT].busytime, io_busytime);
-            resource_matrix[ic_core - 1][ic_core - 1].busyports[xrouting_port_ic][OUTPUT].busytime = max(resource_matrix[ic_core - 1][ic_core - 1].busyports[xrouting_port_ic][OUTPUT].busytime, io_busytime);
-            max_busytime = max (resource_matrix[ic_core - 1][ic_core - 1].busyports[NORTH][INPUT].busytime, resource_matrix[ic_core - 1][ic_core - 1].busyports[xrouting_port_ic][OUTPUT].busytime);
-            resource_matrix[ic_core - 1][ic_core - 1].busyports[NORTH][INPUT].busytime = max_busytime + individual_testtime;
-            resource_matrix[ic_core - 1][ic_core - 1].busyports[xrouting_port_ic][OUTPUT].busytime = max_busytime + individual_testtime;
-            resource_matrix[ic_core - 1][ic_core - 1].busyports[NORTH][INPUT].port = xrouting_port_ic;
-            resource_matrix[ic_core - 1][ic_core - 1].busyports[xrouting_port_ic][OUTPUT].port = NORTH;
-
-            // Update test endtime
-            endtime = max(endtime, max_busytime + individual_testtime);
-
-            if (resource_matrix[ic_core - 1][ic_core - 1].busytime < max_busytime + individual_testtime)
-                resource_matrix[ic_core - 1][ic_core - 1].busytime = max_busytime + individual_testtime;
-
-            // From (intermediate core + N columns) to (intermediate core + N columns * (difference in y-coordinates - 1))
-            // * Index of intermediate core + N columns is intermediate_core - 1 + N columns
-            for (int j = 0; j < (noc_nodes[test_core - 1].y_cord - noc_nodes[input_core - 1].y_cord - 1); j++) {
-
-                // Update LINK busytimes between adjacent cores (link direction +y)
-                // resource_matrix[ic_core - 1 + (j + 1) * N_columns][ic_core - 1 + (j + 2) * N_columns].busytime += individual_testtime;
-                resource_matrix[ic_core - 1 + (j + 1) * N_columns][ic_core - 1 + (j + 2) * N_columns].busytime = max(resource_matrix[ic_core - 1 + (j + 1) * N_columns][ic_core - 1 + (j + 2) * N_columns].busytime, io_busytime) + individual_testtime;
-
-                // Update test endtime
-                endtime = max(endtime, resource_matrix[ic_core - 1 + (j + 1) * N_columns][ic_core - 1 + (j + 2) * N_columns].busytime);
-
-                // Update ROUTER busytimes and statuses (routing direction +y i.e. input port SOUTH to output port NORTH))
-                resource_matrix[ic_core - 1 + (j + 1) * N_columns][ic_core - 1 + (j + 1) * N_columns].busyports[NORTH][INPUT].busytime = max(resource_matrix[ic_core - 1 + (j + 1) * N_columns][ic_core - 1 + (j + 1) * N_columns].busyports[NORTH][INPUT].busytime, io_busytime);
-                resource_matrix[ic_core - 1 + (j + 1) * N_columns][ic_core - 1 + (j + 1) * N_columns].busyports[SOUTH][OUTPUT].busytime = max(resource_matrix[ic_core - 1 + (j + 1) * N_columns][ic_core - 1 + (j + 1) * N_columns].busyports[SOUTH][OUTPUT].busytime, io_busytime);
-                max_busytime = max (resource_matrix[ic_core - 1 + (j + 1) * N_columns][ic_core - 1 + (j + 1) * N_columns].busyports[NORTH][INPUT].busytime, resource_matrix[ic_core - 1 + (j + 1) * N_columns][ic_core - 1 + (j + 1) * N_columns].busyports[SOUTH][OUTPUT].busytime);
-                resource_matrix[ic_core - 1 + (j + 1) * N_columns][ic_core - 1 + (j + 1) * N_columns].busyports[NORTH][INPUT].busytime = max_busytime + individual_testtime;
-                resource_matrix[ic_core - 1 + (j + 1) * N_columns][ic_core - 1 + (j + 1) * N_columns].busyports[SOUTH][OUTPUT].busytime = max_busytime + individual_testtime;
-                resource_matrix[ic_core - 1 + (j + 1) * N_columns][ic_core - 1 + (j + 1) * N_columns].busyports[NORTH][INPUT].port = SOUTH;
-                resource_matrix[ic_core - 1 + (j + 1) * N_columns][ic_core - 1 + (j + 1) * N_columns].busyports[SOUTH][OUTPUT].port = NORTH;
-
-                // Update test endtime
-                endtime = max(endtime, max_busytime + individual_testtime);
-
-                if (resource_matrix[ic_core - 1 + (j + 1) * N_columns][ic_core - 1 + (j + 1) * N_columns].busytime < max_busytime + individual_testtime)
-                    resource_matrix[ic_core - 1 + (j + 1) * N_columns][ic_core - 1 + (j + 1) * N_columns].busytime = max_busytime + individual_testtime;
-            }
-        } 
-
-        // If input core y coordinate > test core y coordinate, update busytime for resources b/w cores 
-        else if (noc_nodes[input_core - 1].y_cord > noc_nodes[test_core - 1].y_cord) {
-                
-            // Update LINK busytimes between the input core and its adjacent core (link direction -y)
-            // resource_matrix[ic_core - 1][ic_core - 1 - N_columns].busytime += individual_testtime;
-            resource_matrix[ic_core - 1][ic_core - 1 - N_columns].busytime = max(resource_matrix[ic_core - 1][ic_core - 1 - N_columns].busytime, io_busytime) + individual_testtime;
-
-            // Update test endtime
-            endtime = max(endtime, resource_matrix[ic_core - 1][ic_core - 1 - N_columns].busytime);
-
-            // Update ROUTER busytimes and statuses (routing direction -y i.e. input port EAST/WEST (xrouting_port_ic) to output port SOUTH)
-            resource_matrix[ic_core - 1][ic_core - 1].busyports[SOUTH][INPUT].busytime = max(resource_matrix[ic_core - 1][ic_core - 1].busyports[SOUTH][INPUT].busytime, io_busytime);
-            resource_matrix[ic_core - 1][ic_core - 1].busyports[xrouting_port_ic][OUTPUT].busytime = max(resource_matrix[ic_core - 1][ic_core - 1].busyports[xrouting_port_ic][OUTPUT].busytime, io_busytime);
-            max_busytime = max (resource_matrix[ic_core - 1][ic_core - 1].busyports[SOUTH][INPUT].busytime, resource_matrix[ic_core - 1][ic_core - 1].busyports[xrouting_port_ic][OUTPUT].busytime);
-            resource_matrix[ic_core - 1][ic_core - 1].busyports[SOUTH][INPUT].busytime = max_busytime + individual_testtime;
-            resource_matrix[ic_core - 1][ic_core - 1].busyports[xrouting_port_ic][OUTPUT].busytime = max_busytime + individual_testtime;
-            resource_matrix[ic_core - 1][ic_core - 1].busyports[SOUTH][INPUT].port = xrouting_port_ic;
-            resource_matrix[ic_core - 1][ic_core - 1].busyports[xrouting_port_ic][OUTPUT].port = SOUTH;
-
-            // Update test endtime
-            endtime = max(endtime, max_busytime + individual_testtime);
-
-            if (resource_matrix[ic_core - 1][ic_core - 1].busytime < max_busytime + individual_testtime)
-                resource_matrix[ic_core - 1][ic_core - 1].busytime = max_busytime + individual_testtime;
-
-            // From (intermediate core - N columns) to (intermediate core - N columns * (difference in y-coordinates - 1))
-            // * Index of intermediate core - N columns is intermediate_core - 1 - N columns
-            for (int j = 0; j < (noc_nodes[input_core - 1].y_cord - noc_nodes[test_core - 1].y_cord - 1); j++) {
-
-                // Update LINK busytimes between adjacent cores (link direction -y)
-                // resource_matrix[ic_core - 1 - (j + 1) * N_columns][ic_core - 1 - (j + 2) * N_columns].busytime += individual_testtime;
-                resource_matrix[ic_core - 1 - (j + 1) * N_columns][ic_core - 1 - (j + 2) * N_columns].busytime = max(resource_matrix[ic_core - 1 - (j + 1) * N_columns][ic_core - 1 - (j + 2) * N_columns].busytime, io_busytime) + individual_testtime;
-
-                // Update test endtime
-                endtime = max(endtime, resource_matrix[ic_core - 1 - (j + 1) * N_columns][ic_core - 1 - (j + 2) * N_columns].busytime);
-
-                // Update ROUTER busytimes and statuses (routing direction -y i.e. input port NORTH to output port SOUTH))
-                resource_matrix[ic_core - 1 - (j + 1) * N_columns][ic_core - 1 - (j + 1) * N_columns].busyports[SOUTH][INPUT].busytime = max(resource_matrix[ic_core - 1 - (j + 1) * N_columns][ic_core - 1 - (j + 1) * N_columns].busyports[SOUTH][INPUT].busytime, io_busytime);
-                resource_matrix[ic_core - 1 - (j + 1) * N_columns][ic_core - 1 - (j + 1) * N_columns].busyports[NORTH][OUTPUT].busytime = max(resource_matrix[ic_core - 1 - (j + 1) * N_columns][ic_core - 1 - (j + 1) * N_columns].busyports[NORTH][OUTPUT].busytime, io_busytime);
-                max_busytime = max (resource_matrix[ic_core - 1 - (j + 1) * N_columns][ic_core - 1 - (j + 1) * N_columns].busyports[SOUTH][INPUT].busytime, resource_matrix[ic_core - 1 - (j + 1) * N_columns][ic_core - 1 - (j + 1) * N_columns].busyports[NORTH][OUTPUT].busytime);
-                resource_matrix[ic_core - 1 - (j + 1) * N_columns][ic_core - 1 - (j + 1) * N_columns].busyports[SOUTH][INPUT].busytime = max_busytime + individual_testtime;
-                resource_matrix[ic_core - 1 - (j + 1) * N_columns][ic_core - 1 - (j + 1) * N_columns].busyports[NORTH][OUTPUT].busytime = max_busytime + individual_testtime;
-                resource_matrix[ic_core - 1 - (j + 1) * N_columns][ic_core - 1 - (j + 1) * N_columns].busyports[SOUTH][INPUT].port = NORTH;
-                resource_matrix[ic_core - 1 - (j + 1) * N_columns][ic_core - 1 - (j + 1) * N_columns].busyports[NORTH][OUTPUT].port = SOUTH;
-
-                // Update test endtime
-                endtime = max(endtime, max_busytime + individual_testtime);
-
-                if (resource_matrix[ic_core - 1 - (j + 1) * N_columns][ic_core - 1 - (j + 1) * N_columns].busytime < max_busytime + individual_testtime)
-                    resource_matrix[ic_core - 1 - (j + 1) * N_columns][ic_core - 1 - (j + 1) * N_columns].busytime = max_busytime + individual_testtime;
-            }
-        }
+    return max_busytime + testtime;
+}
 
-        // If test core y coordinate < output core y coordinate, update busytime for resources b/w cores 
-        if (noc_nodes[test_core - 1].y_cord < noc_nodes[output_core - 1].y_cord) {
+// Latest busytime among the resources along a route (read-only) -- a circuit over the route can be set up from then on
 
-            // Update LINK busytimes between the input core and its adjacent core (link direction +y)
-            // resource_matrix[co_core - 1][co_core - 1 + N_columns].busytime += individual_testtime;
-            resource_matrix[co_core - 1][co_core - 1 + N_columns].busytime = max(resource_matrix[co_core - 1][co_core - 1 + N_columns].busytime, io_busytime) + individual_testtime;
+static double find_route_busytime (Eval_state *state, Route_hop *hops, int num_hops) {
+    double *busytimes;
+    double route_busytime = 0.0;
 
-            // Update test endtime
-            endtime = max(endtime, resource_matrix[co_core - 1][co_core - 1 + N_columns].busytime);
+    for (int h = 0; h < num_hops; h++) {
+        busytimes = &state->busytimes[(hops[h].router - 1) * ROUTER_STATE_SLOTS];
+        route_busytime = max(route_busytime, max(busytimes[PORT_PAIR_SLOT(hops[h].out_port, INPUT)], busytimes[PORT_PAIR_SLOT(hops[h].in_port, OUTPUT)]));
+        route_busytime = max(route_busytime, busytimes[LINK_SLOT(hops[h].out_port)]);
+    }
+    return route_busytime;
+}
 
-            // Update ROUTER busytimes and statuses (routing direction +y i.e. input port EAST/WEST (xrouting_port_co) to output port NORTH)
-            resource_matrix[co_core - 1][co_core - 1].busyports[NORTH][INPUT].busytime = max(resource_matrix[co_core - 1][co_core - 1].busyports[NORTH][INPUT].busytime, io_busytime);
-            resource_matrix[co_core - 1][co_core - 1].busyports[xrouting_port_co][OUTPUT].busytime = max(resource_matrix[co_core - 1][co_core - 1].busyports[xrouting_port_co][OUTPUT].busytime, io_busytime);
-            max_busytime = max (resource_matrix[co_core - 1][co_core - 1].busyports[NORTH][INPUT].busytime, resource_matrix[co_core - 1][co_core - 1].busyports[xrouting_port_co][OUTPUT].busytime);
-            resource_matrix[co_core - 1][co_core - 1].busyports[NORTH][INPUT].busytime = max_busytime + individual_testtime;
-            resource_matrix[co_core - 1][co_core - 1].busyports[xrouting_port_co][OUTPUT].busytime = max_busytime + individual_testtime;
-            resource_matrix[co_core - 1][co_core - 1].busyports[NORTH][INPUT].port = xrouting_port_co;
-            resource_matrix[co_core - 1][co_core - 1].busyports[xrouting_port_co][OUTPUT].port = NORTH;
+// Occupies all resources along a route from starttime for the given testtime
+// The caller passes a starttime no earlier than find_route_busytime, so every hop of the circuit is held over the same interval
+
+static void occupy_route (Eval_state *state, Route_hop *hops, int num_hops, double starttime, double testtime) {
+    for (int h = 0; h < num_hops; h++) {
+        PROFILE_ENTER(state->profile, PROFILE_ROUTER_HOP + hops[h].out_port);
+        occupy_router (state, hops[h].router, hops[h].in_port, hops[h].out_port, starttime, testtime);
+        PROFILE_EXIT(state->profile);
+        PROFILE_ENTER(state->profile, PROFILE_LINK_HOP + hops[h].out_port);
+        occupy_link (state, hops[h].router, hops[h].out_port, starttime, testtime);
+        PROFILE_EXIT(state->profile);
+    }
+}
 
-            // Update test endtime
-            endtime = max(endtime, max_busytime + individual_testtime);
+// Picks the least-loaded candidate route b/w two cores -- the one whose resources are released first (first candidate on ties) --
+// and returns its number; its hops are stored in hops (room for MAX_ROUTE_HOPS), *num_hops and *route_busytime are set to their
+// number and the busytime of the route
+
+static int select_route (Eval_state *state, int src_core, int dst_core, Route_hop *hops, int *num_hops, double *route_busytime) {
+    Route_table *route_table = state->route_table;
+    int num_routes = route_table->num_routes[find_route_offset (route_table, src_core, dst_core)];
+    Route_hop candidate[MAX_ROUTE_HOPS];                                      // Hops of the other candidates
+    int num_candidate_hops = 0;
+    int best = 0;                                                             // Least-loaded candidate so far
+    double busytime = 0.0;
+
+    // The first candidate goes straight to hops, a later one is copied there if it is less loaded
+    *num_hops = find_candidate_route (route_table, src_core, dst_core, 0, hops);
+    *route_busytime = find_route_busytime (state, hops, *num_hops);
+    for (int r = 1; r < num_routes; r++) {
+        num_candidate_hops = find_candidate_route (route_table, src_core, dst_core, r, candidate);
+        busytime = find_route_busytime (state, candidate, num_candidate_hops);
+        if (busytime < *route_busytime) {
+            best = r;
+            *route_busytime = busytime;
+            *num_hops = num_candidate_hops;
+            memcpy (hops, candidate, num_candidate_hops * sizeof (Route_hop));
+        }
+    }
 
-            if (resource_matrix[co_core - 1][co_core - 1].busytime < max_busytime + individual_testtime)
-                resource_matrix[co_core - 1][co_core - 1].busytime = max_busytime + individual_testtime;
+    return best;
+}
 
-            // From (intermediate core + N columns) to (intermediate core + N columns * (difference in y-coordinates - 1))
-            // * Index of intermediate core + N columns is intermediate_core - 1 + N columns
-            for (int j = 0; j < (noc_nodes[output_core - 1].y_cord - noc_nodes[test_core - 1].y_cord - 1); j++) {
+// Testtime of a segment of num_patterns patterns of the test at the given position through the given io pair (assuming no resource conflicts)
 
-                // Update LINK busytimes between adjacent cores (link direction +y)
-                // resource_matrix[co_core - 1 + (j + 1) * N_columns][co_core - 1 + (j + 2) * N_columns].busytime += individual_testtime;
-                resource_matrix[co_core - 1 + (j + 1) * N_columns][co_core - 1 + (j + 2) * N_columns].busytime = max(resource_matrix[co_core - 1 + (j + 1) * N_columns][co_core - 1 + (j + 2) * N_columns].busytime, io_busytime) + individual_testtime;
+static double find_position_segment_testtime (Eval_state *state, Genome *mapping, int position, int io_pair, int num_patterns) {
+    int test_core = mapping->test_core[position];
+    double frequency = state->context->freq[mapping->freq_index[position]];
 
-                // Update test endtime
-                endtime = max(endtime, resource_matrix[co_core - 1 + (j + 1) * N_columns][co_core - 1 + (j + 2) * N_columns].busytime);
+    if (state->context->testtime_table != NULL)
+        return lookup_segment_testtime (state->context->testtime_table, test_core, io_pair, frequency, num_patterns);
+    else
+        return find_segment_testtime (state->noc_nodes, state->io_pairs[io_pair - 1].input_core_no, state->io_pairs[io_pair - 1].output_core_no, test_core,
+                                      frequency, num_patterns);
+}
 
-                // Update ROUTER busytimes and statuses (routing direction +y i.e. input port SOUTH to output port NORTH))
-                resource_matrix[co_core - 1 + (j + 1) * N_columns][co_core - 1 + (j + 1) * N_columns].busyports[NORTH][INPUT].busytime = max(resource_matrix[co_core - 1 + (j + 1) * N_columns][co_core - 1 + (j + 1) * N_columns].busyports[NORTH][INPUT].busytime, io_busytime);
-                resource_matrix[co_core - 1 + (j + 1) * N_columns][co_core - 1 + (j + 1) * N_columns].busyports[SOUTH][OUTPUT].busytime = max(resource_matrix[co_core - 1 + (j + 1) * N_columns][co_core - 1 + (j + 1) * N_columns].busyports[SOUTH][OUTPUT].busytime, io_busytime);
-                max_busytime = max (resource_matrix[co_core - 1 + (j + 1) * N_columns][co_core - 1 + (j + 1) * N_columns].busyports[NORTH][INPUT].busytime, resource_matrix[co_core - 1 + (j + 1) * N_columns][co_core - 1 + (j + 1) * N_columns].busyports[SOUTH][OUTPUT].busytime);
-                resource_matrix[co_core - 1 + (j + 1) * N_columns][co_core - 1 + (j + 1) * N_columns].busyports[NORTH][INPUT].busytime = max_busytime + individual_testtime;
-                resource_matrix[co_core - 1 + (j + 1) * N_columns][co_core - 1 + (j + 1) * N_columns].busyports[SOUTH][OUTPUT].busytime = max_busytime + individual_testtime;
-                resource_matrix[co_core - 1 + (j + 1) * N_columns][co_core - 1 + (j + 1) * N_columns].busyports[NORTH][INPUT].port = SOUTH;
-                resource_matrix[co_core - 1 + (j + 1) * N_columns][co_core - 1 + (j + 1) * N_columns].busyports[SOUTH][OUTPUT].port = NORTH;
+// Number of patterns in the given segment of the test at the given position (the last segment takes the remainder)
 
-                // Update test endtime
-                endtime = max(endtime, max_busytime + individual_testtime);
+static int find_position_segment_patterns (Eval_state *state, Genome *mapping, int position, int segment_no) {
+    int test_patterns = state->noc_nodes[mapping->test_core[position] - 1].test_patterns;
+    int segment_patterns = find_segment_patterns (test_patterns, mapping->preemption[position]);
 
-                if (resource_matrix[co_core - 1 + (j + 1) * N_columns][co_core - 1 + (j + 1) * N_columns].busytime < max_busytime + individual_testtime)
-                    resource_matrix[co_core - 1 + (j + 1) * N_columns][co_core - 1 + (j + 1) * N_columns].busytime = max_busytime + individual_testtime;
-            }
-        }
+    return (test_patterns - segment_no * segment_patterns < segment_patterns) ? test_patterns - segment_no * segment_patterns : segment_patterns;
+}
 
-        // If test core y coordinate > output core y coordinate, update busytime for resources b/w cores 
-        else if (noc_nodes[test_core - 1].y_cord > noc_nodes[output_core - 1].y_cord) {
-            
-            // Update LINK busytimes between the input core and its adjacent core (link direction -y)
-            // resource_matrix[co_core - 1][co_core - 1 - N_columns].busytime += individual_testtime;
-            resource_matrix[co_core - 1][co_core - 1 - N_columns].busytime = max(resource_matrix[co_core - 1][co_core - 1 - N_columns].busytime, io_busytime) + individual_testtime;
-
-            // Update test endtime
-            endtime = max(endtime, resource_matrix[co_core - 1][co_core - 1 - N_columns].busytime);
-
-            // Update ROUTER busytimes and statuses (routing direction -y i.e. input port EAST/WEST (xrouting_port_co) to output port SOUTH)
-            resource_matrix[co_core - 1][co_core - 1].busyports[SOUTH][INPUT].busytime = max(resource_matrix[co_core - 1][co_core - 1].busyports[SOUTH][INPUT].busytime, io_busytime);
-            resource_matrix[co_core - 1][co_core - 1].busyports[xrouting_port_co][OUTPUT].busytime = max(resource_matrix[co_core - 1][co_core - 1].busyports[xrouting_port_co][OUTPUT].busytime, io_busytime);
-            max_busytime = max (resource_matrix[co_core - 1][co_core - 1].busyports[SOUTH][INPUT].busytime, resource_matrix[co_core - 1][co_core - 1].busyports[xrouting_port_co][OUTPUT].busytime);
-            resource_matrix[co_core - 1][co_core - 1].busyports[SOUTH][INPUT].busytime = max_busytime + individual_testtime;
-            resource_matrix[co_core - 1][co_core - 1].busyports[xrouting_port_co][OUTPUT].busytime = max_busytime + individual_testtime;
-            resource_matrix[co_core - 1][co_core - 1].busyports[SOUTH][INPUT].port = xrouting_port_co;
-            resource_matrix[co_core - 1][co_core - 1].busyports[xrouting_port_co][OUTPUT].port = SOUTH;
-
-            // Update test endtime
-            endtime = max(endtime, max_busytime + individual_testtime);
-
-            if (resource_matrix[co_core - 1][co_core - 1].busytime < max_busytime + individual_testtime)
-                resource_matrix[co_core - 1][co_core - 1].busytime = max_busytime + individual_testtime;
-
-            // From (intermediate core - N columns) to (intermediate core - N columns * (difference in y-coordinates - 1))
-            // * Index of intermediate core - N columns is intermediate_core - 1 - N columns
-            for (int j = 0; j < (noc_nodes[test_core - 1].y_cord - noc_nodes[output_core - 1].y_cord - 1); j++) {
-
-                // Update LINK busytimes between adjacent cores (link direction -y)
-                // resource_matrix[co_core - 1 - (j + 1) * N_columns][co_core - 1 - (j + 2) * N_columns].busytime += individual_testtime;
-                resource_matrix[co_core - 1 - (j + 1) * N_columns][co_core - 1 - (j + 2) * N_columns].busytime = max(resource_matrix[co_core - 1 - (j + 1) * N_columns][co_core - 1 - (j + 2) * N_columns].busytime, io_busytime) + individual_testtime;
-
-                // Update test endtime
-                endtime = max(endtime, resource_matrix[co_core - 1 - (j + 1) * N_columns][co_core - 1 - (j + 2) * N_columns].busytime);
-
-                // Update ROUTER busytimes and statuses (routing direction +y i.e. input port NORTH to output port SOUTH))
-                resource_matrix[co_core - 1 - (j + 1) * N_columns][co_core - 1 - (j + 1) * N_columns].busyports[SOUTH][INPUT].busytime = max(resource_matrix[co_core - 1 - (j + 1) * N_columns][co_core - 1 - (j + 1) * N_columns].busyports[SOUTH][INPUT].busytime, io_busytime);
-                resource_matrix[co_core - 1 - (j + 1) * N_columns][co_core - 1 - (j + 1) * N_columns].busyports[NORTH][OUTPUT].busytime = max(resource_matrix[co_core - 1 - (j + 1) * N_columns][co_core - 1 - (j + 1) * N_columns].busyports[NORTH][OUTPUT].busytime, io_busytime);
-                max_busytime = max (resource_matrix[co_core - 1 - (j + 1) * N_columns][co_core - 1 - (j + 1) * N_columns].busyports[SOUTH][INPUT].busytime, resource_matrix[co_core - 1 - (j + 1) * N_columns][co_core - 1 - (j + 1) * N_columns].busyports[NORTH][OUTPUT].busytime);
-                resource_matrix[co_core - 1 - (j + 1) * N_columns][co_core - 1 - (j + 1) * N_columns].busyports[SOUTH][INPUT].busytime = max_busytime + individual_testtime;
-                resource_matrix[co_core - 1 - (j + 1) * N_columns][co_core - 1 - (j + 1) * N_columns].busyports[NORTH][OUTPUT].busytime = max_busytime + individual_testtime;
-                resource_matrix[co_core - 1 - (j + 1) * N_columns][co_core - 1 - (j + 1) * N_columns].busyports[SOUTH][INPUT].port = NORTH;
-                resource_matrix[co_core - 1 - (j + 1) * N_columns][co_core - 1 - (j + 1) * N_columns].busyports[NORTH][OUTPUT].port = SOUTH;
-
-                // Update test endtime
-                endtime = max(endtime, max_busytime + individual_testtime);
-
-                if (resource_matrix[co_core - 1 - (j + 1) * N_columns][co_core - 1 - (j + 1) * N_columns].busytime < max_busytime + individual_testtime)
-                    resource_matrix[co_core - 1 - (j + 1) * N_columns][co_core - 1 - (j + 1) * N_columns].busytime = max_busytime + individual_testtime;
-            }
-        }
+// Sets the cutoff for scheduling positions start.. of the mapping and collects the testtimes still to be run per io pair
+// (only first segments count -- they are bound to the io pair of the mapping, resumed segments may go to any io pair)
+// Returns EVAL_DOMINATED if the io pairs alone cannot finish their remaining tests before the cutoff
 
-        // Update test starttime
-        starttime = endtime - individual_testtime;
+static int prepare_evaluation (Eval_state *state, Genome *mapping, int start, double cutoff) {
+    int num_test_cores = state->num_test_cores;
+    int io_pair = 0;
 
-        // Update list of all starttimes and endtimes
-        update_times_list(&times_head, starttime);
-        update_times_list(&times_head, endtime);
+    state->cutoff = cutoff;
+    state->bound = 0.0;
+    if (cutoff >= NO_CUTOFF)
+        return EVAL_COMPLETE;
+
+    for (int k = 0; k < state->num_io_pairs; k++)
+        state->remaining_workload[k] = 0.0;
+    for (int i = start; i < num_test_cores; i++) {
+        io_pair = mapping->io_pair[i];
+        state->testtime[i] = find_position_segment_testtime (state, mapping, i, io_pair, find_position_segment_patterns (state, mapping, i, 0));
+        state->remaining_workload[io_pair - 1] += state->testtime[i];
+    }
 
-        // Update IO list schedule
-        update_IO_list(io_pairs[io_pair - 1].io_head, starttime, endtime, test_core);
+    for (int k = 0; k < state->num_io_pairs; k++)
+        state->bound = max(state->bound, state->io_busytime[k] + state->remaining_workload[k]);
+    return (state->bound >= cutoff) ? EVAL_DOMINATED : EVAL_COMPLETE;
+}
 
-        // Printing the resource matrix with calculated busytimes
-        printf("\n\n");
-        for (int i = 0; i < num_cores; i++) {
-            for (int j = 0; j < num_cores; j++) {
-                printf(" | %.2lf", resource_matrix[i][j].busytime);
-                if (pso_particle->testtime < resource_matrix[i][j].busytime)
-                    pso_particle->testtime = resource_matrix[i][j].busytime;
-            } 
-            printf(" |\n\n");
-        }
+// Schedules one segment of the test at the given position through the given io pair, no earlier than ready_time
+// (least-loaded candidate routes, circuit switching). Returns EVAL_DOMINATED without modifying the state if the circuit
+// over both routes would end at or after the cutoff, or after scheduling the segment if the makespan reaches it
+
+static int schedule_segment (Eval_state *state, Genome *mapping, int position, int io_pair, int segment_no, double ready_time, double testtime) {
+
+    int test_core = mapping->test_core[position];                             // Test core number
+    int input_core = state->io_pairs[io_pair - 1].input_core_no;              // Input core number
+    int output_core = state->io_pairs[io_pair - 1].output_core_no;            // Output core number
+    double starttime = max(state->io_busytime[io_pair - 1], ready_time);      // Segment starttime (first, time from which both the io pair and the test are available)
+    double endtime = 0.0;                                                     // Segment endtime
+    int route_ic = 0;                                                         // Candidate route input core --> test core
+    int route_co = 0;                                                         // Candidate route test core --> output core
+    Route_hop hops_ic[MAX_ROUTE_HOPS];                                        // Hops of both routes
+    Route_hop hops_co[MAX_ROUTE_HOPS];
+    int num_hops_ic = 0;
+    int num_hops_co = 0;
+    double busytime_ic = 0.0;                                                 // Busytimes of both routes
+    double busytime_co = 0.0;
+    Test_segment *segment;
+
+    // Both legs are chosen on the current state (before either is occupied)
+    PROFILE_ENTER(state->profile, PROFILE_SELECT_ROUTE);
+    route_ic = select_route (state, input_core, test_core, hops_ic, &num_hops_ic, &busytime_ic);
+    route_co = select_route (state, test_core, output_core, hops_co, &num_hops_co, &busytime_co);
+    PROFILE_EXIT(state->profile);
+
+    // The circuit holds both legs for the whole segment, so it starts once all of their resources are free
+    starttime = max(starttime, max(busytime_ic, busytime_co));
+    endtime = starttime + testtime;
+
+    if (state->cutoff < NO_CUTOFF) {
+        state->bound = max(state->bound, endtime);
+        if (state->bound >= state->cutoff)
+            return EVAL_DOMINATED;
     }
 
-    // Printing the resource matrix with calculated busytimes
-    printf("\n\n");
-    for (int i = 0; i < num_cores; i++) {
-        for (int j = 0; j < num_cores; j++) {
-            printf(" | %.2lf", resource_matrix[i][j].busytime);
-            if (pso_particle->testtime < resource_matrix[i][j].busytime)
-                pso_particle->testtime = resource_matrix[i][j].busytime;
-        } 
-        printf(" |\n\n");
+    // Input core to test core, then test core to output core
+    occupy_route (state, hops_ic, num_hops_ic, starttime, testtime);
+    occupy_route (state, hops_co, num_hops_co, starttime, testtime);
+
+    // The io pair stays busy till the end of this segment
+    journal_change (state, &state->io_busytime[io_pair - 1], NULL);
+    state->io_busytime[io_pair - 1] = endtime;
+
+    segment = &state->segments[state->num_segments++];
+    segment->position = position;
+    segment->test_core = test_core;
+    segment->io_pair = io_pair;
+    segment->segment_no = segment_no;
+    segment->num_patterns = find_position_segment_patterns (state, mapping, position, segment_no);
+    segment->route_ic = route_ic;
+    segment->route_co = route_co;
+    segment->starttime = starttime;
+    segment->endtime = endtime;
+    segment->next_segment = (segment_no + 1 < find_num_segments (state->noc_nodes[test_core - 1].test_patterns, mapping->preemption[position])) ?
+                            segment_no + 1 : LAST_TEST_ADMINISTERED;
+
+    if (state->makespan >= state->cutoff) {
+        state->bound = state->makespan;
+        return EVAL_DOMINATED;
     }
-
-    printf(" Total testtime for given mapping: %lf\n", pso_particle->testtime);
+    return EVAL_COMPLETE;
 }
 
-// void create_clap_input_list (Clap_inputs_head *head, IO_pairs *io_pairs, int num_io_pairs) {
-    // Clap_list *temp = *head;
+// Schedules the first segment of the test core at the given position of the mapping on top of the current state
+// With a cutoff set, returns EVAL_DOMINATED as soon as the total testtime is known to reach it -- checks go from cheapest to
+// most expensive (io pair workload, read-only busytimes of both routes, the actual occupation) and nothing is modified before that check passes
 
-    // new_node->next = NULL;
+int schedule_test_core (Eval_state *state, Genome *mapping, int position) {
 
-    // if (*head == NULL) {
-    //     Clap_list *new_node = (Clap_list*) malloc (sizeof (Clap_list));
-    //     *head = new_node;
-    //     new_node->clap_inputs[io_pair - 1].starttime = starttime;
-    //     new_node->clap_inputs[io_pair - 1].endtime = endtime;
-    //     new_node->clap_inputs[io_pair - 1].input_core = input_core;
-    //     new_node->clap_inputs[io_pair - 1].test_core = test_core;
-    //     new_node->clap_inputs[io_pair - 1].output_core = output_core;
-    //     new_node->clap_inputs[io_pair - 1].filled = FILLED;
-    // }
-    // else {
-    //     while (temp->next != NULL) {
-    //         for (int i = 0; i < num_io_pairs; i++){
-    //             if (new_node->clap_inputs[i].starttime < new_node->clap_inputs[io_pair - 1].starttime)
-    //         }
-    //         temp = temp->next;
-    //     }
-    // }
-// }
+    int io_pair = mapping->io_pair[position];                                 // IO pair used to test the core
+    double io_busytime = state->io_busytime[io_pair - 1];                     // Time till which the io pair is busy
+    double individual_testtime = 0.0;                                         // Testtime of the first segment assuming no resource conflicts
+    int status = EVAL_COMPLETE;
 
-// double calculate_worst_case_SNR (PSO_particle *pso_particle, NoC_node *noc_nodes, int N_columns, int num_cores, IO_pairs *io_pairs, int num_io_pairs) {
-//     int num_test_cores = num_cores - (2 * num_io_pairs);    // Number of test cores in the NoC mesh network
-//     int test_core = 0;                                      // Temporary variable to store test core number
-//     int input_core = 0;                                     // Temporary variable to store input core number
-//     int output_core = 0;                                    // Temporary variable to store output core number
-//     double starttime = 0.0;                                 // Temporary variable to store test starttime
-//     double endtime = 0.0;                                   // Temporary variable to store test endtime
-//     int io_pair = 0;
-//     Clap_list *head = NULL;                                 // First node of the clap inputs list
+    if (state->journaling)
+        state->journal_mark[position] = state->journal_size;
+    state->segment_mark[position] = state->num_segments;
 
-//     // Populating resource matrix with busytime (latest time till which the resource is busy) for all test cores
-//     for (int i = 0; i < num_test_cores; i++) {
+    // Find the testtime of the first segment (assuming no resource conflicts)
+    individual_testtime = find_position_segment_testtime (state, mapping, position, io_pair, find_position_segment_patterns (state, mapping, position, 0));
 
-//         create_clap_input_list (&head, starttime, endtime, input_core, test_core, output_core, num_io_pairs, io_pair);     
+    // This io pair still has to run its remaining first segments one after the other
+    if (state->cutoff < NO_CUTOFF) {
+        state->remaining_workload[io_pair - 1] -= individual_testtime;
+        state->bound = max(state->bound, io_busytime + individual_testtime + state->remaining_workload[io_pair - 1]);
+        if (state->bound >= state->cutoff)
+            return EVAL_DOMINATED;
+    }
 
-        // CALL CLAP FUNCTIONS
-// }
+    status = schedule_segment (state, mapping, position, io_pair, 0, 0.0, individual_testtime);
+    if (state->num_segments == state->segment_mark[position])
+        return status;
 
-// Initializes PSO particles by initializing the I/O core, frequencies and test core mapping; calculates the fitness value for each particle
+    state->testtime[position] = individual_testtime;
+    state->starttime[position] = state->segments[state->num_segments - 1].starttime;
+    state->endtime[position] = state->segments[state->num_segments - 1].endtime;
+    state->num_scheduled = position + 1;
 
-void init_pso_particles (PSO_particle *pso_particle, Gbest_PSO_particle *gbest_pso_particle, NoC_node *noc_nodes, int num_cores, double *freq, int num_freq, IO_pairs *io_pairs, int num_io_pairs, int N_columns) {
+    return status;
+}
 
-    int num_test_cores = num_cores - (2 * num_io_pairs);       // Number of test cores in the NoC mesh network
-    int *temp_arr;                                             // Temporary array to store test core ids
-    int ii = 0;                                                // Index to traverse through the temporary array
-    int p = 0;                                                 // Index to traverse through PSO particle struct array
+// Orders pending segments by ready time, then by position in the mapping
+
+static int segment_event_before (Segment_event *a, Segment_event *b) {
+    return (a->ready_time < b->ready_time) || (a->ready_time == b->ready_time && a->position < b->position);
+}
+
+// Adds a pending segment to the binary min-heap of segment events
+
+static void push_segment_event (Segment_event *heap, int *heap_size, Segment_event event) {
+    int i = (*heap_size)++;
+
+    while (i > 0 && segment_event_before (&event, &heap[(i - 1) / 2])) {
+        heap[i] = heap[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    heap[i] = event;
+}
+
+// Removes and returns the earliest pending segment from the binary min-heap of segment events
+
+static Segment_event pop_segment_event (Segment_event *heap, int *heap_size) {
+    Segment_event top = heap[0];
+    Segment_event last = heap[--(*heap_size)];
+    int i = 0;
+    int child = 0;
+
+    while ((child = 2 * i + 1) < *heap_size) {
+        if (child + 1 < *heap_size && segment_event_before (&heap[child + 1], &heap[child]))
+            child++;
+        if (!segment_event_before (&heap[child], &last))
+            break;
+        heap[i] = heap[child];
+        i = child;
+    }
+    heap[i] = last;
+    return top;
+}
+
+// Schedules all remaining segments of preempted tests once every first segment is scheduled (counts as position num_test_cores)
+// Segments are taken from a priority queue in order of their ready time (end of the previous segment of the same test) and
+// resumed on the io pair that finishes them first, preferring the io pair of the mapping on ties; O(segments log num_test_cores)
+
+int resume_preempted_tests (Eval_state *state, Genome *mapping) {
+
+    int num_test_cores = state->num_test_cores;
+    Segment_event *heap = state->pending;              // Pending segments, at most one per test
+    int heap_size = 0;
+    Segment_event event;                               // Segment being scheduled
+    int mapped_io_pair = 0;                            // IO pair of the test in the mapping
+    int io_pair = 0;                                   // IO pair the segment is resumed on
+    int num_patterns = 0;
+    double testtime = 0.0;                             // Segment testtime through the chosen io pair
+    double finish = 0.0;                               // Segment endtime assuming no resource conflicts
+    double best_finish = 0.0;
+    int status = EVAL_COMPLETE;
+
+    if (state->journaling)
+        state->journal_mark[num_test_cores] = state->journal_size;
+    state->segment_mark[num_test_cores] = state->num_segments;
+    state->num_scheduled = num_test_cores + 1;
+
+    for (int s = 0; s < state->segment_mark[num_test_cores]; s++) {
+        if (state->segments[s].next_segment != LAST_TEST_ADMINISTERED) {
+            event.ready_time = state->segments[s].endtime;
+            event.position = state->segments[s].position;
+            event.segment_no = state->segments[s].next_segment;
+            push_segment_event (heap, &heap_size, event);
+        }
+    }
+
+    while (heap_size > 0) {
+        event = pop_segment_event (heap, &heap_size);
+        mapped_io_pair = mapping->io_pair[event.position];
+        num_patterns = find_position_segment_patterns (state, mapping, event.position, event.segment_no);
+
+        // IO pair that finishes the segment first, starting with the mapped one
+        io_pair = 0;
+        for (int j = 0; j < state->num_io_pairs; j++) {
+            int k = (mapped_io_pair - 1 + j) % state->num_io_pairs + 1;
+            double k_testtime = find_position_segment_testtime (state, mapping, event.position, k, num_patterns);
+
+            finish = max(state->io_busytime[k - 1], event.ready_time) + k_testtime;
+            if (io_pair == 0 || finish < best_finish) {
+                io_pair = k;
+                testtime = k_testtime;
+                best_finish = finish;
+            }
+        }
+
+        if (best_finish >= state->cutoff) {
+            state->bound = max(state->bound, best_finish);
+            return EVAL_DOMINATED;
+        }
+
+        status = schedule_segment (state, mapping, event.position, io_pair, event.segment_no, event.ready_time, testtime);
+        if (status == EVAL_DOMINATED)
+            return status;
+
+        // The next segment of the same test becomes ready when this one ends
+        if (state->segments[state->num_segments - 1].next_segment != LAST_TEST_ADMINISTERED) {
+            event.ready_time = state->segments[state->num_segments - 1].endtime;
+            event.segment_no = state->segments[state->num_segments - 1].next_segment;
+            push_segment_event (heap, &heap_size, event);
+        }
+    }
+
+    return EVAL_COMPLETE;
+}
+
+// Rolls a journaling evaluation state back to the point before the test core at the given position was scheduled
+// (position num_test_cores stands for the resumed segments)
+
+void rollback_eval_state (Eval_state *state, int position) {
+    if (position >= state->num_scheduled)
+        return;
+
+    while (state->journal_size > state->journal_mark[position]) {
+        Journal_entry *entry = &state->journal[--state->journal_size];
+        *entry->time = entry->old_time;
+        if (entry->port_map != NULL)
+            *entry->port_map = entry->old_port_map;
+    }
+    state->num_segments = state->segment_mark[position];
+    state->num_scheduled = position;
+}
+
+// Delta evaluation: reschedules the mapping from the given position onwards, reusing the scheduled prefix, returns the total testtime
+// Positions before num_valid must still match the mapping; the resumed segments depend on all positions and are always rescheduled.
+// If the total testtime reaches the cutoff, the evaluation stops early and a lower bound (>= cutoff) is returned; only the positions
+// scheduled so far are valid then
+
+double evaluate_from (Eval_state *state, Genome *mapping, int position, double cutoff) {
+    int start = (position < state->num_valid) ? position : state->num_valid;
+    int status = EVAL_COMPLETE;
+
+    // An evaluation stopped at its cutoff leaves only a shorter prefix scheduled
+    if (start > state->num_scheduled)
+        start = state->num_scheduled;
+
+    PROFILE_ENTER(state->profile, PROFILE_DELTA_EVALUATION);
+    rollback_eval_state (state, start);
+    state->context->num_delta_evaluations++;
+
+    PROFILE_ENTER(state->profile, PROFILE_PREPARE);
+    status = prepare_evaluation (state, mapping, start, cutoff);
+    PROFILE_EXIT(state->profile);
+    if (status == EVAL_DOMINATED) {
+        state->num_valid = start;
+        state->context->num_dominated_evaluations++;
+        PROFILE_EXIT(state->profile);
+        return state->bound;
+    }
+
+    for (int i = start; i < state->num_test_cores; i++) {
+        PROFILE_ENTER(state->profile, PROFILE_SCHEDULE_TEST);
+        status = schedule_test_core (state, mapping, i);
+        PROFILE_EXIT(state->profile);
+        if (status == EVAL_DOMINATED) {
+            state->num_valid = state->num_scheduled;
+            state->context->num_dominated_evaluations++;
+            PROFILE_EXIT(state->profile);
+            return state->bound;
+        }
+    }
+    state->num_valid = state->num_test_cores;
+
+    PROFILE_ENTER(state->profile, PROFILE_RESUME);
+    status = resume_preempted_tests (state, mapping);
+    PROFILE_EXIT(state->profile);
+    if (status == EVAL_DOMINATED) {
+        state->context->num_dominated_evaluations++;
+        PROFILE_EXIT(state->profile);
+        return state->bound;
+    }
+
+#ifdef NOC_DEBUG
+    // Debug builds (-DNOC_DEBUG) assert that every complete schedule is free of conflicting resource use
+    {
+        Conflict_report report;
+        if (check_schedule_conflicts (state, &report) != 0) {
+            print_conflict_report (stderr, &report);
+            abort ();
+        }
+    }
+#endif
+
+    PROFILE_EXIT(state->profile);
+    return state->makespan;
+}
+
+// Populates the resource matrix with busytimes for all resources [links and router ports] along the least-loaded candidate routes
+// Stops as soon as the total testtime is known to reach the cutoff and returns EVAL_DOMINATED; the particle's testtime is then
+// only a lower bound and the IO schedule lists are incomplete
+
+int find_resource_busytimes (PSO_particle *pso_particle, NoC_node *noc_nodes, int N_columns, int num_cores, IO_pairs *io_pairs, int num_io_pairs, PSO_context *context, double cutoff) {
+
+    int num_test_cores = num_cores - (2 * num_io_pairs);      // Number of test cores in the NoC mesh network
+    Eval_state *state;                                        // Resource matrix and io pair busytimes
+    All_times *times_head = NULL; 
+    int io_pair = 0;
+    int status = EVAL_COMPLETE;                               // EVAL_DOMINATED once the cutoff is reached
+    FILE *out_file = context->out_file;
+    Test_segment *segment;                                    // Resumed segment of a preempted test
+    Genome *mapping = &pso_particle->mapping;
+
+    // Every evaluation starts from an empty arena and empty IO schedule lists -- the previous evaluation's scratch is released at once
+    PROFILE_ENTER(context->profile, PROFILE_FULL_EVALUATION);
+    reset_eval_arena (context->arena);
+    for (int i = 0; i < num_io_pairs; i++)
+        clear_IO_list (io_pairs[i].io_head);
+
+    state = build_eval_state (context->arena, noc_nodes, N_columns, num_cores, io_pairs, num_io_pairs, context, 0);
+
+    PROFILE_ENTER(context->profile, PROFILE_PREPARE);
+    status = prepare_evaluation (state, mapping, 0, cutoff);
+    PROFILE_EXIT(context->profile);
+
+    // Populating resource matrix with busytime (latest time till which the resource is busy) for all test cores
+    for (int i = 0; i < num_test_cores && status == EVAL_COMPLETE; i++) {
+
+        io_pair = mapping->io_pair[i];
+        if (out_file != NULL)
+            fprintf(out_file, "\n IO (%d): %lf\n", io_pair - 1, state->io_busytime[io_pair - 1]);
+
+        PROFILE_ENTER(context->profile, PROFILE_SCHEDULE_TEST);
+        status = schedule_test_core (state, mapping, i);
+        PROFILE_EXIT(context->profile);
+        if (state->num_scheduled <= i)
+            break;
+        if (out_file != NULL)
+            fprintf(out_file, " Test: %lf\n\n", state->testtime[i]);
+
+        // Update list of all starttimes and endtimes
+        update_times_list(context->arena, &times_head, state->starttime[i]);
+        update_times_list(context->arena, &times_head, state->endtime[i]);
+
+        // Update IO list schedule
+        update_IO_list(context->arena, io_pairs[io_pair - 1].io_head, state->starttime[i], state->endtime[i], mapping->test_core[i], 0,
+                       find_num_segments (noc_nodes[mapping->test_core[i] - 1].test_patterns, mapping->preemption[i]));
+
+        // Printing the resource matrix with calculated busytimes
+        print_resource_matrix (out_file, state);
+    }
+
+    // Remaining segments of the preempted tests
+    if (status == EVAL_COMPLETE) {
+        PROFILE_ENTER(context->profile, PROFILE_RESUME);
+        status = resume_preempted_tests (state, mapping);
+        PROFILE_EXIT(context->profile);
+    }
+
+    for (int s = (state->num_scheduled > num_test_cores) ? state->segment_mark[num_test_cores] : state->num_segments; s < state->num_segments; s++) {
+        segment = &state->segments[s];
+        if (out_file != NULL)
+            fprintf(out_file, "\n Resumed: core %d segment %d on IO (%d): %lf to %lf\n", segment->test_core, segment->segment_no + 1, segment->io_pair - 1, segment->starttime, segment->endtime);
+
+        update_times_list(context->arena, &times_head, segment->starttime);
+        update_times_list(context->arena, &times_head, segment->endtime);
+        update_IO_list(context->arena, io_pairs[segment->io_pair - 1].io_head, segment->starttime, segment->endtime, segment->test_core, segment->segment_no,
+                       find_num_segments (noc_nodes[segment->test_core - 1].test_patterns, mapping->preemption[segment->position]));
+    }
+
+    context->num_full_evaluations++;
+    pso_particle->dominated = (status == EVAL_DOMINATED);
+
+    if (status == EVAL_DOMINATED) {
+        context->num_dominated_evaluations++;
+        pso_particle->testtime = state->bound;
+        pso_particle->fitness = pso_particle->testtime;
+        if (out_file != NULL)
+            fprintf(out_file, " Dominated: testtime of at least %lf reaches the cutoff %lf\n", state->bound, cutoff);
+        PROFILE_EXIT(context->profile);
+        return status;
+    }
+
+    // Printing the resource matrix with calculated busytimes
+    print_resource_matrix (out_file, state);
+
+    // Fitness is the total testtime until the SNR term is available
+    pso_particle->testtime = state->makespan;
+    pso_particle->fitness = pso_particle->testtime;
+
+    if (out_file != NULL)
+        fprintf(out_file, " Total testtime for given mapping: %lf\n", pso_particle->testtime);
+
+    PROFILE_EXIT(context->profile);
+    return status;
+}
+
+// void create_clap_input_list (Clap_inputs_head *head, IO_pairs *io_pairs, int num_io_pairs) {
+    // Clap_list *temp = *head;
+
+    // new_node->next = NULL;
+
+    // if (*head == NULL) {
+    //     Clap_list *new_node = (Clap_list*) malloc (sizeof (Clap_list));
+    //     *head = new_node;
+    //     new_node->clap_inputs[io_pair - 1].starttime = starttime;
+    //     new_node->clap_inputs[io_pair - 1].endtime = endtime;
+    //     new_node->clap_inputs[io_pair - 1].input_core = input_core;
+    //     new_node->clap_inputs[io_pair - 1].test_core = test_core;
+    //     new_node->clap_inputs[io_pair - 1].output_core = output_core;
+    //     new_node->clap_inputs[io_pair - 1].filled = FILLED;
+    // }
+    // else {
+    //     while (temp->next != NULL) {
+    //         for (int i = 0; i < num_io_pairs; i++){
+    //             if (new_node->clap_inputs[i].starttime < new_node->clap_inputs[io_pair - 1].starttime)
+    //         }
+    //         temp = temp->next;
+    //     }
+    // }
+// }
+
+// double calculate_worst_case_SNR (PSO_particle *pso_particle, NoC_node *noc_nodes, int N_columns, int num_cores, IO_pairs *io_pairs, int num_io_pairs) {
+//     int num_test_cores = num_cores - (2 * num_io_pairs);    // Number of test cores in the NoC mesh network
+//     int test_core = 0;                                      // Temporary variable to store test core number
+//     int input_core = 0;                                     // Temporary variable to store input core number
+//     int output_core = 0;                                    // Temporary variable to store output core number
+//     double starttime = 0.0;                                 // Temporary variable to store test starttime
+//     double endtime = 0.0;                                   // Temporary variable to store test endtime
+//     int io_pair = 0;
+//     Clap_list *head = NULL;                                 // First node of the clap inputs list
+
+//     // Populating resource matrix with busytime (latest time till which the resource is busy) for all test cores
+//     for (int i = 0; i < num_test_cores; i++) {
+
+//         create_clap_input_list (&head, starttime, endtime, input_core, test_core, output_core, num_io_pairs, io_pair);     
+
+        // CALL CLAP FUNCTIONS
+// }
+
+// Initializes PSO particles by initializing the I/O core, frequencies and test core mapping; calculates the fitness value for each particle
+
+void init_pso_particles (PSO_particle *pso_particle, Gbest_PSO_particle *gbest_pso_particle, NoC_node *noc_nodes, int num_cores, int num_freq, IO_pairs *io_pairs, int num_io_pairs, int N_columns, PSO_context *context) {
+
+    int num_test_cores = num_cores - (2 * num_io_pairs);       // Number of test cores in the NoC mesh network
+    int *temp_arr;                                             // Temporary array to store test core ids
+    int ii = 0;                                                // Index to traverse through the temporary array
+    int p = 0;                                                 // Index to traverse through PSO particle struct array
     int i = 0;                                                 // Index to traverse through NoC nodes struct array
-    int j = 0;                                                 // Index to traverse through the mapping 
     double best_fitness = 128797218.0;                         // Temporary variable to store best fitness value
     int best_idx = 0;                                          // Temporary variable to store index of the particle with best fitness value
-    int io_idx = 0;                                            // Temporary variable to store io pairs array index
 
     // Store all test core numbers temporarily in an array - for ease of access
     temp_arr = (int *) malloc (num_test_cores * sizeof (int));
@@ -798,43 +1645,16 @@ void init_pso_particles (PSO_particle *pso_particle, Gbest_PSO_particle *gbest_p
     }
 
     // For all particles
-    for (p = 0; p < NUM_PSO_PARTICLES; p++) {
+    for (p = 0; p < context->num_particles; p++) {
 
         // Create schedule lists for all particles
         // pso_particle[p].schedule = create_schedule_list();
 
         // Initialize mapping  
-        // mapping  structure: | test core ids | io pairs assigned | test frequency | preemptions |
-
-        // Initialize mapping  test core field to UNALLOCATED
-        for (j = 0; j < num_test_cores; j++)
-            pso_particle[p].mapping[j] = UNALLOCATED; 
+        // mapping  structure: test core sequence, io pairs assigned, test frequencies, preemption points (per position)
+        init_random_genome (&pso_particle[p].mapping, temp_arr, num_test_cores, num_io_pairs, num_freq, context->rng_state);
 
-        // Randomly assign test core nos. sequence to the first field -- gives order of testing
-        for (ii = 0; ii < num_test_cores; ii++) {
-
-            // Pick a random UNALLOCATED index for allocating a test core number
-            do {
-                j = rand() % num_test_cores;
-            } while (pso_particle[p].mapping[j] != UNALLOCATED);
-
-            pso_particle[p].mapping[j] = temp_arr[ii];
-        }
-
-        // Randomly assign io pairs to test cores
-        for (j = num_test_cores; j < (2 * num_test_cores); j++)
-            pso_particle[p].mapping[j] = (rand() % num_io_pairs) + 1;
-
-        // Randomly assign a valid test frequency   
-        for (j = (2 *num_test_cores); j < (3 * num_test_cores); j++) {
-            pso_particle[p].mapping[j] = freq[(rand() % num_freq)];
-        }
-
-        // Assign preemption points - randomly generated value between 0 and 1
-        for (j = 3 * num_test_cores; j < (4 * num_test_cores); j++)
-            pso_particle[p].mapping[j] = drand48 () * 0.9 + 0.1;
-
-        find_resource_busytimes (pso_particle, noc_nodes, N_columns, num_cores, io_pairs, num_io_pairs);
+        find_resource_busytimes (&pso_particle[p], noc_nodes, N_columns, num_cores, io_pairs, num_io_pairs, context, NO_CUTOFF);
         // find SNR
         // fitness = w * (testtime) + (1 - w) * SNR;
 
@@ -846,11 +1666,10 @@ void init_pso_particles (PSO_particle *pso_particle, Gbest_PSO_particle *gbest_p
     }
 
     // Set the local best parameters
-    for (p = 0; p < NUM_PSO_PARTICLES; p++) {
+    for (p = 0; p < context->num_particles; p++) {
 
         // Local best mapping  - same as the initialized mapping 
-        for (j = 0; j < 4 * num_test_cores; j++)
-            pso_particle[p].lbest_mapping[j] = pso_particle[p].mapping[j];
+        copy_genome (&pso_particle[p].lbest_mapping, &pso_particle[p].mapping);
 
         // Local best fitness value - same as the fitness value calculated for initialized mappings
         pso_particle[p].lbest_fitness = pso_particle[p].fitness;
@@ -858,19 +1677,125 @@ void init_pso_particles (PSO_particle *pso_particle, Gbest_PSO_particle *gbest_p
 
     // Set the global best particle parameters
     // Global best mapping 
-    for (j = 0; j < 4 * num_test_cores; j++) {
-        gbest_pso_particle->gbest_mapping[j] = pso_particle[best_idx].mapping[j];
-        gbest_pso_particle->gbest_fitness = best_fitness;   
-    }
+    copy_genome (&gbest_pso_particle->gbest_mapping, &pso_particle[best_idx].mapping);
+    gbest_pso_particle->gbest_fitness = best_fitness;   
 
     free (temp_arr);
 }
 
+// Initializes a mapping with a random test core sequence (a permutation of test_cores), io pairs, frequencies and preemption points
+
+void init_random_genome (Genome *mapping, int *test_cores, int num_test_cores, int num_io_pairs, int num_freq, unsigned short *rng_state) {
+    int j = 0;                                                 // Index to traverse through the mapping 
+
+    // Initialize mapping  test core field to UNALLOCATED
+    for (j = 0; j < num_test_cores; j++)
+        mapping->test_core[j] = UNALLOCATED; 
+
+    // Randomly assign test core nos. sequence to the first field -- gives order of testing
+    for (int ii = 0; ii < num_test_cores; ii++) {
+
+        // Pick a random UNALLOCATED index for allocating a test core number
+        do {
+            j = nrand48 (rng_state) % num_test_cores;
+        } while (mapping->test_core[j] != UNALLOCATED);
+
+        mapping->test_core[j] = test_cores[ii];
+    }
+
+    // Randomly assign io pairs to test cores
+    for (j = 0; j < num_test_cores; j++)
+        mapping->io_pair[j] = (nrand48 (rng_state) % num_io_pairs) + 1;
+
+    // Randomly assign a valid test frequency   
+    for (j = 0; j < num_test_cores; j++)
+        mapping->freq_index[j] = nrand48 (rng_state) % num_freq;
+
+    // Assign preemption points - randomly generated value between 0 and 1
+    for (j = 0; j < num_test_cores; j++)
+        mapping->preemption[j] = erand48 (rng_state) * (PREEMPTION_MAX - PREEMPTION_MIN) + PREEMPTION_MIN;
+}
+
+// Allocates the arrays of a mapping of num_tests tests as one block (preemption points first, so every array stays aligned)
+
+void init_genome (Genome *mapping, int num_tests) {
+    char *block = (char *) malloc ((num_tests > 0 ? num_tests : 1) * GENOME_BYTES_PER_TEST);
+
+    mapping->num_tests = num_tests;
+    mapping->preemption = (float *) block;
+    mapping->test_core = (short *) (block + num_tests * sizeof (float));
+    mapping->io_pair = (unsigned char *) (block + num_tests * (sizeof (float) + sizeof (short)));
+    mapping->freq_index = mapping->io_pair + num_tests;
+}
+
+// Copies mapping src into dst (allocated for the same number of tests)
+
+void copy_genome (Genome *dst, Genome *src) {
+    memcpy (dst->preemption, src->preemption, src->num_tests * GENOME_BYTES_PER_TEST);
+}
+
+// Releases the arrays of a mapping
+
+void free_genome (Genome *mapping) {
+    free (mapping->preemption);
+    mapping->preemption = NULL;
+}
+
+// Seeds the random number generator of a PSO run (same state layout as srand48)
+
+void seed_pso_context (PSO_context *context, unsigned int seed) {
+    context->rng_state[0] = 0x330E;
+    context->rng_state[1] = (unsigned short)(seed & 0xFFFF);
+    context->rng_state[2] = (unsigned short)(seed >> 16);
+}
+
+// Initializes run settings with the defaults of a single run (PSO, XY routing, adaptive coefficients, no checkpoints, replays or exports)
+
+void init_pso_context (PSO_context *context, FILE *out_file) {
+    context->out_file = out_file;
+    context->testtime_table = NULL;
+    context->routing = ROUTING_XY;
+    context->route_table = NULL;
+    context->validate = 0;
+    context->check = 0;
+    context->export_format = EXPORT_NONE;
+    context->export_file = NULL;
+    context->num_particles = DEFAULT_NUM_PARTICLES;
+    context->max_generations = DEFAULT_MAX_GENERATIONS;
+    context->generation = 0;
+    context->checkpoint_file = NULL;
+    context->checkpoint_interval = 0;
+    context->resume_file = NULL;
+    context->time_limit = 0.0;
+    context->stop_requested = NULL;
+    context->refine_interval = DEFAULT_REFINE_INTERVAL;
+    context->num_full_evaluations = 0;
+    context->num_delta_evaluations = 0;
+    context->num_dominated_evaluations = 0;
+    context->target_gap = 0.0;
+    context->engine = ENGINE_PSO;
+    context->trace.num_points = 0;
+    context->num_threads = 0;
+    context->adaptive = 1;
+    context->seeding = 1;
+    context->alpha = ALPHA;
+    context->beta = BETA;
+    context->success_rate = ADAPT_SUCCESS_LOW;
+    context->diversity = 1.0;
+    context->arena = NULL;
+    context->profile = NULL;
+    context->profile_file = NULL;
+    context->hierarchical = 0;
+    context->warm_start_file = NULL;
+    context->best_mapping = NULL;
+    seed_pso_context (context, 0);
+}
+
 // Generates random number between 0 and 1 (probability distribution: uniform)
 
-double generate_random_number () {
+double generate_random_number (unsigned short *rng_state) {
     double x = 0.0; 
-    int y = rand(); 
+    int y = nrand48 (rng_state); 
     x = (y % 1009) + 1;
     x = x / 1009;
     return x;
@@ -878,7 +1803,7 @@ double generate_random_number () {
 
 // Swaps io pairs with given probability 
 
-void swap_io_pair (int num_test_cores, double *a, double *b, double probability) {
+void swap_io_pair (int num_test_cores, Genome *a, Genome *b, double probability, unsigned short *rng_state) {
     double temp = 0.0;
     int i = 0;
 
@@ -886,17 +1811,17 @@ void swap_io_pair (int num_test_cores, double *a, double *b, double probability)
     for (i = 0; i < num_test_cores; i++) {
         
         // Generate a random probability value between 0 and 1
-        temp = generate_random_number();
+        temp = generate_random_number(rng_state);
         
         // If the given probability exceeds or equals this value -- SWAP
         if (temp <= probability) 
-            a[num_test_cores + i] = b[num_test_cores + i];
+            a->io_pair[i] = b->io_pair[i];
     }
 }
 
 // Checks frequency validity for newly assigned test core, swaps frequencies
 
-void swap_frequencies (int num_test_cores, double *a, double *b, double probability) {
+void swap_frequencies (int num_test_cores, Genome *a, Genome *b, double probability, unsigned short *rng_state) {
     double temp = 0.0;
     int i = 0;
 
@@ -904,43 +1829,49 @@ void swap_frequencies (int num_test_cores, double *a, double *b, double probabil
     for (i = 0; i < num_test_cores; i++) {
 
         // Generate a random probability value between 0 and 1
-        temp = generate_random_number(); 
+        temp = generate_random_number(rng_state); 
 
         // If the given probability exceeds or equals this value, and the frequency to be 
         // assigned lies within the valid range for this particle -- SWAP
         if (temp <= probability) {
-            a[2 * num_test_cores + i] = b[2 * num_test_cores + i];
+            a->freq_index[i] = b->freq_index[i];
         }
     }
 }
 
 // Generates a sequence of swap operators for evolving a given particle's test core sequence 
+// Each mismatched position finds the matching core through the position index, so the sequence is built in O(num_test_cores)
 
-int generate_swap_operator_sequence (int num_test_cores, double *a, double *b, Swap_operator* swap_operator) {
+int generate_swap_operator_sequence (int num_test_cores, Genome *a, Genome *b, Swap_operator* swap_operator, Swap_scratch *scratch) {
     int num_swap_operators = 0;          // Number of swap operators in the swap sequence
-    double temp[num_test_cores];
+    int *temp = scratch->sequence;       // Particle test core sequence as modified by the swaps so far
+    int *position = scratch->position;   // Position of every test core in temp
+    int target = 0;                      // Test core at the ith position of the target sequence
     int i = 0;
     int j = 0;
 
-    // Copy a (particle test core sequence) into temp
-    for(i = 0; i < num_test_cores; i++)
-        temp[i] = a[i]; 
+    // Copy a (particle test core sequence) into temp and index it
+    for (i = 0; i < num_test_cores; i++) {
+        temp[i] = a->test_core[i];
+        position[temp[i]] = i;
+    }
 
     // Traverse the entire test core sequence of the particle and its local best
     for (i = 0; i < num_test_cores; i++) {
+        target = b->test_core[i];
 
         // If the corresponding ith elements don't match
-        if (temp[i] != b[i]) {
-            
-            // Find the jth element in temp that matches the ith element 
-            // of local best particle's test core sequence 
-            j = i;
-            while (temp[j] != b[i]) 
-                j++;
+        if (temp[i] != target) {
+
+            // The jth element of temp matches the ith element of the target sequence
+            // (positions before i already match, so j > i)
+            j = position[target];
 
-            // (Update temp for finding indices for modified sequence in the next iteration)
+            // (Update temp and the index for finding indices for modified sequence in the next iteration)
             temp[j] = temp[i];
-            temp[i] = b[i];
+            position[temp[j]] = j;
+            temp[i] = target;
+            position[target] = i;
 
             // We can now swap the ith element with jth element in the particle's
             // test core sequence to modify it to its local best sequence
@@ -954,27 +1885,43 @@ int generate_swap_operator_sequence (int num_test_cores, double *a, double *b, S
     return num_swap_operators;
 }
 
+// Allocates the scratch space of the swap operator sequence generation for test cores numbered 1 .. num_cores
+
+Swap_scratch *create_swap_scratch (int num_test_cores, int num_cores) {
+    Swap_scratch *scratch = (Swap_scratch *) malloc (sizeof (Swap_scratch));
+
+    scratch->sequence = (int *) malloc (num_test_cores * sizeof (int));
+    scratch->position = (int *) malloc ((num_cores + 1) * sizeof (int));
+    scratch->swap_operators = (Swap_operator *) malloc (num_test_cores * sizeof (Swap_operator));
+    return scratch;
+}
+
+// Frees the scratch space of the swap operator sequence generation
+
+void free_swap_scratch (Swap_scratch *scratch) {
+    free (scratch->sequence);
+    free (scratch->position);
+    free (scratch->swap_operators);
+    free (scratch);
+}
+
 // Applies the sequence of swap operators on test core sequence a with give probability
 
-void swap_test_core_sequence (int num_test_cores, double *a, Swap_operator* swap_operator, int num_swap_operators, double probability) {
+void swap_test_core_sequence (int num_test_cores, Genome *a, Swap_operator* swap_operator, int num_swap_operators, double probability, unsigned short *rng_state) {
     double temp;
-    int swap_idx1 = 0;
-    int swap_idx2 = 0;
-    int temp1 = 0;
+    short temp1 = 0;
     int i = 0;
 
     for (i = 0; i < num_swap_operators; i++) {
 
         // Generate a random probability value between 0 and 1
-        temp = generate_random_number();
+        temp = generate_random_number(rng_state);
         
         // If the given probability exceeds or equals this value -- SWAP
         if (temp <= probability) {
-            swap_idx1 = swap_operator[i].swap_idx1;
-            swap_idx2 = swap_operator[i].swap_idx2;
-            temp1 = a[(swap_operator[i].swap_idx1)];
-            a[(swap_operator[i].swap_idx1)] = a[(swap_operator[i].swap_idx2)];
-            a[(swap_operator[i].swap_idx2)] = temp1;
+            temp1 = a->test_core[(swap_operator[i].swap_idx1)];
+            a->test_core[(swap_operator[i].swap_idx1)] = a->test_core[(swap_operator[i].swap_idx2)];
+            a->test_core[(swap_operator[i].swap_idx2)] = temp1;
         }
     }
 }
@@ -1024,141 +1971,4687 @@ void swap_test_core_sequence (int num_test_cores, double *a, Swap_operator* swap
 // }
 
 
-// Particle swarm optimization
+// Adjusts the attraction probabilities of a PSO run after a generation in which num_improved particles improved their local best
+// A collapsed swarm (low diversity) is pulled towards the particles' own bests instead of the global best, a stagnating but diverse
+// swarm is pulled harder towards the global best; a bounded random perturbation keeps the probabilities from settling in a bad spot
+
+void adapt_pso_coefficients (PSO_context *context, PSO_particle *pso_particle, Gbest_PSO_particle *gbest_pso_particle, int num_test_cores, int num_improved) {
+    int num_different = 0;                                     // Mapping elements (test core and io pair per position) differing from the global best
+
+    for (int p = 0; p < context->num_particles; p++) {
+        for (int i = 0; i < num_test_cores; i++) {
+            num_different += (pso_particle[p].mapping.test_core[i] != gbest_pso_particle->gbest_mapping.test_core[i]);
+            num_different += (pso_particle[p].mapping.io_pair[i] != gbest_pso_particle->gbest_mapping.io_pair[i]);
+        }
+    }
+    context->diversity = (double) num_different / (2.0 * num_test_cores * context->num_particles);
+    context->success_rate = (1 - ADAPT_SMOOTHING) * context->success_rate + ADAPT_SMOOTHING * num_improved / context->num_particles;
+
+    if (context->diversity < ADAPT_DIVERSITY_LOW) {
+        context->alpha += ADAPT_STEP;
+        context->beta -= ADAPT_STEP;
+    }
+    else if (context->success_rate < ADAPT_SUCCESS_LOW) {
+        context->alpha -= ADAPT_STEP;
+        context->beta += ADAPT_STEP;
+    }
+
+    context->alpha += (2 * erand48 (context->rng_state) - 1) * ADAPT_JITTER;
+    context->beta += (2 * erand48 (context->rng_state) - 1) * ADAPT_JITTER;
+    context->alpha = (context->alpha < ADAPT_MIN) ? ADAPT_MIN : (context->alpha > ADAPT_MAX) ? ADAPT_MAX : context->alpha;
+    context->beta = (context->beta < ADAPT_MIN) ? ADAPT_MIN : (context->beta > ADAPT_MAX) ? ADAPT_MAX : context->beta;
+}
+
+// Checks at a generation boundary whether a search run has to stop: the budget is used up or a stop was requested (stopped_early),
+// or the best total testtime is within the target gap of the lower bound (target_reached)
+
+static int check_search_stop (Search_problem *problem, double best_testtime) {
+    PSO_context *context = problem->context;
+
+    if ((problem->deadline > 0 && get_wall_time () >= problem->deadline) || (context->stop_requested != NULL && *context->stop_requested)) {
+        context->stopped_early = 1;
+        return 1;
+    }
+
+    // The best mapping is provably close enough to optimal
+    if (context->target_gap > 0 && find_optimality_gap (&context->lower_bounds, best_testtime) <= context->target_gap) {
+        context->target_reached = 1;
+        return 1;
+    }
+    return 0;
+}
+
+// Records the best total testtime of a search run in its trace if it improved
+
+static void note_search_progress (Search_problem *problem, double best_testtime) {
+    Search_trace *trace = &problem->context->trace;
+
+    if (trace->num_points > 0 && best_testtime >= trace->testtime[trace->num_points - 1])
+        return;
+
+    // A full trace keeps the latest improvement in its last point
+    if (trace->num_points == MAX_TRACE_POINTS)
+        trace->num_points--;
+    trace->time[trace->num_points] = get_wall_time () - problem->start_time;
+    trace->testtime[trace->num_points] = best_testtime;
+    trace->num_points++;
+}
+
+// Reports why a search run ended before max_generations
+
+static void print_search_stop (Search_problem *problem) {
+    PSO_context *context = problem->context;
+
+    if (context->out_file == NULL)
+        return;
+
+    if (context->stopped_early)
+        fprintf(context->out_file, " Stopped early after %d of %d generations\n\n", context->generation, context->max_generations);
+    if (context->target_reached)
+        fprintf(context->out_file, " Target gap of %.2lf%% reached after %d generations\n\n", 100 * context->target_gap, context->generation);
+}
 
-void particle_swarm_optimization (NoC_node *noc_nodes, int num_cores, int M_rows, double *freq, int num_freq, IO_pairs *io_pairs, int num_io_pairs) {
-    int N_columns = num_cores / M_rows;                                 // Number of columns in NoC mesh network
-    int num_test_cores = num_cores - (2 * num_io_pairs);                // Number of test cores in the NoC mesh network
-    int num_pso_runs = 0;                                               // Number of PSO runs
-    int max_generations = 0;                                            // Maximum number of generations
+// Particle swarm optimization -- returns the total testtime of the global best, whose mapping is copied to best
+
+double particle_swarm_optimization (Search_problem *problem, Genome *best) {
+    NoC_node *noc_nodes = problem->noc_nodes;
+    int num_cores = problem->num_cores;
+    int N_columns = problem->N_columns;                                 // Number of columns in NoC mesh network
+    int num_test_cores = problem->num_test_cores;                       // Number of test cores in the NoC mesh network
+    IO_pairs *io_pairs = problem->io_pairs;
+    int num_io_pairs = problem->num_io_pairs;
+    double *freq = problem->freq;
+    PSO_context *context = problem->context;
     PSO_particle *pso_particle;                                         // PSO particle struct array
-    pso_particle = malloc (NUM_PSO_PARTICLES * sizeof (PSO_particle));  // Allocating memory for PSO particle struct array
+    pso_particle = malloc (context->num_particles * sizeof (PSO_particle));   // Allocating memory for PSO particle struct array
     Gbest_PSO_particle gbest_pso_particle;                              // Global best PSO particle
-    Swap_operator swap_operator[num_test_cores];                        // Sequence of swap operators for a given particle
+    Swap_scratch *swap_scratch = create_swap_scratch (num_test_cores, num_cores);   // Sequence of swap operators for a given particle
                                                                         // The swap operator exchanges the values at positions
                                                                         // (swap_idx1, swap_idx2) generate a new particle
+    Swap_operator *swap_operator = swap_scratch->swap_operators;
     int num_swap_operations = 0;                                        // Number of swap operators in the swap sequence
+    int num_improved = 0;                                               // Number of particles that improved their local best this generation
+    double best_testtime = 0.0;                                         // Total testtime of the global best
 
+    // Mappings of the particles and the global best, sized by the design
+    for (int p = 0; p < context->num_particles; p++) {
+        init_genome (&pso_particle[p].mapping, num_test_cores);
+        init_genome (&pso_particle[p].lbest_mapping, num_test_cores);
+    }
+    init_genome (&gbest_pso_particle.gbest_mapping, num_test_cores);
 
-    // Initializes the PSO particles with randomized mapping, calculates respective costs and sets the initial local and global best
-    init_pso_particles (pso_particle, (&gbest_pso_particle), noc_nodes, num_cores, freq, num_freq, io_pairs, num_io_pairs, N_columns);
+    // Resumes from the checkpoint if one is given, otherwise initializes the PSO particles with randomized mapping,
+    // calculates respective costs and sets the initial local and global best
+    if (context->resume_file != NULL && load_pso_checkpoint (context->resume_file, pso_particle, (&gbest_pso_particle), num_cores, num_io_pairs, context) == 0) {
+        if (context->out_file != NULL)
+            fprintf(context->out_file, " Resumed from checkpoint %s at generation %d\n\n", context->resume_file, context->generation);
+    }
+    else {
+        context->generation = 0;
+        context->alpha = ALPHA;
+        context->beta = BETA;
+        context->success_rate = ADAPT_SUCCESS_LOW;
+        if (context->warm_start_file != NULL && warm_start_pso_particles (problem, pso_particle, (&gbest_pso_particle)) == 0)
+            ;
+        else if (context->seeding)
+            seed_pso_particles (problem, pso_particle, (&gbest_pso_particle));
+        else
+            init_pso_particles (pso_particle, (&gbest_pso_particle), noc_nodes, num_cores, problem->num_freq, io_pairs, num_io_pairs, N_columns, context);
+    }
+    note_search_progress (problem, gbest_pso_particle.gbest_fitness);
 
-    print_pso_particle_info (pso_particle, num_test_cores);
-    print_global_best_info ((&gbest_pso_particle), num_test_cores);
+    print_pso_particle_info (context->out_file, pso_particle, context->num_particles, num_test_cores, freq);
+    print_global_best_info (context->out_file, (&gbest_pso_particle), num_test_cores, freq);
 
-    // while (1) {
-        for (int p = 0; p < NUM_PSO_PARTICLES; p++) {
+    while (context->generation < context->max_generations) {
 
-            swap_io_pair (num_test_cores, pso_particle[p].mapping, pso_particle[p].lbest_mapping, ALPHA);
-            swap_io_pair (num_test_cores, pso_particle[p].mapping, gbest_pso_particle.gbest_mapping, BETA);
-            
-            swap_frequencies (num_test_cores, pso_particle[p].mapping, pso_particle[p].lbest_mapping, ALPHA);
-            swap_frequencies (num_test_cores, pso_particle[p].mapping, gbest_pso_particle.gbest_mapping, BETA);
+        // Anytime behaviour: stop at a generation boundary once the budget is used up, a stop was requested or
+        // the target gap is reached, the global best found so far is reported
+        if (check_search_stop (problem, gbest_pso_particle.gbest_fitness))
+            break;
 
-            num_swap_operations = generate_swap_operator_sequence (num_test_cores, pso_particle[p].mapping, pso_particle[p].lbest_mapping, swap_operator);
-            swap_test_core_sequence (num_test_cores, pso_particle[p].mapping, swap_operator, num_swap_operations, ALPHA);
+        PROFILE_ENTER(context->profile, PROFILE_GENERATION);
+        num_improved = 0;
+        for (int p = 0; p < context->num_particles; p++) {
 
-            num_swap_operations = generate_swap_operator_sequence (num_test_cores, pso_particle[p].mapping, gbest_pso_particle.gbest_mapping, swap_operator);
-            swap_test_core_sequence (num_test_cores, pso_particle[p].mapping, swap_operator, num_swap_operations, BETA);
+            PROFILE_ENTER(context->profile, PROFILE_SWAP_IO_PAIR);
+            swap_io_pair (num_test_cores, &pso_particle[p].mapping, &pso_particle[p].lbest_mapping, context->alpha, context->rng_state);
+            swap_io_pair (num_test_cores, &pso_particle[p].mapping, &gbest_pso_particle.gbest_mapping, context->beta, context->rng_state);
+            PROFILE_EXIT(context->profile);
+            
+            PROFILE_ENTER(context->profile, PROFILE_SWAP_FREQUENCY);
+            swap_frequencies (num_test_cores, &pso_particle[p].mapping, &pso_particle[p].lbest_mapping, context->alpha, context->rng_state);
+            swap_frequencies (num_test_cores, &pso_particle[p].mapping, &gbest_pso_particle.gbest_mapping, context->beta, context->rng_state);
+            PROFILE_EXIT(context->profile);
+
+            PROFILE_ENTER(context->profile, PROFILE_SWAP_SEQUENCE);
+            num_swap_operations = generate_swap_operator_sequence (num_test_cores, &pso_particle[p].mapping, &pso_particle[p].lbest_mapping, swap_operator, swap_scratch);
+            PROFILE_EXIT(context->profile);
+            PROFILE_ENTER(context->profile, PROFILE_SWAP_TEST_CORES);
+            swap_test_core_sequence (num_test_cores, &pso_particle[p].mapping, swap_operator, num_swap_operations, context->alpha, context->rng_state);
+            PROFILE_EXIT(context->profile);
+
+            PROFILE_ENTER(context->profile, PROFILE_SWAP_SEQUENCE);
+            num_swap_operations = generate_swap_operator_sequence (num_test_cores, &pso_particle[p].mapping, &gbest_pso_particle.gbest_mapping, swap_operator, swap_scratch);
+            PROFILE_EXIT(context->profile);
+            PROFILE_ENTER(context->profile, PROFILE_SWAP_TEST_CORES);
+            swap_test_core_sequence (num_test_cores, &pso_particle[p].mapping, swap_operator, num_swap_operations, context->beta, context->rng_state);
+            PROFILE_EXIT(context->profile);
             
             // modify_preemption_points (num_test_cores, pso_particle[p].mapping, pso_particle[p].lbest_mapping, gbest_pso_particle.gbest_mapping);
+
+            // Evaluate the new position and update the local best -- the local best is never better than the global best,
+            // so a position that cannot beat it is abandoned as soon as that is known
+            if (find_resource_busytimes (&pso_particle[p], noc_nodes, N_columns, num_cores, io_pairs, num_io_pairs, context, pso_particle[p].lbest_fitness) == EVAL_COMPLETE &&
+                pso_particle[p].fitness < pso_particle[p].lbest_fitness) {
+                copy_genome (&pso_particle[p].lbest_mapping, &pso_particle[p].mapping);
+                pso_particle[p].lbest_fitness = pso_particle[p].fitness;
+                num_improved++;
+            }
+        }
+
+        // Update the global best
+        for (int p = 0; p < context->num_particles; p++) {
+            if (pso_particle[p].lbest_fitness < gbest_pso_particle.gbest_fitness) {
+                copy_genome (&gbest_pso_particle.gbest_mapping, &pso_particle[p].lbest_mapping);
+                gbest_pso_particle.gbest_fitness = pso_particle[p].lbest_fitness;
+            }
+        }
+
+        // Memetic step: refine the global best by local search every refine_interval generations
+        if (context->refine_interval > 0 && (context->generation + 1) % context->refine_interval == 0) {
+            PROFILE_ENTER(context->profile, PROFILE_LOCAL_SEARCH);
+            refine_global_best ((&gbest_pso_particle), noc_nodes, N_columns, num_cores, io_pairs, num_io_pairs, context);
+            PROFILE_EXIT(context->profile);
+        }
+        note_search_progress (problem, gbest_pso_particle.gbest_fitness);
+
+        // Attraction probabilities of the next generation
+        if (context->adaptive) {
+            PROFILE_ENTER(context->profile, PROFILE_ADAPT);
+            adapt_pso_coefficients (context, pso_particle, (&gbest_pso_particle), num_test_cores, num_improved);
+            PROFILE_EXIT(context->profile);
+            if (context->out_file != NULL)
+                fprintf(context->out_file, " Coefficients: alpha %.3lf, beta %.3lf (success rate %.2lf, diversity %.2lf)\n", context->alpha, context->beta, context->success_rate, context->diversity);
         }
 
         for (int i = 0; i < num_io_pairs; i++)
-            print_IO_schedule_lists (io_pairs[i].io_head);
-        printf("\n");
-    // }   
-    print_pso_particle_info (pso_particle, num_test_cores);
-    print_global_best_info((&gbest_pso_particle), num_test_cores);
+            print_IO_schedule_lists (context->out_file, io_pairs[i].io_head);
+        if (context->out_file != NULL)
+            fprintf(context->out_file, "\n");
+        PROFILE_EXIT(context->profile);
 
-}
+        context->generation++;
 
+        // Checkpoints are taken at generation boundaries, so a resumed run continues with exactly the same random sequence
+        if (context->checkpoint_file != NULL && context->checkpoint_interval > 0 && context->generation % context->checkpoint_interval == 0)
+            save_pso_checkpoint (context->checkpoint_file, pso_particle, (&gbest_pso_particle), num_cores, num_io_pairs, context);
+    }
 
-// =================
-// UTILITY FUNCTIONS
-// =================
+    // An interrupted run leaves a checkpoint of the state it stopped in
+    if (context->stopped_early && context->checkpoint_file != NULL)
+        save_pso_checkpoint (context->checkpoint_file, pso_particle, (&gbest_pso_particle), num_cores, num_io_pairs, context);
+    print_search_stop (problem);
 
-// Finds the maximum of two given numbers
+    print_pso_particle_info (context->out_file, pso_particle, context->num_particles, num_test_cores, freq);
+    print_global_best_info(context->out_file, (&gbest_pso_particle), num_test_cores, freq);
 
-double max (double a, double b) {
-    if (a >= b)
-        return a;
-    else 
-        return b;
+    copy_genome (best, &gbest_pso_particle.gbest_mapping);
+    best_testtime = gbest_pso_particle.gbest_fitness;
+
+    free_swap_scratch (swap_scratch);
+    for (int p = 0; p < context->num_particles; p++) {
+        free_genome (&pso_particle[p].mapping);
+        free_genome (&pso_particle[p].lbest_mapping);
+    }
+    free_genome (&gbest_pso_particle.gbest_mapping);
+    free (pso_particle);
+    return best_testtime;
 }
 
-// Prints the mapping and test schedule information for all PSO particles
+// Writes the fields of a mapping in use (num_test_cores elements each) to a checkpoint file, returns 0 on a short write
 
-void print_pso_particle_info (PSO_particle *pso_particle, int num_test_cores) {
-    int p = 0;
-    int i = 0;
-    int j = 0;
-    
-    for (p = 0; p < NUM_PSO_PARTICLES; p++) {
-        printf(" Particle %d\n", p + 1);
+static int write_genome (FILE *fptr, Genome *mapping, int num_test_cores) {
+    return fwrite (mapping->test_core, sizeof (short), num_test_cores, fptr) == (size_t) num_test_cores &&
+           fwrite (mapping->io_pair, sizeof (unsigned char), num_test_cores, fptr) == (size_t) num_test_cores &&
+           fwrite (mapping->freq_index, sizeof (unsigned char), num_test_cores, fptr) == (size_t) num_test_cores &&
+           fwrite (mapping->preemption, sizeof (float), num_test_cores, fptr) == (size_t) num_test_cores;
+}
 
-        printf(" Test core IDs: \n");
-        for (i = 0; i < num_test_cores; i++)
-            printf(" %d\t", (int)pso_particle[p].mapping[i]);
+// Reads a mapping written by write_genome, returns 0 on a short read
+
+static int read_genome (FILE *fptr, Genome *mapping, int num_test_cores) {
+    return fread (mapping->test_core, sizeof (short), num_test_cores, fptr) == (size_t) num_test_cores &&
+           fread (mapping->io_pair, sizeof (unsigned char), num_test_cores, fptr) == (size_t) num_test_cores &&
+           fread (mapping->freq_index, sizeof (unsigned char), num_test_cores, fptr) == (size_t) num_test_cores &&
+           fread (mapping->preemption, sizeof (float), num_test_cores, fptr) == (size_t) num_test_cores;
+}
 
-        printf("\n Corresponding IO pair IDs: \n");
-        for (i = num_test_cores; i < (2 * num_test_cores); i++)
-            printf(" %d\t", (int)pso_particle[p].mapping[i]);
+// Writes the complete optimiser state to a binary checkpoint file
+// The file is written under a temporary name and renamed, so an interrupted write never corrupts the previous checkpoint
 
-        printf("\n Test frequencies (normalized): \n");
-        for (i = (2 * num_test_cores); i < (3 * num_test_cores); i++)
-            printf(" %.2lf\t", pso_particle[p].mapping[i]);
+int save_pso_checkpoint (const char *file_name, PSO_particle *pso_particle, Gbest_PSO_particle *gbest_pso_particle, int num_cores, int num_io_pairs, PSO_context *context) {
 
-        printf("\n Preemption points: \n");
-        for (i = (3 * num_test_cores); i < (4 * num_test_cores); i++)
-            printf(" %.2lf\t", pso_particle[p].mapping[i]);
+    int num_test_cores = num_cores - (2 * num_io_pairs);       // Number of test cores in the NoC mesh network
+    char temp_file_name[MAX_PATH_LENGTH + 8];                  // Temporary file written before the rename
+    Checkpoint_header header;                                  // Checkpoint file header
+    FILE *fptr;
+    int ok = 1;
+
+    memset (&header, 0, sizeof (header));
+    memcpy (header.magic, CHECKPOINT_MAGIC, sizeof (header.magic));
+    header.version = CHECKPOINT_VERSION;
+    header.num_cores = num_cores;
+    header.num_io_pairs = num_io_pairs;
+    header.num_particles = context->num_particles;
+    header.generation = context->generation;
+    memcpy (header.rng_state, context->rng_state, sizeof (header.rng_state));
+    header.alpha = context->alpha;
+    header.beta = context->beta;
+    header.success_rate = context->success_rate;
+
+    snprintf (temp_file_name, sizeof (temp_file_name), "%s.tmp", file_name);
+    fptr = fopen (temp_file_name, "wb");
+    if (fptr == NULL)
+        return -1;
+
+    // | header | per particle: mapping, testtime, fitness, dominated, lbest mapping, lbest fitness | gbest mapping, gbest fitness |
+    // (dominated is kept so that a resumed particle whose testtime is only a lower bound stays marked as such)
+    // Only the mapping elements in use are stored (see write_genome)
+    ok &= fwrite (&header, sizeof (header), 1, fptr) == 1;
+    for (int p = 0; p < context->num_particles; p++) {
+        ok &= write_genome (fptr, &pso_particle[p].mapping, num_test_cores);
+        ok &= fwrite (&pso_particle[p].testtime, sizeof (double), 1, fptr) == 1;
+        ok &= fwrite (&pso_particle[p].fitness, sizeof (double), 1, fptr) == 1;
+        ok &= fwrite (&pso_particle[p].dominated, sizeof (int), 1, fptr) == 1;
+        ok &= write_genome (fptr, &pso_particle[p].lbest_mapping, num_test_cores);
+        ok &= fwrite (&pso_particle[p].lbest_fitness, sizeof (double), 1, fptr) == 1;
+    }
+    ok &= write_genome (fptr, &gbest_pso_particle->gbest_mapping, num_test_cores);
+    ok &= fwrite (&gbest_pso_particle->gbest_fitness, sizeof (double), 1, fptr) == 1;
 
-        printf("\n Particle fitness: %.2lf", pso_particle[p].fitness);
-        printf("\n\n"); 
+    ok &= fclose (fptr) == 0;
+    if (!ok || rename (temp_file_name, file_name) != 0) {
+        remove (temp_file_name);
+        return -1;
     }
+    return 0;
 }
 
-// Prints the mapping and test schedule information for the global best PSO particle
+// Restores the optimiser state from a checkpoint written by save_pso_checkpoint (-1 if the file is missing or does not match the design)
 
-void print_global_best_info (Gbest_PSO_particle *gbest_pso_particle, int num_test_cores) {
-    int i = 0;
-    printf(" Global best info\n");
+int load_pso_checkpoint (const char *file_name, PSO_particle *pso_particle, Gbest_PSO_particle *gbest_pso_particle, int num_cores, int num_io_pairs, PSO_context *context) {
 
-    printf(" Test core IDs: ");
-    for (i = 0; i < num_test_cores; i++)
-        printf(" %d\t", (int)gbest_pso_particle->gbest_mapping[i]);
+    int num_test_cores = num_cores - (2 * num_io_pairs);       // Number of test cores in the NoC mesh network
+    Checkpoint_header header;                                  // Checkpoint file header
+    FILE *fptr;
+    int ok = 1;
+
+    fptr = fopen (file_name, "rb");
+    if (fptr == NULL)
+        return -1;
+
+    if (fread (&header, sizeof (header), 1, fptr) != 1 || memcmp (header.magic, CHECKPOINT_MAGIC, sizeof (header.magic)) != 0 ||
+        header.version != CHECKPOINT_VERSION || header.num_cores != num_cores || header.num_io_pairs != num_io_pairs ||
+        header.num_particles != context->num_particles) {
+        fclose (fptr);
+        return -1;
+    }
+
+    for (int p = 0; p < context->num_particles; p++) {
+        ok &= read_genome (fptr, &pso_particle[p].mapping, num_test_cores);
+        ok &= fread (&pso_particle[p].testtime, sizeof (double), 1, fptr) == 1;
+        ok &= fread (&pso_particle[p].fitness, sizeof (double), 1, fptr) == 1;
+        ok &= fread (&pso_particle[p].dominated, sizeof (int), 1, fptr) == 1;
+        ok &= read_genome (fptr, &pso_particle[p].lbest_mapping, num_test_cores);
+        ok &= fread (&pso_particle[p].lbest_fitness, sizeof (double), 1, fptr) == 1;
+    }
+    ok &= read_genome (fptr, &gbest_pso_particle->gbest_mapping, num_test_cores);
+    ok &= fread (&gbest_pso_particle->gbest_fitness, sizeof (double), 1, fptr) == 1;
+    fclose (fptr);
+
+    if (!ok)
+        return -1;
+
+    context->generation = header.generation;
+    memcpy (context->rng_state, header.rng_state, sizeof (header.rng_state));
+    context->alpha = header.alpha;
+    context->beta = header.beta;
+    context->success_rate = header.success_rate;
+    return 0;
+}
 
-    printf("\n Corresponding IO pair IDs: ");
-    for (i = num_test_cores; i < (2 * num_test_cores); i++)
-        printf(" %d\t", (int)gbest_pso_particle->gbest_mapping[i]);
 
-    printf("\n Test frequencies (normalized): ");
-    for (i = (2 * num_test_cores); i < (3 * num_test_cores); i++)
-        printf(" %.2lf\t", gbest_pso_particle->gbest_mapping[i]);
+// ============
+// LOWER BOUNDS
+// ============
 
-    printf("\n Preemption points: ");
-    for (i = (3 * num_test_cores); i < (4 * num_test_cores); i++)
-        printf(" %.2lf\t", gbest_pso_particle->gbest_mapping[i]);
+// Counts how often both legs of a test of test_core through io_pair cross each mesh cut in each direction, along the XY route
+// crossings[2 * cut + (0: +x/+y, 1: -x/-y)] -- vertical cuts (b/w columns) first, then horizontal cuts (b/w rows)
 
-    printf("\n Particle fitness: %.2lf", gbest_pso_particle->gbest_fitness);
-    printf("\n\n");
+static void count_cut_crossings (NoC_node *noc_nodes, int N_columns, int num_cuts, IO_pairs *io_pair, int test_core, int *crossings) {
+    Route_hop hops[MAX_ROUTE_HOPS];                            // Route of one leg of the test
+    int num_hops = 0;
+    int cut = 0;
+    int dir = 0;
+    int x = 0;
+    int y = 0;
+
+    for (int i = 0; i < 2 * num_cuts; i++)
+        crossings[i] = 0;
+    for (int leg = 0; leg < 2; leg++) {
+        if (leg == 0)
+            num_hops = find_xy_route (noc_nodes, N_columns, io_pair->input_core_no, test_core, hops);
+        else
+            num_hops = find_xy_route (noc_nodes, N_columns, test_core, io_pair->output_core_no, hops);
+
+        for (int h = 0; h < num_hops; h++) {
+            x = noc_nodes[hops[h].router - 1].x_cord;
+            y = noc_nodes[hops[h].router - 1].y_cord;
+            switch (hops[h].out_port) {
+                case EAST:  cut = x;                          dir = 0; break;
+                case WEST:  cut = x - 1;                      dir = 1; break;
+                case NORTH: cut = (N_columns - 1) + y;        dir = 0; break;
+                default:    cut = (N_columns - 1) + y - 1;    dir = 1; break;
+            }
+            crossings[2 * cut + dir]++;
+        }
+    }
 }
 
-// Print IO schedule lists
+// Computes analytical lower bounds on the total testtime of any mapping of the design
+// - io workload: every io pair tests one core at a time, so the cheapest testtimes have to be shared among num_io_pairs
+// - longest test: no schedule is shorter than its cheapest longest test
+// - link cut: every test whose route crosses a mesh cut occupies one of the links across that cut for its testtime
+//   (all minimal mesh routes cross the same cuts as the XY route; on a torus the wraparound links bypass every cut, so the bound is 0)
+// Testtimes are taken at their cheapest (highest frequency): all patterns of a test have to be applied, in one or more segments on any
+// io pairs, so a test costs at least its patterns at the cheapest io pair plus the cheapest tail of a single segment
+
+void compute_lower_bounds (NoC_node *noc_nodes, int N_columns, int num_cores, IO_pairs *io_pairs, int num_io_pairs, double *freq, int num_freq, PSO_context *context) {
+
+    int M_rows = num_cores / N_columns;                        // Number of rows in NoC mesh network
+    int num_cuts = (N_columns - 1) + (M_rows - 1);             // Vertical cuts (b/w columns) followed by horizontal cuts (b/w rows)
+    double *cut_load = (double *) calloc (2 * num_cuts + 2, sizeof (double));   // [2 * cut + (0: +x/+y, 1: -x/-y)]: minimum load on the links across a cut
+    double *min_cut_load = (double *) malloc ((2 * num_cuts + 2) * sizeof (double));
+    int *crossings = (int *) malloc ((2 * num_cuts + 2) * sizeof (int));
+    double max_freq = freq[0];                                 // Highest valid test frequency
+    double pattern_time = 0.0;                                 // Time to apply all patterns of a core through one io pair (without the tail)
+    double tail_time = 0.0;                                    // Tail of one segment through one io pair
+    double min_pattern_time = 0.0;                             // Cheapest pattern time of a core
+    double min_tail_time = 0.0;                                // Cheapest segment tail of a core
+    double min_testtime = 0.0;                                 // Cheapest testtime of a core
+    double total_workload = 0.0;                               // Sum of the cheapest testtimes of all cores
+    Lower_bounds *bounds = &context->lower_bounds;
+
+    for (int f = 1; f < num_freq; f++)
+        max_freq = max(max_freq, freq[f]);
+
+    bounds->longest_test = 0.0;
+    bounds->link_cut = 0.0;
+
+    for (int c = 1; c <= num_cores; c++) {
+        if (noc_nodes[c - 1].core_type != TEST_CORE)
+            continue;
+
+        min_pattern_time = -1.0;
+        min_tail_time = -1.0;
+        for (int i = 0; i < 2 * num_cuts; i++)
+            min_cut_load[i] = -1.0;
+
+        for (int k = 1; k <= num_io_pairs; k++) {
+
+            // A segment without patterns only takes the tail
+            if (context->testtime_table != NULL) {
+                tail_time = lookup_segment_testtime (context->testtime_table, c, k, max_freq, 0);
+                pattern_time = lookup_segment_testtime (context->testtime_table, c, k, max_freq, noc_nodes[c - 1].test_patterns) - tail_time;
+            }
+            else {
+                tail_time = find_segment_testtime (noc_nodes, io_pairs[k - 1].input_core_no, io_pairs[k - 1].output_core_no, c, max_freq, 0);
+                pattern_time = find_segment_testtime (noc_nodes, io_pairs[k - 1].input_core_no, io_pairs[k - 1].output_core_no, c, max_freq, noc_nodes[c - 1].test_patterns) - tail_time;
+            }
+            if (min_pattern_time < 0 || pattern_time < min_pattern_time)
+                min_pattern_time = pattern_time;
+            if (min_tail_time < 0 || tail_time < min_tail_time)
+                min_tail_time = tail_time;
+
+            count_cut_crossings (noc_nodes, N_columns, num_cuts, &io_pairs[k - 1], c, crossings);
+            for (int i = 0; i < 2 * num_cuts; i++)
+                if (min_cut_load[i] < 0 || pattern_time * crossings[i] < min_cut_load[i])
+                    min_cut_load[i] = pattern_time * crossings[i];
+        }
 
-void print_IO_schedule_lists (IO_head* head) {
+        min_testtime = min_pattern_time + min_tail_time;
 
-    IO_node *temp;
-    temp = head->head_node;
+        total_workload += min_testtime;
+        bounds->longest_test = max(bounds->longest_test, min_testtime);
+        for (int i = 0; i < 2 * num_cuts; i++)
+            cut_load[i] += min_cut_load[i];
+    }
+
+    // A vertical cut is crossed by M_rows links per direction, a horizontal cut by N_columns
+    for (int i = 0; i < 2 * num_cuts && context->routing != ROUTING_TORUS; i++)
+        bounds->link_cut = max(bounds->link_cut, cut_load[i] / ((i / 2 < N_columns - 1) ? M_rows : N_columns));
+
+    bounds->io_workload = total_workload / num_io_pairs;
+    bounds->best = max(bounds->io_workload, max(bounds->longest_test, bounds->link_cut));
+
+    free (cut_load);
+    free (min_cut_load);
+    free (crossings);
+}
+
+// Relative gap b/w a total testtime and the best lower bound
+
+double find_optimality_gap (Lower_bounds *bounds, double testtime) {
+    if (bounds->best <= 0)
+        return 0.0;
+    return (testtime - bounds->best) / bounds->best;
+}
+
+
+// ============
+// LOCAL SEARCH
+// ============
+
+// Swaps the test cores (with their io pairs, frequencies and preemption points) at positions i and j of a mapping
+
+static void swap_mapping_positions (Genome *mapping, int i, int j) {
+    short test_core = mapping->test_core[i];
+    unsigned char io_pair = mapping->io_pair[i];
+    unsigned char freq_index = mapping->freq_index[i];
+    float preemption = mapping->preemption[i];
+
+    mapping->test_core[i] = mapping->test_core[j];
+    mapping->io_pair[i] = mapping->io_pair[j];
+    mapping->freq_index[i] = mapping->freq_index[j];
+    mapping->preemption[i] = mapping->preemption[j];
+    mapping->test_core[j] = test_core;
+    mapping->io_pair[j] = io_pair;
+    mapping->freq_index[j] = freq_index;
+    mapping->preemption[j] = preemption;
+}
+
+// Moves the test core (with its io pair, frequency and preemption point) at position from to position to, shifting the cores in between
+
+static void move_mapping_position (Genome *mapping, int from, int to) {
+    int step = (from < to) ? 1 : -1;
+
+    for (int i = from; i != to; i += step)
+        swap_mapping_positions (mapping, i, i + step);
+}
+
+// Scores a move that changed the mapping from position onwards, keeps it if the total testtime improves
+// A rejected move has to be undone by the caller; only the state before position stays valid
+
+static int try_local_move (Eval_state *state, Genome *mapping, int position, double *best_testtime) {
+    double testtime = evaluate_from (state, mapping, position, *best_testtime);
+
+    if (testtime < *best_testtime - 1e-9) {
+        *best_testtime = testtime;
+        return 1;
+    }
+    state->num_valid = position;
+    return 0;
+}
+
+// Memetic refinement of the global best: local search scored by delta evaluation instead of full find_resource_busytimes passes
+// Moves: adjacent swaps and insertions in the test core sequence, io pair reassignment of the critical cores, preemption point nudges
+// Sequence moves are tried back to front, so most delta evaluations only reschedule a short suffix
+
+void refine_global_best (Gbest_PSO_particle *gbest_pso_particle, NoC_node *noc_nodes, int N_columns, int num_cores, IO_pairs *io_pairs, int num_io_pairs, PSO_context *context) {
+
+    int num_test_cores = num_cores - (2 * num_io_pairs);       // Number of test cores in the NoC mesh network
+    Genome mapping;                                            // Mapping being refined
+    Eval_state *state;                                         // Journaling evaluation state of the mapping
+    double best_testtime = 0.0;                                // Total testtime of the mapping
+    int critical_io_pair = 0;                                  // IO pair that finishes last
+    int improved = 1;                                          // Set if the last pass found a better mapping
+    int pass = 0;                                              // Number of local search passes done
+    unsigned char old_io_pair = 0;
+    float old_preemption = 0.0f;
+    long start_evaluations = context->num_delta_evaluations;
+
+    init_genome (&mapping, num_test_cores);
+    copy_genome (&mapping, &gbest_pso_particle->gbest_mapping);
+    state = create_eval_state (noc_nodes, N_columns, num_cores, io_pairs, num_io_pairs, context, 1);
+    best_testtime = evaluate_from (state, &mapping, 0, NO_CUTOFF);
+
+    while (improved && pass < LOCAL_SEARCH_MAX_PASSES) {
+        improved = 0;
+        pass++;
+
+        // Adjacent swaps
+        for (int i = num_test_cores - 2; i >= 0; i--) {
+            swap_mapping_positions (&mapping, i, i + 1);
+            if (try_local_move (state, &mapping, i, &best_testtime))
+                improved = 1;
+            else
+                swap_mapping_positions (&mapping, i, i + 1);
+        }
+
+        // Insertions -- move a core up to LOCAL_SEARCH_WINDOW positions earlier (one position is the adjacent swap)
+        for (int i = num_test_cores - 1; i >= 2; i--) {
+            for (int j = i - 2; j >= 0 && j >= i - LOCAL_SEARCH_WINDOW; j--) {
+                move_mapping_position (&mapping, i, j);
+                if (try_local_move (state, &mapping, j, &best_testtime))
+                    improved = 1;
+                else
+                    move_mapping_position (&mapping, j, i);
+            }
+        }
+
+        // IO pair reassignment of the cores tested through the io pair that finishes last (found anew for every pass)
+        evaluate_from (state, &mapping, num_test_cores, NO_CUTOFF);
+        critical_io_pair = 0;
+        for (int k = 1; k < num_io_pairs; k++)
+            if (state->io_busytime[k] > state->io_busytime[critical_io_pair])
+                critical_io_pair = k;
+
+        for (int i = num_test_cores - 1; i >= 0; i--) {
+            if (mapping.io_pair[i] != critical_io_pair + 1)
+                continue;
+            old_io_pair = mapping.io_pair[i];
+            for (int k = 1; k <= num_io_pairs; k++) {
+                if (k == old_io_pair)
+                    continue;
+                mapping.io_pair[i] = k;
+                if (try_local_move (state, &mapping, i, &best_testtime)) {
+                    improved = 1;
+                    break;
+                }
+                mapping.io_pair[i] = old_io_pair;
+            }
+        }
+
+        // Preemption point nudges
+        for (int i = num_test_cores - 1; i >= 0; i--) {
+            old_preemption = mapping.preemption[i];
+            for (int d = -1; d <= 1; d += 2) {
+                mapping.preemption[i] = old_preemption + d * PREEMPTION_NUDGE;
+                if (mapping.preemption[i] < PREEMPTION_MIN || mapping.preemption[i] > PREEMPTION_MAX)
+                    mapping.preemption[i] = old_preemption;
+                else if (try_local_move (state, &mapping, i, &best_testtime)) {
+                    improved = 1;
+                    break;
+                }
+                else
+                    mapping.preemption[i] = old_preemption;
+            }
+        }
+    }
+
+    if (context->out_file != NULL)
+        fprintf(context->out_file, " Local search: %.2lf --> %.2lf (%ld delta evaluations)\n\n", gbest_pso_particle->gbest_fitness, best_testtime, context->num_delta_evaluations - start_evaluations);
+
+    if (best_testtime < gbest_pso_particle->gbest_fitness) {
+        copy_genome (&gbest_pso_particle->gbest_mapping, &mapping);
+        gbest_pso_particle->gbest_fitness = best_testtime;
+    }
+
+    free_eval_state (state);
+    free_genome (&mapping);
+}
+
+
+// ==========
+// WARM START
+// ==========
+
+// Repairs the mapping of a binary schedule of an earlier version of the design to fit the design, returns the number of tests taken over
+// (-1 if the file could not be read or belongs to another mesh); *num_old_tests is set to the tests of the earlier schedule, *num_moved to those given a new io pair
+// Tests of cores that are still test cores keep their order, preemption point, frequency (the nearest valid one) and io pair (matched by
+// its input and output core). Tests whose io pair is gone, and the tests of new test cores (appended in core order, unpreempted at the
+// first valid frequency), go to the io pair that would finish them first given the tests assigned so far
+
+int repair_warm_start (const char *file_name, NoC_node *noc_nodes, int num_cores, int N_columns, IO_pairs *io_pairs, int num_io_pairs, double *freq, int num_freq,
+                       Genome *mapping, int *num_old_tests, int *num_moved) {
+
+    Schedule_view view;                                        // Earlier schedule
+    Schedule_file_mapping *test = NULL;                        // Test of the earlier schedule
+    int *new_io_pair;                                          // [old io pair - 1]: matching io pair of the design (0 --> gone)
+    char *used;                                                // [core]: set once the core is in the mapping
+    double *io_load;                                           // Testtime assigned to every io pair so far
+    double testtime = 0.0;
+    double finish = 0.0;
+    double best_finish = 0.0;
+    int num_tests = 0;
+    int num_kept = 0;
+    int core = 0;
+    int io_pair = 0;
+    int freq_index = 0;
+
+    if (map_schedule_file (file_name, &view) != 0)
+        return -1;
+    // Core numbers only carry over within the same mesh
+    if (view.header->num_cores != num_cores || view.header->N_columns != N_columns) {
+        free_schedule_view (&view);
+        return -1;
+    }
+    new_io_pair = (int *) malloc ((view.header->num_io_pairs + 1) * sizeof (int));
+    used = (char *) calloc (num_cores + 1, sizeof (char));
+    io_load = (double *) calloc (num_io_pairs, sizeof (double));
+
+    for (int j = 0; j < view.header->num_io_pairs; j++) {
+        new_io_pair[j] = 0;
+        for (int k = 0; k < num_io_pairs; k++)
+            if (io_pairs[k].input_core_no == view.io_pairs[j].input_core && io_pairs[k].output_core_no == view.io_pairs[j].output_core)
+                new_io_pair[j] = k + 1;
+    }
+    *num_old_tests = view.header->num_test_cores;
+    *num_moved = 0;
+
+    // Tests of the earlier schedule, then the new test cores
+    for (int t = 0; t < view.header->num_test_cores + num_cores; t++) {
+        if (t < view.header->num_test_cores) {
+            test = &view.mapping[t];
+            core = test->test_core;
+            io_pair = (test->io_pair >= 1 && test->io_pair <= view.header->num_io_pairs) ? new_io_pair[test->io_pair - 1] : 0;
+            freq_index = 0;
+            for (int f = 1; f < num_freq; f++)
+                if (fabs (freq[f] - test->frequency) < fabs (freq[freq_index] - test->frequency))
+                    freq_index = f;
+        }
+        else {
+            core = t - view.header->num_test_cores + 1;
+            io_pair = 0;
+            freq_index = 0;
+        }
+        if (core < 1 || core > num_cores || noc_nodes[core - 1].core_type != TEST_CORE || used[core])
+            continue;
+        used[core] = 1;
+
+        // Earliest finish among the io pairs for tests without one
+        if (io_pair == 0) {
+            for (int k = 1; k <= num_io_pairs; k++) {
+                finish = io_load[k - 1] + find_segment_testtime (noc_nodes, io_pairs[k - 1].input_core_no, io_pairs[k - 1].output_core_no, core,
+                                                                 freq[freq_index], noc_nodes[core - 1].test_patterns);
+                if (io_pair == 0 || finish < best_finish) {
+                    io_pair = k;
+                    best_finish = finish;
+                }
+            }
+            if (t < view.header->num_test_cores)
+                (*num_moved)++;
+        }
+        testtime = find_segment_testtime (noc_nodes, io_pairs[io_pair - 1].input_core_no, io_pairs[io_pair - 1].output_core_no, core,
+                                          freq[freq_index], noc_nodes[core - 1].test_patterns);
+        io_load[io_pair - 1] += testtime;
+
+        mapping->test_core[num_tests] = (short) core;
+        mapping->io_pair[num_tests] = (unsigned char) io_pair;
+        mapping->freq_index[num_tests] = (unsigned char) freq_index;
+        if (t < view.header->num_test_cores)
+            mapping->preemption[num_tests] = (float) ((test->preemption < PREEMPTION_MIN) ? PREEMPTION_MIN : ((test->preemption > PREEMPTION_MAX) ? PREEMPTION_MAX : test->preemption));
+        else
+            mapping->preemption[num_tests] = PREEMPTION_MAX;
+        if (t < view.header->num_test_cores)
+            num_kept++;
+        num_tests++;
+    }
+
+    free (new_io_pair);
+    free (used);
+    free (io_load);
+    free_schedule_view (&view);
+    return num_kept;
+}
+
+// Seeds the swarm with the repaired mapping of context->warm_start_file and its neighbours and refines the global best,
+// returns -1 (swarm untouched) if the file could not be read or belongs to another mesh
+// Particle 0 starts from the repaired mapping, particle p from the repaired mapping after p random moves (swaps of two tests,
+// io pair changes, preemption point nudges)
+
+int warm_start_pso_particles (Search_problem *problem, PSO_particle *pso_particle, Gbest_PSO_particle *gbest_pso_particle) {
+
+    PSO_context *context = problem->context;
+    int num_test_cores = problem->num_test_cores;
+    Genome repaired;                                           // Earlier mapping repaired to fit the design
+    int num_kept = 0;                                          // Tests taken over from the earlier schedule
+    int num_old_tests = 0;                                     // Tests of the earlier schedule
+    int num_moved = 0;                                         // Tests given a new io pair
+    int i = 0;
+    int j = 0;
+
+    init_genome (&repaired, num_test_cores);
+    num_kept = repair_warm_start (context->warm_start_file, problem->noc_nodes, problem->num_cores, problem->N_columns, problem->io_pairs, problem->num_io_pairs,
+                                  problem->freq, problem->num_freq, &repaired, &num_old_tests, &num_moved);
+    if (num_kept < 0) {
+        free_genome (&repaired);
+        if (context->out_file != NULL)
+            fprintf(context->out_file, " Warm start: could not read %s or it belongs to another mesh, starting from random mappings\n\n", context->warm_start_file);
+        return -1;
+    }
+    if (context->out_file != NULL)
+        fprintf(context->out_file, " Warm start from %s: %d of %d tests kept, %d new, %d moved to other io pairs\n", context->warm_start_file,
+                num_kept, num_old_tests, num_test_cores - num_kept, num_moved);
+
+    for (int p = 0; p < context->num_particles; p++) {
+        copy_genome (&pso_particle[p].mapping, &repaired);
+        for (int m = 0; m < p; m++) {
+            i = nrand48 (context->rng_state) % num_test_cores;
+            switch (nrand48 (context->rng_state) % 3) {
+                case 0:
+                    j = nrand48 (context->rng_state) % num_test_cores;
+                    swap_mapping_positions (&pso_particle[p].mapping, i, j);
+                    break;
+                case 1:
+                    pso_particle[p].mapping.io_pair[i] = (unsigned char) (nrand48 (context->rng_state) % problem->num_io_pairs + 1);
+                    break;
+                default:
+                    pso_particle[p].mapping.preemption[i] += (nrand48 (context->rng_state) % 2) ? PREEMPTION_NUDGE : -PREEMPTION_NUDGE;
+                    if (pso_particle[p].mapping.preemption[i] < PREEMPTION_MIN)
+                        pso_particle[p].mapping.preemption[i] = PREEMPTION_MIN;
+                    else if (pso_particle[p].mapping.preemption[i] > PREEMPTION_MAX)
+                        pso_particle[p].mapping.preemption[i] = PREEMPTION_MAX;
+                    break;
+            }
+        }
+
+        find_resource_busytimes (&pso_particle[p], problem->noc_nodes, problem->N_columns, problem->num_cores, problem->io_pairs, problem->num_io_pairs, context, NO_CUTOFF);
+        copy_genome (&pso_particle[p].lbest_mapping, &pso_particle[p].mapping);
+        pso_particle[p].lbest_fitness = pso_particle[p].fitness;
+        if (p == 0 || pso_particle[p].fitness < gbest_pso_particle->gbest_fitness) {
+            copy_genome (&gbest_pso_particle->gbest_mapping, &pso_particle[p].mapping);
+            gbest_pso_particle->gbest_fitness = pso_particle[p].fitness;
+        }
+    }
+    free_genome (&repaired);
+    if (context->out_file != NULL)
+        fprintf(context->out_file, " Warm start testtime: %lf (best of the repaired mapping and %d neighbours)\n", gbest_pso_particle->gbest_fitness,
+                context->num_particles - 1);
+
+    // The repaired mapping is usually close to a local optimum of the changed design -- local search gets it there before the swarm moves
+    refine_global_best (gbest_pso_particle, problem->noc_nodes, problem->N_columns, problem->num_cores, problem->io_pairs, problem->num_io_pairs, context);
+    return 0;
+}
+
+// ==============
+// SEARCH ENGINES
+// ==============
+
+// Every engine searches the same mapping space (Genome) and scores mappings with evaluate_from on an evaluator of the problem,
+// so all of them share the route table, testtime table and lower bounds set up by run_search_engine
+
+static const char *search_engine_names[NUM_ENGINES] = { "pso", "sa", "ga", "tabu", "bnb" };
+
+// Creates an evaluator for the mappings of a search problem -- evaluate_from on it scores a mapping
+// With journaling, a mapping that differs from the last scored one from some position onwards is rescored from that position
+
+Eval_state *create_problem_evaluator (Search_problem *problem, int journaling) {
+    return create_eval_state (problem->noc_nodes, problem->N_columns, problem->num_cores, problem->io_pairs, problem->num_io_pairs, problem->context, journaling);
+}
+
+// Stores the test core numbers of a problem in test_cores, in core number order
+
+static void find_test_cores (Search_problem *problem, int *test_cores) {
+    int n = 0;
+
+    for (int i = 0; i < problem->num_cores; i++)
+        if (problem->noc_nodes[i].core_type == TEST_CORE)
+            test_cores[n++] = problem->noc_nodes[i].core_no;
+}
+
+// Seeds the swarm: the first particles (one per SEED_FRACTION of the swarm, at most NUM_SEED_HEURISTICS) start from constructive
+// schedules, best first, the others from Latin hypercube draws; sets the local and global bests
+// Both constructions take the tests longest first (testtime on their fastest io pair), unpreempted at the fastest frequency:
+//  - balanced: each test goes to the io pair with the least workload after it (the testtime includes the route to and from the pair)
+//  - list schedule: each test goes to the io pair on which its circuit ends first, scheduled on the resource model (routes, links, ports)
+// The remaining particles keep random test orders and frequencies; per position, their io pairs and preemption points are spread
+// over the particles by Latin hypercube sampling (every io pair and every stratum of [PREEMPTION_MIN, PREEMPTION_MAX) once per round)
+
+void seed_pso_particles (Search_problem *problem, PSO_particle *pso_particle, Gbest_PSO_particle *gbest_pso_particle) {
+
+    PSO_context *context = problem->context;
+    int num_test_cores = problem->num_test_cores;
+    int num_io_pairs = problem->num_io_pairs;
+    Eval_state *state = create_problem_evaluator (problem, 1); // Journaling evaluator the list schedule is built on
+    Genome seeds[NUM_SEED_HEURISTICS];                         // Constructed mappings
+    double seed_testtime[NUM_SEED_HEURISTICS];                 // Total testtime of each constructed mapping
+    int seed_order[NUM_SEED_HEURISTICS];                       // Constructed mappings, best first
+    int *test_cores = (int *) malloc (num_test_cores * sizeof (int));
+    int *order = (int *) malloc (num_test_cores * sizeof (int));                            // Test cores, longest test first
+    double *testtimes = (double *) malloc (num_test_cores * num_io_pairs * sizeof (double)); // [position of the core in test_cores, io pair]: unpreempted testtime
+    double *min_testtimes = (double *) malloc (num_test_cores * sizeof (double));           // Testtime of each test core on its fastest io pair
+    double *io_load = (double *) malloc (num_io_pairs * sizeof (double));                   // Workload assigned to each io pair so far
+    int *strata;                                               // Latin hypercube strata, one per randomly started particle
+    int num_seeded = context->num_particles / SEED_FRACTION;   // Particles started from constructed mappings
+    int num_sampled = 0;                                       // Particles started from Latin hypercube draws
+    Genome probe;                                              // Single test used to look up the testtimes
+    int freq_index = 0;                                        // Fastest valid test frequency
+    int index = 0;
+    int best_io_pair = 0;
+    double best_finish = 0.0;
+    double finish = 0.0;
+    int j = 0;
+    int t = 0;
+
+    if (num_seeded < 1)
+        num_seeded = 1;
+    if (num_seeded > NUM_SEED_HEURISTICS)
+        num_seeded = NUM_SEED_HEURISTICS;
+    num_sampled = context->num_particles - num_seeded;
+    strata = (int *) malloc ((num_sampled + 1) * sizeof (int));
+    init_genome (&probe, num_test_cores);
+    for (t = 0; t < NUM_SEED_HEURISTICS; t++)
+        init_genome (&seeds[t], num_test_cores);
+
+    for (int f = 1; f < problem->num_freq; f++)
+        if (problem->freq[f] > problem->freq[freq_index])
+            freq_index = f;
+    for (int p = 0; p < num_test_cores; p++) {
+        probe.freq_index[p] = freq_index;
+        probe.preemption[p] = PREEMPTION_MAX;
+    }
+
+    // Testtimes of every unpreempted test through every io pair, and the longest-first order
+    find_test_cores (problem, test_cores);
+    for (int i = 0; i < num_test_cores; i++) {
+        probe.test_core[0] = test_cores[i];
+        min_testtimes[i] = NO_CUTOFF;
+        for (int k = 1; k <= num_io_pairs; k++) {
+            testtimes[i * num_io_pairs + (k - 1)] = find_position_segment_testtime (state, &probe, 0, k, find_position_segment_patterns (state, &probe, 0, 0));
+            if (testtimes[i * num_io_pairs + (k - 1)] < min_testtimes[i])
+                min_testtimes[i] = testtimes[i * num_io_pairs + (k - 1)];
+        }
+        for (j = i; j > 0 && min_testtimes[order[j - 1]] < min_testtimes[i]; j--)
+            order[j] = order[j - 1];
+        order[j] = i;
+    }
+
+    for (t = 0; t < NUM_SEED_HEURISTICS; t++) {
+        copy_genome (&seeds[t], &probe);
+        rollback_eval_state (state, 0);
+        for (int k = 0; k < num_io_pairs; k++)
+            io_load[k] = 0.0;
+
+        for (int p = 0; p < num_test_cores; p++) {
+            index = order[p];
+            seeds[t].test_core[p] = test_cores[index];
+            best_io_pair = 0;
+            best_finish = NO_CUTOFF;
+            for (int k = 1; k <= num_io_pairs; k++) {
+                if (t == 0)
+                    finish = io_load[k - 1] + testtimes[index * num_io_pairs + (k - 1)];
+                else {
+                    seeds[t].io_pair[p] = k;
+                    schedule_test_core (state, &seeds[t], p);
+                    finish = state->endtime[p];
+                    rollback_eval_state (state, p);
+                }
+                if (finish < best_finish) {
+                    best_finish = finish;
+                    best_io_pair = k;
+                }
+            }
+            seeds[t].io_pair[p] = best_io_pair;
+            io_load[best_io_pair - 1] += testtimes[index * num_io_pairs + (best_io_pair - 1)];
+            if (t > 0)
+                schedule_test_core (state, &seeds[t], p);
+        }
+
+        seed_testtime[t] = evaluate_from (state, &seeds[t], 0, NO_CUTOFF);
+        for (j = t; j > 0 && seed_testtime[seed_order[j - 1]] > seed_testtime[t]; j--)
+            seed_order[j] = seed_order[j - 1];
+        seed_order[j] = t;
+    }
+    free_eval_state (state);
+
+    for (int p = 0; p < num_seeded; p++)
+        copy_genome (&pso_particle[p].mapping, &seeds[seed_order[p]]);
+    for (t = 0; t < NUM_SEED_HEURISTICS; t++)
+        free_genome (&seeds[t]);
+    free_genome (&probe);
+
+    for (int p = num_seeded; p < context->num_particles; p++)
+        init_random_genome (&pso_particle[p].mapping, test_cores, num_test_cores, num_io_pairs, problem->num_freq, context->rng_state);
+
+    // Latin hypercube: a random permutation of the strata per position, for the io pairs and for the preemption points
+    for (int pos = 0; pos < num_test_cores && num_sampled > 0; pos++) {
+        for (int dim = 0; dim < 2; dim++) {
+            for (int q = 0; q < num_sampled; q++) {
+                j = nrand48 (context->rng_state) % (q + 1);
+                strata[q] = strata[j];
+                strata[j] = q;
+            }
+            for (int q = 0; q < num_sampled; q++) {
+                if (dim == 0)
+                    pso_particle[num_seeded + q].mapping.io_pair[pos] = strata[q] % num_io_pairs + 1;
+                else
+                    pso_particle[num_seeded + q].mapping.preemption[pos] = PREEMPTION_MIN + (strata[q] + erand48 (context->rng_state)) / num_sampled * (PREEMPTION_MAX - PREEMPTION_MIN);
+            }
+        }
+    }
+
+    if (context->out_file != NULL)
+        fprintf(context->out_file, " Swarm seeding: balanced %lf, list schedule %lf, %d seeded and %d Latin hypercube particles\n",
+                seed_testtime[0], seed_testtime[1], num_seeded, num_sampled);
+    free (strata);
+    free (test_cores);
+    free (order);
+    free (testtimes);
+    free (min_testtimes);
+    free (io_load);
+
+    for (int p = 0; p < context->num_particles; p++) {
+        find_resource_busytimes (&pso_particle[p], problem->noc_nodes, problem->N_columns, problem->num_cores, problem->io_pairs, num_io_pairs, context, NO_CUTOFF);
+        copy_genome (&pso_particle[p].lbest_mapping, &pso_particle[p].mapping);
+        pso_particle[p].lbest_fitness = pso_particle[p].fitness;
+        if (p == 0 || pso_particle[p].fitness < gbest_pso_particle->gbest_fitness) {
+            copy_genome (&gbest_pso_particle->gbest_mapping, &pso_particle[p].mapping);
+            gbest_pso_particle->gbest_fitness = pso_particle[p].fitness;
+        }
+    }
+}
+
+// Fraction of the run's budget used up -- generations or wall-clock time, whichever runs out first
+
+static double find_search_progress (Search_problem *problem) {
+    PSO_context *context = problem->context;
+    double progress = (double) context->generation / context->max_generations;
+
+    if (problem->deadline > 0)
+        progress = max(progress, (get_wall_time () - problem->start_time) / (problem->deadline - problem->start_time));
+    return (progress < 1.0) ? progress : 1.0;
+}
+
+// Applies a random neighbourhood move to a mapping and returns the first position it changed, *moved_core is set to the test core moved
+// Moves: swap or insertion in the test core sequence (the tests keep their io pairs, frequencies and preemption points), another
+// io pair or frequency for one test, or a preemption point nudge; a move that cannot change the mapping falls back to the nudge
+
+static int apply_random_move (Search_problem *problem, Genome *mapping, int *moved_core) {
+    unsigned short *rng_state = problem->context->rng_state;
+    int num_test_cores = problem->num_test_cores;
+    int i = nrand48 (rng_state) % num_test_cores;               // Position moved
+    int j = nrand48 (rng_state) % num_test_cores;               // Position it is swapped with or moved to
+    int type = nrand48 (rng_state) % 5;                         // Kind of move
+    float preemption = 0.0f;
+
+    *moved_core = mapping->test_core[i];
+
+    if (type == 0 && i != j) {
+        swap_mapping_positions (mapping, i, j);
+        return (i < j) ? i : j;
+    }
+    if (type == 1 && i != j) {
+        move_mapping_position (mapping, i, j);
+        return (i < j) ? i : j;
+    }
+    if (type == 2 && problem->num_io_pairs > 1) {
+        mapping->io_pair[i] = (mapping->io_pair[i] + nrand48 (rng_state) % (problem->num_io_pairs - 1)) % problem->num_io_pairs + 1;
+        return i;
+    }
+    if (type == 3 && problem->num_freq > 1) {
+        mapping->freq_index[i] = (mapping->freq_index[i] + 1 + nrand48 (rng_state) % (problem->num_freq - 1)) % problem->num_freq;
+        return i;
+    }
+
+    // Nudge the preemption point, the other way if the step would leave [PREEMPTION_MIN, PREEMPTION_MAX]
+    preemption = mapping->preemption[i] + ((nrand48 (rng_state) % 2) ? PREEMPTION_NUDGE : -PREEMPTION_NUDGE);
+    if (preemption < PREEMPTION_MIN || preemption > PREEMPTION_MAX)
+        preemption = 2 * mapping->preemption[i] - preemption;
+    mapping->preemption[i] = preemption;
+    return i;
+}
+
+// Simulated annealing: ANNEALING_MOVES random neighbourhood moves per generation, geometric cooling over the run's budget
+// The Metropolis test is decided before the move is scored -- with u drawn first, a move is accepted iff its total testtime stays
+// below current - T ln(u), so that threshold is the evaluation's cutoff and most rejected moves are abandoned early
+
+double simulated_annealing (Search_problem *problem, Genome *best) {
+    PSO_context *context = problem->context;
+    Eval_state *state = create_problem_evaluator (problem, 1);  // Journaling evaluator of the current mapping
+    int *test_cores = (int *) malloc (problem->num_test_cores * sizeof (int));  // Test core numbers
+    Genome current;                                             // Current mapping
+    Genome candidate;                                           // Current mapping after a move
+    double current_testtime = 0.0;                              // Total testtime of the current mapping
+    double best_testtime = 0.0;                                 // Total testtime of the best mapping
+    double start_temperature = 0.0;                             // Temperature at the start of the run
+    double temperature = 0.0;                                   // Temperature of the current generation
+    double threshold = 0.0;                                     // Total testtime a move has to stay below to be accepted
+    double testtime = 0.0;
+    int position = 0;                                           // First position changed by a move
+    int moved_core = 0;
+
+    init_genome (&current, problem->num_test_cores);
+    init_genome (&candidate, problem->num_test_cores);
+    find_test_cores (problem, test_cores);
+    init_random_genome (&current, test_cores, problem->num_test_cores, problem->num_io_pairs, problem->num_freq, context->rng_state);
+    free (test_cores);
+    current_testtime = evaluate_from (state, &current, 0, NO_CUTOFF);
+    copy_genome (best, &current);
+    best_testtime = current_testtime;
+    start_temperature = ANNEALING_START_TEMPERATURE * current_testtime;
+    note_search_progress (problem, best_testtime);
+
+    for (context->generation = 0; context->generation < context->max_generations; context->generation++) {
+        if (check_search_stop (problem, best_testtime))
+            break;
+
+        temperature = start_temperature * pow (ANNEALING_END_TEMPERATURE / ANNEALING_START_TEMPERATURE, find_search_progress (problem));
+
+        for (int m = 0; m < ANNEALING_MOVES; m++) {
+            copy_genome (&candidate, &current);
+            position = apply_random_move (problem, &candidate, &moved_core);
+            threshold = current_testtime - temperature * log (1.0 - erand48 (context->rng_state));
+
+            testtime = evaluate_from (state, &candidate, position, threshold);
+            if (testtime >= threshold) {
+                state->num_valid = position;
+                continue;
+            }
+
+            copy_genome (&current, &candidate);
+            current_testtime = testtime;
+            if (current_testtime < best_testtime) {
+                copy_genome (best, &current);
+                best_testtime = current_testtime;
+                note_search_progress (problem, best_testtime);
+            }
+        }
+    }
+
+    print_search_stop (problem);
+    if (context->out_file != NULL)
+        fprintf(context->out_file, " Simulated annealing: best total testtime %lf after %d generations (final temperature %lf)\n\n", best_testtime, context->generation, temperature);
+
+    free_genome (&current);
+    free_genome (&candidate);
+    free_eval_state (state);
+    return best_testtime;
+}
+
+// Tournament selection of two: the better of two random mappings of the population
+
+static int select_parent (double *fitness, unsigned short *rng_state) {
+    int a = nrand48 (rng_state) % GA_POPULATION;
+    int b = nrand48 (rng_state) % GA_POPULATION;
+
+    return (fitness[b] < fitness[a]) ? b : a;
+}
+
+// Order crossover: the child takes positions cut1 .. cut2 from parent a and fills the other positions with the remaining test cores
+// in the order of parent b; every test keeps the io pair, frequency and preemption point of the parent it was taken from
+// taken has room for a flag per core number
+
+static void order_crossover (Search_problem *problem, Genome *a, Genome *b, Genome *child, char *taken) {
+    int num_test_cores = problem->num_test_cores;
+    int cut1 = nrand48 (problem->context->rng_state) % num_test_cores;
+    int cut2 = nrand48 (problem->context->rng_state) % num_test_cores;
+    int k = 0;                                                  // Position of parent b
+    int temp = 0;
+
+    if (cut1 > cut2) {
+        temp = cut1;
+        cut1 = cut2;
+        cut2 = temp;
+    }
+
+    memset (taken, 0, problem->num_cores + 1);
+    for (int i = cut1; i <= cut2; i++) {
+        child->test_core[i] = a->test_core[i];
+        child->io_pair[i] = a->io_pair[i];
+        child->freq_index[i] = a->freq_index[i];
+        child->preemption[i] = a->preemption[i];
+        taken[a->test_core[i]] = 1;
+    }
+
+    for (int i = 0; i < num_test_cores; i++) {
+        if (i == cut1) {
+            i = cut2;
+            continue;
+        }
+        while (taken[b->test_core[k]])
+            k++;
+        child->test_core[i] = b->test_core[k];
+        child->io_pair[i] = b->io_pair[k];
+        child->freq_index[i] = b->freq_index[k];
+        child->preemption[i] = b->preemption[k];
+        k++;
+    }
+}
+
+// Permutation genetic algorithm: GA_POPULATION mappings per generation, tournament selection, order crossover, mutation by a random
+// neighbourhood move, and the best mapping carried over unchanged (elitism)
+
+double genetic_algorithm (Search_problem *problem, Genome *best) {
+    PSO_context *context = problem->context;
+    Eval_state *state = create_problem_evaluator (problem, 0);  // Evaluator, reset for every child
+    int *test_cores = (int *) malloc (problem->num_test_cores * sizeof (int));  // Test core numbers
+    char *taken = (char *) malloc (problem->num_cores + 1);     // Set for the test cores a child took from its first parent
+    Genome *population;                                         // Mappings of the current generation
+    Genome *children;                                           // Mappings of the next generation
+    Genome *temp;
+    double fitness[GA_POPULATION];                              // Total testtimes of the current generation
+    double child_fitness[GA_POPULATION];                        // Total testtimes of the next generation
+    double best_testtime = NO_CUTOFF;                           // Total testtime of the best mapping
+    int parent_a = 0;
+    int parent_b = 0;
+    int moved_core = 0;
+
+    population = (Genome *) malloc (2 * GA_POPULATION * sizeof (Genome));
+    children = population + GA_POPULATION;
+    for (int c = 0; c < 2 * GA_POPULATION; c++)
+        init_genome (&population[c], problem->num_test_cores);
+
+    find_test_cores (problem, test_cores);
+    for (int c = 0; c < GA_POPULATION; c++) {
+        init_random_genome (&population[c], test_cores, problem->num_test_cores, problem->num_io_pairs, problem->num_freq, context->rng_state);
+        reset_eval_state (state);
+        fitness[c] = evaluate_from (state, &population[c], 0, NO_CUTOFF);
+        if (fitness[c] < best_testtime) {
+            copy_genome (best, &population[c]);
+            best_testtime = fitness[c];
+        }
+    }
+    free (test_cores);
+    note_search_progress (problem, best_testtime);
+
+    for (context->generation = 0; context->generation < context->max_generations; context->generation++) {
+        if (check_search_stop (problem, best_testtime))
+            break;
+
+        copy_genome (&children[0], best);
+        child_fitness[0] = best_testtime;
+
+        for (int c = 1; c < GA_POPULATION; c++) {
+            parent_a = select_parent (fitness, context->rng_state);
+            parent_b = select_parent (fitness, context->rng_state);
+            order_crossover (problem, &population[parent_a], &population[parent_b], &children[c], taken);
+            if (erand48 (context->rng_state) < GA_MUTATION_RATE)
+                apply_random_move (problem, &children[c], &moved_core);
+
+            reset_eval_state (state);
+            child_fitness[c] = evaluate_from (state, &children[c], 0, NO_CUTOFF);
+            if (child_fitness[c] < best_testtime) {
+                copy_genome (best, &children[c]);
+                best_testtime = child_fitness[c];
+                note_search_progress (problem, best_testtime);
+            }
+        }
+
+        temp = population;
+        population = children;
+        children = temp;
+        memcpy (fitness, child_fitness, sizeof (fitness));
+    }
+
+    print_search_stop (problem);
+    if (context->out_file != NULL)
+        fprintf(context->out_file, " Genetic algorithm: best total testtime %lf after %d generations\n\n", best_testtime, context->generation);
+
+    if (children < population)
+        population = children;
+    for (int c = 0; c < 2 * GA_POPULATION; c++)
+        free_genome (&population[c]);
+    free (population);
+    free (taken);
+    free_eval_state (state);
+    return best_testtime;
+}
+
+// Tabu search: every generation samples TABU_CANDIDATES random neighbourhood moves and takes the best one even if it is worse than
+// the current mapping; the moved test core stays tabu for TABU_TENURE generations unless a move of it beats the best mapping (aspiration)
+// Each candidate is scored with the best candidate so far as its cutoff
+
+double tabu_search (Search_problem *problem, Genome *best) {
+    PSO_context *context = problem->context;
+    Eval_state *state = create_problem_evaluator (problem, 1);  // Journaling evaluator of the current mapping
+    int *test_cores = (int *) malloc (problem->num_test_cores * sizeof (int));  // Test core numbers
+    int *tabu_until = (int *) calloc (problem->num_cores + 1, sizeof (int));    // Generation from which on each test core may be moved again
+    Genome current;                                             // Current mapping
+    Genome candidate;                                           // Current mapping after a sampled move
+    Genome chosen;                                              // Best candidate of the generation
+    double current_testtime = 0.0;                              // Total testtime of the current mapping
+    double best_testtime = 0.0;                                 // Total testtime of the best mapping
+    double chosen_testtime = 0.0;                               // Total testtime of the best candidate
+    double cutoff = 0.0;
+    double testtime = 0.0;
+    int position = 0;                                           // First position changed by a move
+    int chosen_position = 0;
+    int chosen_core = 0;
+    int moved_core = 0;
+
+    init_genome (&current, problem->num_test_cores);
+    init_genome (&candidate, problem->num_test_cores);
+    init_genome (&chosen, problem->num_test_cores);
+    find_test_cores (problem, test_cores);
+    init_random_genome (&current, test_cores, problem->num_test_cores, problem->num_io_pairs, problem->num_freq, context->rng_state);
+    free (test_cores);
+    current_testtime = evaluate_from (state, &current, 0, NO_CUTOFF);
+    copy_genome (best, &current);
+    best_testtime = current_testtime;
+    note_search_progress (problem, best_testtime);
+
+    for (context->generation = 0; context->generation < context->max_generations; context->generation++) {
+        if (check_search_stop (problem, best_testtime))
+            break;
+
+        chosen_testtime = NO_CUTOFF;
+        for (int c = 0; c < TABU_CANDIDATES; c++) {
+            copy_genome (&candidate, &current);
+            position = apply_random_move (problem, &candidate, &moved_core);
+
+            // A tabu move has to beat the best mapping as well
+            cutoff = chosen_testtime;
+            if (tabu_until[moved_core] > context->generation && best_testtime < cutoff)
+                cutoff = best_testtime;
+
+            testtime = evaluate_from (state, &candidate, position, cutoff);
+            state->num_valid = position;
+            if (testtime < cutoff) {
+                copy_genome (&chosen, &candidate);
+                chosen_testtime = testtime;
+                chosen_position = position;
+                chosen_core = moved_core;
+            }
+        }
+
+        // Every sampled move was tabu
+        if (chosen_testtime >= NO_CUTOFF)
+            continue;
+
+        copy_genome (&current, &chosen);
+        current_testtime = evaluate_from (state, &current, chosen_position, NO_CUTOFF);
+        tabu_until[chosen_core] = context->generation + 1 + TABU_TENURE;
+
+        if (current_testtime < best_testtime) {
+            copy_genome (best, &current);
+            best_testtime = current_testtime;
+            note_search_progress (problem, best_testtime);
+        }
+    }
+
+    print_search_stop (problem);
+    if (context->out_file != NULL)
+        fprintf(context->out_file, " Tabu search: best total testtime %lf after %d generations\n\n", best_testtime, context->generation);
+
+    free_genome (&current);
+    free_genome (&candidate);
+    free_genome (&chosen);
+    free (tabu_until);
+    free_eval_state (state);
+    return best_testtime;
+}
+
+// Re-evaluates the best mapping of a run for the IO schedule lists, prints the run summary and replays, checks and exports the schedule
+
+static void report_best_schedule (Search_problem *problem, Genome *best, double best_testtime) {
+    PSO_context *context = problem->context;
+    PSO_particle best_schedule;                                 // Best mapping re-evaluated for reporting
+
+    // Re-evaluate the best mapping so that the IO schedule lists describe the reported schedule (the particle shares its arrays)
+    best_schedule.mapping = *best;
+    find_resource_busytimes ((&best_schedule), problem->noc_nodes, problem->N_columns, problem->num_cores, problem->io_pairs, problem->num_io_pairs, context, NO_CUTOFF);
+
+    if (context->out_file != NULL) {
+        fprintf(context->out_file, " Evaluations: %ld full, %ld delta, %ld stopped early at the cutoff\n", context->num_full_evaluations, context->num_delta_evaluations, context->num_dominated_evaluations);
+        fprintf(context->out_file, " Evaluation arena: %.1lf KiB, %ld heap allocations\n", context->arena->size / 1024.0, context->arena->num_heap_calls);
+        fprintf(context->out_file, " Lower bound: %.2lf (io workload %.2lf, longest test %.2lf, link cut %.2lf)\n", context->lower_bounds.best,
+                context->lower_bounds.io_workload, context->lower_bounds.longest_test, context->lower_bounds.link_cut);
+        fprintf(context->out_file, " Optimality gap: %.2lf%%\n", 100 * find_optimality_gap (&context->lower_bounds, best_testtime));
+        fprintf(context->out_file, " Global best IO schedule lists\n");
+        for (int i = 0; i < problem->num_io_pairs; i++)
+            print_IO_schedule_lists (context->out_file, problem->io_pairs[i].io_head);
+        fprintf(context->out_file, "\n");
+    }
+
+    // Replay, check and export the reported schedule on a fresh evaluation of it
+    if (context->validate || context->check || context->export_format != EXPORT_NONE) {
+        Eval_state *state = create_problem_evaluator (problem, 0);
+        evaluate_from (state, best, 0, NO_CUTOFF);
+
+        // Replay the reported schedule at circuit and packet level
+        if (context->validate) {
+            Sim_report report;
+            simulate_schedule (state, best, &report);
+            print_sim_report (context->out_file, &report);
+        }
+
+        // Check the reported schedule for router ports and links used by two tests at once
+        if (context->check) {
+            Conflict_report report;
+            check_schedule_conflicts (state, &report);
+            print_conflict_report (context->out_file, &report);
+        }
+
+        if (context->export_format != EXPORT_NONE) {
+            char export_file[MAX_PATH_LENGTH + 8];
+            if (context->export_file != NULL)
+                snprintf (export_file, sizeof (export_file), "%s", context->export_file);
+            else
+                snprintf (export_file, sizeof (export_file), "schedule.%s", find_export_extension (context->export_format));
+            if (export_schedule (export_file, context->export_format, state, best, &context->lower_bounds) != 0 && context->out_file != NULL)
+                fprintf(context->out_file, " ERROR: Could not export the schedule to %s\n", export_file);
+        }
+        free_eval_state (state);
+    }
+}
+
+// Sets up the shared tables of a design (candidate routes, lower bounds), runs the search engine selected in the context and
+// reports the best schedule found, returns its total testtime
+
+double run_search_engine (NoC_node *noc_nodes, int num_cores, int M_rows, double *freq, int num_freq, IO_pairs *io_pairs, int num_io_pairs, PSO_context *context) {
+    Search_problem problem;                                     // Design and run handed to the engine
+    Genome best;                                                // Best mapping found
+    Gbest_PSO_particle best_found;                              // Best mapping found, for printing
+    double best_testtime = 0.0;                                 // Total testtime of the best mapping
+    Route_table *run_route_table = NULL;                        // Route table built for this run (if none was given)
+    Eval_arena *run_arena = NULL;                               // Evaluation arena created for this run (if none was given)
+    Profile *run_profile = NULL;                                // Cycle profile of this run (profiling builds with a profile file)
+
+    problem.noc_nodes = noc_nodes;
+    problem.num_cores = num_cores;
+    problem.N_columns = num_cores / M_rows;
+    problem.num_test_cores = num_cores - (2 * num_io_pairs);
+    problem.io_pairs = io_pairs;
+    problem.num_io_pairs = num_io_pairs;
+    problem.freq = freq;
+    problem.num_freq = num_freq;
+    problem.context = context;
+    problem.start_time = get_wall_time ();
+    problem.deadline = (context->time_limit > 0) ? problem.start_time + context->time_limit : 0.0;
+
+    context->stopped_early = 0;
+    context->target_reached = 0;
+    context->trace.num_points = 0;
+    init_genome (&best, problem.num_test_cores);
+
+    // Candidate routes are precomputed once per run unless the caller shares a table (batch mode, benchmark)
+    if (context->route_table == NULL)
+        context->route_table = run_route_table = create_route_table (M_rows, problem.N_columns, context->routing);
+
+    // Full evaluations take their scratch memory from one arena per run (and so per thread)
+    if (context->arena == NULL)
+        context->arena = run_arena = create_eval_arena (EVAL_ARENA_SIZE);
+
+    // Mappings hold frequency indices, the evaluator looks them up here
+    context->freq = freq;
+    context->num_freq = num_freq;
+
+    // Lower bounds are computed once per design, before the search starts
+    compute_lower_bounds (noc_nodes, problem.N_columns, num_cores, io_pairs, num_io_pairs, freq, num_freq, context);
+
+#ifdef NOC_PROFILE
+    // Profiling builds (-DNOC_PROFILE) record the cycles of the search, its operators and its evaluations
+    if (context->profile_file != NULL)
+        context->profile = run_profile = create_profile ();
+#endif
+    PROFILE_ENTER(context->profile, PROFILE_SEARCH);
+
+    // Hierarchical mode runs the selected engine on every region of the mesh instead
+    if (context->hierarchical)
+        best_testtime = region_decomposed_search (&problem, &best);
+    else {
+        switch (context->engine) {
+            case ENGINE_SA:
+                best_testtime = simulated_annealing (&problem, &best);
+                break;
+            case ENGINE_GA:
+                best_testtime = genetic_algorithm (&problem, &best);
+                break;
+            case ENGINE_TABU:
+                best_testtime = tabu_search (&problem, &best);
+                break;
+            case ENGINE_BNB:
+                best_testtime = branch_and_bound (&problem, &best);
+                break;
+            default:
+                best_testtime = particle_swarm_optimization (&problem, &best);
+                break;
+        }
+    }
+
+    PROFILE_EXIT(context->profile);
+    if (context->best_mapping != NULL)
+        copy_genome (context->best_mapping, &best);
+
+    // PSO prints its particles and global best itself
+    if (context->engine != ENGINE_PSO || context->hierarchical) {
+        best_found.gbest_mapping = best;
+        best_found.gbest_fitness = best_testtime;
+        print_global_best_info (context->out_file, (&best_found), problem.num_test_cores, freq);
+    }
+
+    report_best_schedule (&problem, &best, best_testtime);
+
+    if (run_profile != NULL) {
+        if (report_profile (run_profile, context->out_file, context->profile_file) != 0 && context->out_file != NULL)
+            fprintf(context->out_file, " ERROR: Could not write the folded stacks to %s\n", context->profile_file);
+        free (run_profile);
+        context->profile = NULL;
+    }
+
+    if (run_route_table != NULL) {
+        free_route_table (run_route_table);
+        context->route_table = NULL;
+    }
+
+    // The IO schedule lists point into the arena, they are emptied with it
+    if (run_arena != NULL) {
+        for (int i = 0; i < num_io_pairs; i++)
+            clear_IO_list (io_pairs[i].io_head);
+        free_eval_arena (run_arena);
+        context->arena = NULL;
+    }
+    free_genome (&best);
+    return best_testtime;
+}
+
+// Runs every search engine num_runs times on a design with the same seeds (seed, seed + 1, ...) and the same wall-clock budget, and
+// reports the best and mean total testtime, the evaluations done, and the time-to-quality: the time until a run is within
+// BENCHMARK_TOLERANCE of the best total testtime found by any run (runs that never get there count as not reaching it)
+// All runs share one route table and one testtime table and use one thread; checkpoints, replays, checks and exports are off
+
+void benchmark_search_engines (NoC_design *design, double *freq, int num_freq, PSO_context *settings, unsigned int seed, int num_runs, FILE *out_file) {
+    PSO_context context;                                        // Settings of the current run
+    Table_cache cache;                                          // Tables shared by all runs
+    Testtime_table *testtime_table;                             // Testtime table (and route table) of the design
+    double testtimes[NUM_ENGINES][MAX_BENCHMARK_RUNS];          // Best total testtime of each run
+    long evaluations[NUM_ENGINES][MAX_BENCHMARK_RUNS];          // Evaluations done in each run
+    Search_trace *traces;                                       // Improvements over each run
+    Search_trace *trace;
+    double target = NO_CUTOFF;                                  // Time-to-quality target
+    double best_time[NUM_ENGINES];                              // Mean time to the target over the runs that reached it
+    int num_reached[NUM_ENGINES];                               // Number of runs that reached the target
+    int num_done[NUM_ENGINES];                                  // Number of runs completed (fewer after a stop request)
+    double best_testtime = 0.0;
+    double mean_testtime = 0.0;
+    long mean_evaluations = 0;
+    int fastest = -1;                                           // Engine reaching the target in most runs, in the shortest time
+
+    if (num_runs > MAX_BENCHMARK_RUNS)
+        num_runs = MAX_BENCHMARK_RUNS;
+
+    traces = (Search_trace *) malloc (NUM_ENGINES * num_runs * sizeof (Search_trace));
+
+    init_table_cache (&cache);
+    testtime_table = acquire_testtime_table (&cache, design, settings->routing);
+
+    fprintf(out_file, " Benchmark: %d runs per engine, %.2lf s each\n\n", num_runs, (settings->time_limit > 0) ? settings->time_limit : BENCHMARK_TIME_LIMIT);
+
+    for (int e = 0; e < NUM_ENGINES; e++) {
+        num_done[e] = 0;
+
+        // After a stop request the remaining runs are skipped
+        for (int r = 0; r < num_runs && !(settings->stop_requested != NULL && *settings->stop_requested); r++) {
+            context = *settings;
+            context.out_file = NULL;
+            context.testtime_table = testtime_table;
+            context.route_table = testtime_table->route_table;
+            context.engine = e;
+            context.num_threads = 1;
+            context.max_generations = INT_MAX;
+            context.time_limit = (settings->time_limit > 0) ? settings->time_limit : BENCHMARK_TIME_LIMIT;
+            context.checkpoint_file = NULL;
+            context.resume_file = NULL;
+            context.profile_file = NULL;
+            context.warm_start_file = NULL;
+            context.best_mapping = NULL;
+            context.validate = 0;
+            context.check = 0;
+            context.export_format = EXPORT_NONE;
+            context.num_full_evaluations = 0;
+            context.num_delta_evaluations = 0;
+            context.num_dominated_evaluations = 0;
+            seed_pso_context (&context, seed + r);
+
+            testtimes[e][r] = run_search_engine (design->noc_nodes, design->num_cores, design->M_rows, freq, num_freq, design->io_pairs, design->num_io_pairs, &context);
+            evaluations[e][r] = context.num_full_evaluations + context.num_delta_evaluations;
+            traces[e * num_runs + r] = context.trace;
+            if (testtimes[e][r] < target)
+                target = testtimes[e][r];
+            num_done[e]++;
+        }
+    }
+    target *= 1 + BENCHMARK_TOLERANCE;
+
+    fprintf(out_file, " %-6s %14s %14s %12s %10s %14s\n", "Engine", "Best testtime", "Mean testtime", "Evaluations", "Reached", "Time to target");
+    for (int e = 0; e < NUM_ENGINES; e++) {
+        best_testtime = NO_CUTOFF;
+        mean_testtime = 0.0;
+        mean_evaluations = 0;
+        best_time[e] = 0.0;
+        num_reached[e] = 0;
+
+        if (num_done[e] == 0) {
+            fprintf(out_file, " %-6s %14s\n", search_engine_names[e], "-");
+            continue;
+        }
+
+        for (int r = 0; r < num_done[e]; r++) {
+            best_testtime = (testtimes[e][r] < best_testtime) ? testtimes[e][r] : best_testtime;
+            mean_testtime += testtimes[e][r] / num_done[e];
+            mean_evaluations += evaluations[e][r] / num_done[e];
+
+            // First improvement within the target
+            trace = &traces[e * num_runs + r];
+            for (int k = 0; k < trace->num_points; k++) {
+                if (trace->testtime[k] <= target) {
+                    best_time[e] += trace->time[k];
+                    num_reached[e]++;
+                    break;
+                }
+            }
+        }
+        if (num_reached[e] > 0)
+            best_time[e] /= num_reached[e];
+
+        fprintf(out_file, " %-6s %14.2lf %14.2lf %12ld %7d/%-2d ", search_engine_names[e], best_testtime, mean_testtime, mean_evaluations, num_reached[e], num_done[e]);
+        if (num_reached[e] > 0)
+            fprintf(out_file, "%12.4lf s\n", best_time[e]);
+        else
+            fprintf(out_file, "%14s\n", "-");
+
+        if (num_reached[e] > 0 && (fastest < 0 || num_reached[e] > num_reached[fastest] ||
+                                   (num_reached[e] == num_reached[fastest] && best_time[e] < best_time[fastest])))
+            fastest = e;
+    }
+    fprintf(out_file, "\n Target: %.2lf (best found + %.0lf%%), fastest engine: %s\n", target, 100 * BENCHMARK_TOLERANCE, (fastest >= 0) ? search_engine_names[fastest] : "-");
+
+    release_testtime_table (&cache, testtime_table);
+    free_table_cache (&cache);
+    free (traces);
+}
+
+// Maps a search engine name (pso, sa, ga, tabu, bnb) to its ENGINE_* value, -1 if unknown
+
+int find_search_engine (const char *name) {
+    for (int e = 0; e < NUM_ENGINES; e++)
+        if (strcmp (name, search_engine_names[e]) == 0)
+            return e;
+    return -1;
+}
+
+// Name of a search engine
+
+const char *find_search_engine_name (int engine) {
+    return (engine >= 0 && engine < NUM_ENGINES) ? search_engine_names[engine] : "unknown";
+}
+
+
+// ============
+// EXACT SOLVER
+// ============
+
+// Branch-and-bound over the test order and the io pair of every test, with each test unpreempted at the fastest frequency
+// A node of depth d is a schedule of the first d positions on a journaling evaluation state; children append one more test on one
+// io pair (schedule_test_core) and are undone by rollback_eval_state.
+// Dominance pruning: a test starts once every earlier test sharing a resource with it has ended, so listing the tests of any
+// schedule by starttime (core number on ties) reproduces it -- only sequences with non-decreasing starttimes are explored, which
+// cuts all permutations that merely reorder the same schedule
+// Transpositions: with one candidate route per pair, a child depends on the busytimes only where they reach the last starttime
+// (children start no earlier) and on the routes of the remaining tests, so partial schedules of the same tests that agree there
+// share their completions -- each worker remembers the ones explored to the end and skips a later one that cannot do better
+
+// Rounds a bound up to a whole number if every testtime is one
+
+static double round_exact_bound (Exact_search *search, double bound) {
+    return search->integral ? ceil (bound - 1e-9) : bound;
+}
+
+// Lower bound on the total testtime of every completion of a partial schedule -- remaining tests start no earlier than the last
+// test scheduled, so the bound is the largest of
+// - the current makespan and the earliest any remaining test can end
+// - io pair loads: the cheapest testtimes of the remaining tests poured onto the io pairs from the times they become free (an io
+//   pair busy past the level takes none of it)
+// - link cut: the least link time the remaining tests spend across each cut direction, shared by the links of the cut
+// The costlier parts are skipped once the bound reaches the worker's cutoff
+
+static double find_exact_bound (Exact_worker *worker, int depth, double last_start) {
+    Exact_search *search = worker->search;
+    Eval_state *state = worker->state;
+    int num_io_pairs = state->num_io_pairs;
+    int num_cut_dirs = search->num_cut_dirs;
+    double *io_free = worker->io_free;                          // Times the io pairs become free, earliest first
+    double *cut_load = worker->cut_load + depth * num_cut_dirs; // Link time of the remaining tests across each cut direction
+    double bound = state->makespan;
+    double workload = 0.0;                                      // Times the io pairs become free plus the cheapest remaining testtimes
+    double earliest = 0.0;                                      // Earliest end of a remaining test
+    double latest_free = 0.0;                                   // Latest time an io pair becomes free
+    double level = 0.0;                                         // Level of the workload poured onto the io pairs
+    double cut_time = 0.0;                                      // Longest link time per link of a cut direction
+    double free_time = 0.0;
+    int test_core = 0;
+    int k = 0;
+
+    for (int j = 0; j < num_io_pairs; j++) {
+        free_time = max(state->io_busytime[j], last_start);
+        workload += free_time;
+        latest_free = max(latest_free, free_time);
+        io_free[j] = free_time;
+    }
+
+    for (int i = 0; i < state->num_test_cores && depth < state->num_test_cores; i++) {
+        test_core = search->order[i];
+        if (worker->placed[test_core])
+            continue;
+
+        workload += search->min_testtimes[test_core - 1];
+        earliest = NO_CUTOFF;
+        for (k = 0; k < num_io_pairs; k++)
+            if (io_free[k] + search->testtimes[(test_core - 1) * num_io_pairs + k] < earliest)
+                earliest = io_free[k] + search->testtimes[(test_core - 1) * num_io_pairs + k];
+        bound = max(bound, earliest);
+    }
+
+    // Balanced over all io pairs, unless one is still busy above that level: then the io pairs free first are filled until the
+    // level stays below the next one
+    level = workload / num_io_pairs;
+    if (latest_free > level) {
+        for (int j = 1; j < num_io_pairs; j++) {
+            free_time = io_free[j];
+            for (k = j; k > 0 && io_free[k - 1] > free_time; k--)
+                io_free[k] = io_free[k - 1];
+            io_free[k] = free_time;
+        }
+        for (k = num_io_pairs - 1; k > 0 && io_free[k] > level; k--) {
+            workload -= io_free[k];
+            level = workload / k;
+        }
+    }
+    bound = max(bound, level);
+    if (round_exact_bound (search, bound) >= worker->cutoff)
+        return round_exact_bound (search, bound);
+
+    for (int c = 0; c < num_cut_dirs; c++)
+        cut_time = max(cut_time, cut_load[c] * search->cut_shares[c]);
+    bound = max(bound, last_start + cut_time);
+
+    return round_exact_bound (search, bound);
+}
+
+// Adds a 64-bit word to a FNV-1a hash
+
+static unsigned long long hash_exact_word (unsigned long long hash, unsigned long long word) {
+    return (hash ^ word) * 1099511628211ull;
+}
+
+// Hash of a partial schedule of a worker: its tests, the last starttime, and every busytime from the last starttime on, with its
+// slot -- of the io pairs, and of the router ports and links on the routes of the remaining tests (earlier busytimes hold no
+// child back, the other resources are not used again). Never 0 (empty table slot)
+
+static unsigned long long hash_exact_state (Exact_worker *worker, double last_start) {
+    Exact_search *search = worker->search;
+    Eval_state *state = worker->state;
+    int num_mask_words = search->num_mask_words;
+    unsigned long long *slot_mask = worker->slot_mask;
+    unsigned long long *test_mask;
+    unsigned long long hash = 14695981039346656037ull;
+    unsigned long long bits = 0;
+    unsigned long long word = 0;
+    int num_slots = state->num_cores * ROUTER_STATE_SLOTS;
+    int i = 0;
+
+    for (int w = 0; w < num_mask_words; w++)
+        slot_mask[w] = 0;
+    for (int c = 1; c <= state->num_cores; c++) {
+        if (worker->placed[c])
+            hash = hash_exact_word (hash, (unsigned long long) c);
+        else if (state->noc_nodes[c - 1].core_type == TEST_CORE) {
+            test_mask = search->slot_masks + (c - 1) * num_mask_words;
+            for (int w = 0; w < num_mask_words; w++)
+                slot_mask[w] |= test_mask[w];
+        }
+    }
+    memcpy (&bits, &last_start, sizeof (bits));
+    hash = hash_exact_word (hash, bits);
+    for (int k = 0; k < state->num_io_pairs; k++) {
+        if (state->io_busytime[k] < last_start)
+            continue;
+        memcpy (&bits, &state->io_busytime[k], sizeof (bits));
+        hash = hash_exact_word (hash_exact_word (hash, (unsigned long long) k), bits);
+    }
+    for (int w = 0; w < num_mask_words; w++) {
+        for (word = slot_mask[w]; word != 0; word &= word - 1) {
+            i = 64 * w + __builtin_ctzll (word);
+            if (state->busytimes[i] < last_start)
+                continue;
+            memcpy (&bits, &state->busytimes[i], sizeof (bits));
+            hash = hash_exact_word (hash_exact_word (hash, (unsigned long long) (num_slots + i)), bits);
+        }
+    }
+    return (hash != 0) ? hash : 1;
+}
+
+// Refreshes a worker's copy of the incumbent and stops the search once the deadline passed or a stop was requested
+
+static void sync_exact_worker (Exact_worker *worker) {
+    Exact_search *search = worker->search;
+    Search_problem *problem = search->problem;
+
+    pthread_mutex_lock (&search->lock);
+    if ((problem->deadline > 0 && get_wall_time () >= problem->deadline) ||
+        (problem->context->stop_requested != NULL && *problem->context->stop_requested)) {
+        search->stop = 1;
+        search->stopped_early = 1;
+    }
+    worker->cutoff = search->incumbent;
+    worker->stop = search->stop;
+    pthread_mutex_unlock (&search->lock);
+}
+
+// Makes the complete schedule of a worker the incumbent if it is better; reaching the static lower bound proves it optimal
+
+static void update_exact_incumbent (Exact_worker *worker) {
+    Exact_search *search = worker->search;
+    Search_problem *problem = search->problem;
+    double testtime = worker->state->makespan;
+
+    pthread_mutex_lock (&search->lock);
+    if (testtime < search->incumbent) {
+        search->incumbent = testtime;
+        copy_genome (&search->best, &worker->mapping);
+        note_search_progress (problem, testtime);
+        if (testtime <= problem->context->lower_bounds.best)
+            search->stop = 1;
+    }
+    worker->cutoff = search->incumbent;
+    worker->stop = search->stop;
+    pthread_mutex_unlock (&search->lock);
+}
+
+// Link time across every cut direction left after the test at position depth: that of depth less the test core's own
+
+static void remove_exact_cut_load (Exact_worker *worker, int depth, int test_core) {
+    int num_cut_dirs = worker->search->num_cut_dirs;
+    double *cut_load = worker->cut_load + depth * num_cut_dirs;
+    double *test_load = worker->search->cut_loads + (test_core - 1) * num_cut_dirs;
+
+    for (int c = 0; c < num_cut_dirs; c++)
+        cut_load[num_cut_dirs + c] = cut_load[c] - test_load[c];
+}
+
+// Depth-first search below a partial schedule of depth positions whose last test started at last_start (its tests are flagged in
+// worker->placed); children are tried longest test first, each on its io pairs in order of their earliest possible end
+// Subtrees explored to the end are remembered in the worker's table, and one whose completions are no better is skipped
+
+static void explore_exact_subtree (Exact_worker *worker, int depth, double last_start) {
+    Exact_search *search = worker->search;
+    Eval_state *state = worker->state;
+    int num_test_cores = state->num_test_cores;
+    int num_io_pairs = state->num_io_pairs;
+    int *io_order = worker->io_order + depth * num_io_pairs;    // IO pairs of a child, earliest possible end first
+    double *finish = worker->finish + depth * num_io_pairs;     // Earliest possible end of the child on each io pair
+    Exact_entry *entry = NULL;                                  // Table slot of the partial schedule (NULL --> not looked up)
+    unsigned long long key = 0;
+    int last_core = worker->mapping.test_core[depth - 1];
+    int test_core = 0;
+    int k = 0;
+
+    if (++worker->num_nodes % EXACT_SYNC_NODES == 0)
+        sync_exact_worker (worker);
+    if (worker->stop)
+        return;
+
+    if (depth == num_test_cores) {
+        if (state->makespan < worker->cutoff)
+            update_exact_incumbent (worker);
+        return;
+    }
+
+    if (find_exact_bound (worker, depth, last_start) >= worker->cutoff)
+        return;
+
+    if (worker->table != NULL && num_test_cores - depth >= EXACT_TABLE_DEPTH) {
+        key = hash_exact_state (worker, last_start);
+        entry = &worker->table[key & (EXACT_TABLE_SIZE - 1)];
+        if (entry->key == key && entry->makespan <= state->makespan && entry->last_core <= last_core) {
+            worker->num_hits++;
+            return;
+        }
+    }
+
+    for (int i = 0; i < num_test_cores && !worker->stop; i++) {
+        test_core = search->order[i];
+        if (worker->placed[test_core])
+            continue;
+
+        for (int j = 0; j < num_io_pairs; j++) {
+            finish[j] = max(state->io_busytime[j], last_start) + search->testtimes[(test_core - 1) * num_io_pairs + j];
+            for (k = j; k > 0 && finish[io_order[k - 1]] > finish[j]; k--)
+                io_order[k] = io_order[k - 1];
+            io_order[k] = j;
+        }
+
+        worker->mapping.test_core[depth] = test_core;
+        worker->placed[test_core] = 1;
+        remove_exact_cut_load (worker, depth, test_core);
+        for (int j = 0; j < num_io_pairs && !worker->stop; j++) {
+            if (finish[io_order[j]] >= worker->cutoff)
+                break;
+
+            worker->mapping.io_pair[depth] = io_order[j] + 1;
+            schedule_test_core (state, &worker->mapping, depth);
+            if (state->makespan < worker->cutoff &&
+                (state->starttime[depth] > last_start || (state->starttime[depth] == last_start && test_core > last_core)))
+                explore_exact_subtree (worker, depth + 1, state->starttime[depth]);
+            rollback_eval_state (state, depth);
+        }
+        worker->placed[test_core] = 0;
+    }
+
+    if (entry != NULL && !worker->stop) {
+        entry->key = key;
+        entry->makespan = state->makespan;
+        entry->last_core = last_core;
+    }
+}
+
+// Branch-and-bound worker -- explores first-level subtrees until none is left or the search stops
+
+static void *exact_worker_main (void *arg) {
+    Exact_worker *worker = (Exact_worker *) arg;
+    Exact_search *search = worker->search;
+    int num_io_pairs = search->problem->num_io_pairs;
+    int task = 0;
+
+    while (1) {
+        pthread_mutex_lock (&search->lock);
+        task = (search->stop || search->next_task >= search->num_tasks) ? -1 : search->next_task++;
+        worker->cutoff = search->incumbent;
+        worker->stop = search->stop;
+        pthread_mutex_unlock (&search->lock);
+        if (task < 0)
+            break;
+
+        worker->mapping.test_core[0] = search->order[task / num_io_pairs];
+        worker->mapping.io_pair[0] = task % num_io_pairs + 1;
+        schedule_test_core (worker->state, &worker->mapping, 0);
+        worker->placed[worker->mapping.test_core[0]] = 1;
+        remove_exact_cut_load (worker, 0, worker->mapping.test_core[0]);
+        if (worker->state->makespan < worker->cutoff)
+            explore_exact_subtree (worker, 1, worker->state->starttime[0]);
+        worker->placed[worker->mapping.test_core[0]] = 0;
+        rollback_eval_state (worker->state, 0);
+    }
+
+    pthread_mutex_lock (&search->lock);
+    search->num_nodes += worker->num_nodes;
+    search->num_hits += worker->num_hits;
+    pthread_mutex_unlock (&search->lock);
+    return NULL;
+}
+
+// Greedy start: repeatedly appends the test and io pair that end first (longest test on ties), gives the first incumbent
+
+static double find_greedy_schedule (Exact_search *search, Eval_state *state, Genome *mapping) {
+    int num_test_cores = state->num_test_cores;
+    int num_io_pairs = state->num_io_pairs;
+    char *placed = (char *) calloc (state->num_cores + 1, sizeof (char));   // [test_core]: set once the test core is scheduled
+    double endtime = 0.0;
+    double best_endtime = 0.0;
+    int best_core = 0;
+    int best_io_pair = 0;
+
+    for (int depth = 0; depth < num_test_cores; depth++) {
+        best_endtime = NO_CUTOFF;
+        for (int i = 0; i < num_test_cores; i++) {
+            if (placed[search->order[i]])
+                continue;
+            mapping->test_core[depth] = search->order[i];
+            for (int k = 1; k <= num_io_pairs; k++) {
+                mapping->io_pair[depth] = k;
+                schedule_test_core (state, mapping, depth);
+                endtime = state->endtime[depth];
+                rollback_eval_state (state, depth);
+                if (endtime < best_endtime) {
+                    best_endtime = endtime;
+                    best_core = search->order[i];
+                    best_io_pair = k;
+                }
+            }
+        }
+        mapping->test_core[depth] = best_core;
+        mapping->io_pair[depth] = best_io_pair;
+        schedule_test_core (state, mapping, depth);
+        placed[best_core] = 1;
+    }
+
+    endtime = state->makespan;
+    rollback_eval_state (state, 0);
+    free (placed);
+    return endtime;
+}
+
+// Adds a busytime slot to the slot mask of a test core
+
+static void mark_exact_slot (Exact_search *search, int test_core, int slot) {
+    search->slot_masks[(test_core - 1) * search->num_mask_words + slot / 64] |= 1ull << (slot % 64);
+}
+
+// Exact branch-and-bound over test order and io pairs with every test unpreempted at the fastest frequency, returns the total
+// testtime of the best mapping found -- optimal for that space unless the search was stopped early (reported in the output)
+// Subtrees are explored by num_threads workers sharing the incumbent
+
+double branch_and_bound (Search_problem *problem, Genome *best) {
+    PSO_context *context = problem->context;
+    int num_test_cores = problem->num_test_cores;
+    int num_io_pairs = problem->num_io_pairs;
+    int num_threads = context->num_threads;                     // Number of workers
+    Exact_search search;                                        // State shared by the workers
+    Exact_worker *workers;                                      // Per-worker state
+    Genome probe;                                               // Single test used to look up the testtimes
+    int *test_cores = (int *) malloc (num_test_cores * sizeof (int));
+    int M_rows = problem->num_cores / problem->N_columns;
+    int num_cuts = (problem->N_columns - 1) + (M_rows - 1);     // Vertical cuts (b/w columns) followed by horizontal cuts (b/w rows)
+    int *crossings = (int *) malloc ((2 * num_cuts + 2) * sizeof (int));
+    double tail_time = 0.0;                                     // Testtime of a segment without patterns
+    Route_hop hops[MAX_ROUTE_HOPS];                             // Route of one leg of a test
+    int num_hops = 0;
+    int slot = 0;
+    double cut_load = 0.0;
+    int test_core = 0;
+    int j = 0;
+    double start_time = get_wall_time ();
+
+    if (num_threads <= 0)
+        num_threads = (int) sysconf (_SC_NPROCESSORS_ONLN);
+    if (num_threads > MAX_BATCH_THREADS)
+        num_threads = MAX_BATCH_THREADS;
+    if (num_threads < 1)
+        num_threads = 1;
+
+    search.problem = problem;
+    search.testtimes = (double *) malloc (problem->num_cores * num_io_pairs * sizeof (double));
+    search.min_testtimes = (double *) malloc (problem->num_cores * sizeof (double));
+    search.order = (int *) malloc (num_test_cores * sizeof (int));
+    search.transpositions = (context->routing == ROUTING_XY || context->routing == ROUTING_YX);    // Dimension order: one route per pair
+    search.num_mask_words = (problem->num_cores * ROUTER_STATE_SLOTS + 63) / 64;
+    search.slot_masks = (unsigned long long *) calloc (problem->num_cores * search.num_mask_words, sizeof (unsigned long long));
+    search.num_cut_dirs = (context->routing != ROUTING_TORUS) ? 2 * num_cuts : 0;    // The wraparound links bypass every cut
+    search.cut_loads = (double *) malloc ((problem->num_cores * search.num_cut_dirs + 1) * sizeof (double));
+    search.cut_shares = (double *) malloc ((search.num_cut_dirs + 1) * sizeof (double));
+    for (int c = 0; c < search.num_cut_dirs; c++)
+        search.cut_shares[c] = 1.0 / ((c / 2 < problem->N_columns - 1) ? M_rows : problem->N_columns);    // A vertical cut is crossed by M_rows links
+    search.freq_index = 0;
+    search.integral = 1;
+    for (int f = 1; f < problem->num_freq; f++)
+        if (problem->freq[f] > problem->freq[search.freq_index])
+            search.freq_index = f;
+
+    workers = (Exact_worker *) malloc (num_threads * sizeof (Exact_worker));
+    for (int w = 0; w < num_threads; w++) {
+        workers[w].search = &search;
+        workers[w].state = create_problem_evaluator (problem, 1);
+        workers[w].num_nodes = 0;
+        workers[w].num_hits = 0;
+        if (w > 0)
+            workers[w].state->profile = NULL;          // Only the first worker records into the (unsynchronized) profile
+        init_genome (&workers[w].mapping, num_test_cores);
+        workers[w].placed = (char *) calloc (problem->num_cores + 1, sizeof (char));
+        workers[w].io_order = (int *) malloc (num_test_cores * num_io_pairs * sizeof (int));
+        workers[w].finish = (double *) malloc (num_test_cores * num_io_pairs * sizeof (double));
+        workers[w].io_free = (double *) malloc (num_io_pairs * sizeof (double));
+        workers[w].cut_load = (double *) calloc ((num_test_cores + 1) * search.num_cut_dirs + 1, sizeof (double));
+        workers[w].table = search.transpositions ? (Exact_entry *) calloc (EXACT_TABLE_SIZE, sizeof (Exact_entry)) : NULL;
+        workers[w].slot_mask = (unsigned long long *) malloc (search.num_mask_words * sizeof (unsigned long long));
+        for (int p = 0; p < num_test_cores; p++) {
+            workers[w].mapping.freq_index[p] = search.freq_index;
+            workers[w].mapping.preemption[p] = PREEMPTION_MAX;
+        }
+    }
+
+    // Testtimes of every unpreempted test through every io pair, and the least link time it spends across every cut (its patterns
+    // occupy the links of both legs)
+    init_genome (&probe, num_test_cores);
+    copy_genome (&probe, &workers[0].mapping);
+    find_test_cores (problem, test_cores);
+    for (int i = 0; i < num_test_cores; i++) {
+        test_core = test_cores[i];
+        probe.test_core[0] = test_core;
+        search.min_testtimes[test_core - 1] = NO_CUTOFF;
+        for (int k = 1; k <= num_io_pairs; k++) {
+            search.testtimes[(test_core - 1) * num_io_pairs + (k - 1)] = find_position_segment_testtime (workers[0].state, &probe, 0, k, find_position_segment_patterns (workers[0].state, &probe, 0, 0));
+            if (search.testtimes[(test_core - 1) * num_io_pairs + (k - 1)] != floor (search.testtimes[(test_core - 1) * num_io_pairs + (k - 1)]))
+                search.integral = 0;
+            if (search.testtimes[(test_core - 1) * num_io_pairs + (k - 1)] < search.min_testtimes[test_core - 1])
+                search.min_testtimes[test_core - 1] = search.testtimes[(test_core - 1) * num_io_pairs + (k - 1)];
+
+            // Busytime slots the routes of the test read (find_route_busytime)
+            for (int leg = 0; leg < 2 && search.transpositions; leg++) {
+                if (leg == 0)
+                    num_hops = find_candidate_route (workers[0].state->route_table, problem->io_pairs[k - 1].input_core_no, test_core, 0, hops);
+                else
+                    num_hops = find_candidate_route (workers[0].state->route_table, test_core, problem->io_pairs[k - 1].output_core_no, 0, hops);
+                for (int h = 0; h < num_hops; h++) {
+                    slot = (hops[h].router - 1) * ROUTER_STATE_SLOTS;
+                    mark_exact_slot (&search, test_core, slot + PORT_PAIR_SLOT(hops[h].out_port, INPUT));
+                    mark_exact_slot (&search, test_core, slot + PORT_PAIR_SLOT(hops[h].in_port, OUTPUT));
+                    mark_exact_slot (&search, test_core, slot + LINK_SLOT(hops[h].out_port));
+                }
+            }
+
+            if (search.num_cut_dirs == 0)
+                continue;
+            tail_time = find_position_segment_testtime (workers[0].state, &probe, 0, k, 0);
+            count_cut_crossings (problem->noc_nodes, problem->N_columns, num_cuts, &problem->io_pairs[k - 1], test_core, crossings);
+            for (int c = 0; c < search.num_cut_dirs; c++) {
+                cut_load = (search.testtimes[(test_core - 1) * num_io_pairs + (k - 1)] - tail_time) * crossings[c];
+                if (k == 1 || cut_load < search.cut_loads[(test_core - 1) * search.num_cut_dirs + c])
+                    search.cut_loads[(test_core - 1) * search.num_cut_dirs + c] = cut_load;
+            }
+        }
+
+        // Branching order: longest test first
+        for (j = i; j > 0 && search.min_testtimes[search.order[j - 1] - 1] < search.min_testtimes[test_core - 1]; j--)
+            search.order[j] = search.order[j - 1];
+        search.order[j] = test_core;
+    }
+
+    // Every test remains at the root
+    for (int i = 0; i < num_test_cores; i++)
+        for (int c = 0; c < search.num_cut_dirs; c++)
+            workers[0].cut_load[c] += search.cut_loads[(search.order[i] - 1) * search.num_cut_dirs + c];
+    for (int w = 1; w < num_threads; w++)
+        memcpy (workers[w].cut_load, workers[0].cut_load, search.num_cut_dirs * sizeof (double));
+
+    free_genome (&probe);
+    free (test_cores);
+    free (crossings);
+    pthread_mutex_init (&search.lock, NULL);
+    init_genome (&search.best, num_test_cores);
+    copy_genome (&search.best, &workers[0].mapping);
+    search.incumbent = find_greedy_schedule (&search, workers[0].state, &search.best);
+    note_search_progress (problem, search.incumbent);
+    search.next_task = 0;
+    search.num_tasks = num_test_cores * num_io_pairs;
+    search.stop = (search.incumbent <= context->lower_bounds.best);
+    search.stopped_early = 0;
+    search.num_nodes = 0;
+    search.num_hits = 0;
+
+    if (context->out_file != NULL)
+        fprintf(context->out_file, " Branch and bound: %d test cores, %d io pairs, %d threads, greedy start %lf\n", num_test_cores, num_io_pairs, num_threads, search.incumbent);
+
+    for (int w = 0; w < num_threads; w++)
+        pthread_create (&workers[w].thread, NULL, exact_worker_main, &workers[w]);
+    for (int w = 0; w < num_threads; w++)
+        pthread_join (workers[w].thread, NULL);
+
+    context->generation = 0;
+    context->stopped_early = search.stopped_early;
+    context->num_delta_evaluations += search.num_nodes;
+
+    if (context->out_file != NULL) {
+        if (search.stopped_early)
+            fprintf(context->out_file, " Branch and bound: stopped early, best total testtime %lf is not proven optimal\n", search.incumbent);
+        else
+            fprintf(context->out_file, " Branch and bound: optimal total testtime %lf (unpreempted tests)\n", search.incumbent);
+        fprintf(context->out_file, " Branch and bound: %ld nodes, %ld skipped as already explored, %.2lf s\n\n", search.num_nodes, search.num_hits,
+                get_wall_time () - start_time);
+    }
+
+    copy_genome (best, &search.best);
+
+    pthread_mutex_destroy (&search.lock);
+    for (int w = 0; w < num_threads; w++) {
+        free_eval_state (workers[w].state);
+        free_genome (&workers[w].mapping);
+        free (workers[w].placed);
+        free (workers[w].io_order);
+        free (workers[w].finish);
+        free (workers[w].io_free);
+        free (workers[w].cut_load);
+        free (workers[w].table);
+        free (workers[w].slot_mask);
+    }
+    free_genome (&search.best);
+    free (workers);
+    free (search.testtimes);
+    free (search.min_testtimes);
+    free (search.order);
+    free (search.cut_loads);
+    free (search.cut_shares);
+    free (search.slot_masks);
+    return search.incumbent;
+}
+
+
+// =================
+// HIERARCHICAL MODE
+// =================
+
+// Side of a cut through a region a core lies on (0: the first cut columns or rows of the region, 1: the rest)
+
+static int find_region_side (NoC_design *design, Mesh_region *region, int vertical, int cut, int core) {
+    if (vertical)
+        return ((core - 1) % design->N_columns - region->col0 >= cut);
+    else
+        return ((core - 1) / design->N_columns - region->row0 >= cut);
+}
+
+// Splits the mesh into rectangular regions of whole io pairs by recursive bisection, returns the number of regions
+// A region is cut along the row or column boundary that keeps every io pair on one side, leaves each side at least one io pair and
+// one test core, and best balances the test workload (patterns times scan chain length) per io pair; regions without such a cut stay whole
+// regions has room for one region per io pair; the io pair list of every region is allocated here and released by the caller
+
+int partition_mesh_regions (NoC_design *design, Mesh_region *regions) {
+
+    Mesh_region *region;
+    int num_regions = 1;
+    int r = 0;
+    int core = 0;
+    int side = 0;
+    int ok = 0;
+    int num_pairs[2];                          // IO pairs on either side of a cut
+    int num_cells[2];                          // Cores on either side of a cut
+    double workload[2];                        // Test workload on either side of a cut
+    double balance = 0.0;                      // Larger workload per io pair of the two sides
+    double best_balance = 0.0;
+    int best_vertical = 0;
+    int best_cut = 0;                          // Best cut of the region (0 --> none)
+    double best_workload[2];
+    int j = 0;
+
+    regions[0].row0 = 0;
+    regions[0].col0 = 0;
+    regions[0].rows = design->M_rows;
+    regions[0].cols = design->N_columns;
+    regions[0].num_io_pairs = design->num_io_pairs;
+    regions[0].workload = 0.0;
+    regions[0].io_pairs = (int *) malloc (design->num_io_pairs * sizeof (int));
+    for (int k = 0; k < design->num_io_pairs; k++)
+        regions[0].io_pairs[k] = k + 1;
+    for (int i = 0; i < design->num_cores; i++)
+        if (design->noc_nodes[i].core_type == TEST_CORE)
+            regions[0].workload += (double) design->noc_nodes[i].test_patterns * design->noc_nodes[i].scan_chain_length;
+
+    while (r < num_regions) {
+        region = &regions[r];
+        best_cut = 0;
+
+        for (int vertical = 0; vertical <= 1 && region->num_io_pairs > 1; vertical++) {
+            for (int cut = 1; cut < (vertical ? region->cols : region->rows); cut++) {
+                num_pairs[0] = num_pairs[1] = 0;
+                num_cells[0] = num_cells[1] = 0;
+                workload[0] = workload[1] = 0.0;
+
+                ok = 1;
+                for (int k = 0; k < region->num_io_pairs && ok; k++) {
+                    side = find_region_side (design, region, vertical, cut, design->io_pairs[region->io_pairs[k] - 1].input_core_no);
+                    ok = (side == find_region_side (design, region, vertical, cut, design->io_pairs[region->io_pairs[k] - 1].output_core_no));
+                    num_pairs[side]++;
+                }
+                for (int i = 0; i < region->rows * region->cols && ok; i++) {
+                    core = (region->row0 + i / region->cols) * design->N_columns + region->col0 + i % region->cols + 1;
+                    side = find_region_side (design, region, vertical, cut, core);
+                    num_cells[side]++;
+                    if (design->noc_nodes[core - 1].core_type == TEST_CORE)
+                        workload[side] += (double) design->noc_nodes[core - 1].test_patterns * design->noc_nodes[core - 1].scan_chain_length;
+                }
+                if (!ok || num_pairs[0] == 0 || num_pairs[1] == 0 || num_cells[0] - 2 * num_pairs[0] < 1 || num_cells[1] - 2 * num_pairs[1] < 1)
+                    continue;
+
+                balance = max(workload[0] / num_pairs[0], workload[1] / num_pairs[1]);
+                if (best_cut == 0 || balance < best_balance) {
+                    best_balance = balance;
+                    best_vertical = vertical;
+                    best_cut = cut;
+                    best_workload[0] = workload[0];
+                    best_workload[1] = workload[1];
+                }
+            }
+        }
+
+        if (best_cut == 0) {
+            r++;
+            continue;
+        }
+
+        // The far side becomes a new region, the near side stays in place (and may be cut again)
+        regions[num_regions] = *region;
+        if (best_vertical) {
+            regions[num_regions].col0 = region->col0 + best_cut;
+            regions[num_regions].cols = region->cols - best_cut;
+            region->cols = best_cut;
+        }
+        else {
+            regions[num_regions].row0 = region->row0 + best_cut;
+            regions[num_regions].rows = region->rows - best_cut;
+            region->rows = best_cut;
+        }
+        region->workload = best_workload[0];
+        regions[num_regions].workload = best_workload[1];
+
+        // Share out the io pairs -- the near side now ends where the far side starts
+        regions[num_regions].io_pairs = (int *) malloc (region->num_io_pairs * sizeof (int));
+        regions[num_regions].num_io_pairs = 0;
+        j = 0;
+        for (int k = 0; k < region->num_io_pairs; k++) {
+            if (find_region_side (design, &regions[num_regions], best_vertical, 0, design->io_pairs[region->io_pairs[k] - 1].input_core_no))
+                regions[num_regions].io_pairs[regions[num_regions].num_io_pairs++] = region->io_pairs[k];
+            else
+                region->io_pairs[j++] = region->io_pairs[k];
+        }
+        region->num_io_pairs = j;
+        num_regions++;
+    }
+
+    return num_regions;
+}
+
+// Number of a core of the whole mesh within a region
+
+static int find_region_core (NoC_design *design, Mesh_region *region, int core) {
+    return ((core - 1) / design->N_columns - region->row0) * region->cols + ((core - 1) % design->N_columns - region->col0) + 1;
+}
+
+// Builds the design of a region -- its cores and io pairs renumbered within the region, with the parameters of the whole mesh
+
+static void build_region_design (NoC_design *design, Mesh_region *region) {
+    NoC_design *local = &region->design;
+    int core = 0;
+
+    local->M_rows = region->rows;
+    local->N_columns = region->cols;
+    local->num_cores = region->rows * region->cols;
+    local->num_io_pairs = region->num_io_pairs;
+    local->num_test_cores = local->num_cores - 2 * local->num_io_pairs;
+    local->noc_nodes = (NoC_node *) calloc (local->num_cores, sizeof (NoC_node));
+    local->io_pairs = (IO_pairs *) malloc (local->num_io_pairs * sizeof (IO_pairs));
+    region->core_map = (int *) malloc (local->num_cores * sizeof (int));
+
+    initialize_nodes (local->noc_nodes, local->num_cores, local->M_rows, local->N_columns);
+    for (int i = 0; i < local->num_cores; i++) {
+        core = (region->row0 + i / region->cols) * design->N_columns + region->col0 + i % region->cols + 1;
+        region->core_map[i] = core;
+        local->noc_nodes[i].core_type = design->noc_nodes[core - 1].core_type;
+        local->noc_nodes[i].test_patterns = design->noc_nodes[core - 1].test_patterns;
+        local->noc_nodes[i].scan_chain_length = design->noc_nodes[core - 1].scan_chain_length;
+    }
+    for (int k = 0; k < local->num_io_pairs; k++) {
+        local->io_pairs[k].io_pair_no = k + 1;
+        local->io_pairs[k].input_core_no = find_region_core (design, region, design->io_pairs[region->io_pairs[k] - 1].input_core_no);
+        local->io_pairs[k].output_core_no = find_region_core (design, region, design->io_pairs[region->io_pairs[k] - 1].output_core_no);
+        local->io_pairs[k].io_head = create_IO_list_head ();
+    }
+}
+
+// Hierarchical mode thread -- schedules regions until none is left
+
+static void *region_worker (void *arg) {
+    Region_pool *pool = (Region_pool *) arg;
+    Mesh_region *region;
+    int r = 0;
+
+    while (1) {
+        pthread_mutex_lock (&pool->lock);
+        r = pool->next_region++;
+        pthread_mutex_unlock (&pool->lock);
+        if (r >= pool->num_regions)
+            break;
+
+        region = &pool->regions[r];
+        region->testtime = run_search_engine (region->design.noc_nodes, region->design.num_cores, region->design.M_rows, region->context.freq,
+                                              region->context.num_freq, region->design.io_pairs, region->design.num_io_pairs, &region->context);
+    }
+    return NULL;
+}
+
+// Hierarchical mode: schedules every region of the mesh with the selected engine in parallel, merges the region schedules by starttime
+// and repairs the merged mapping by local search on the whole mesh, returns the total testtime of the best mapping found
+// Routes between the cores of a region stay inside it (minimal routes keep to the bounding box of their ends), so the region
+// schedules only meet where resumed segments move to the io pairs of other regions; the merged mapping is evaluated on the whole mesh,
+// which serializes those conflicts, and the local search then repairs the order and io pairs around them
+
+double region_decomposed_search (Search_problem *problem, Genome *best) {
+
+    PSO_context *context = problem->context;
+    NoC_design design;                                         // The whole mesh as a design
+    Mesh_region *regions;                                      // Regions of the mesh
+    Region_pool pool;                                          // Regions handed out to the threads
+    Table_cache table_cache;                                   // Route and testtime tables of the regions
+    pthread_t *threads;                                        // Region threads
+    Region_test *tests;                                        // Tests of all region schedules, region by region in mapping order
+    int *first_test;                                           // [r]: first test of region r in tests (num_regions + 1)
+    int *next_test;                                            // [r]: next test of region r to be merged
+    int next_region = 0;                                       // Region whose next test starts first
+    Gbest_PSO_particle merged;                                 // Merged mapping of the whole mesh
+    Eval_state *state;
+    Mesh_region *region;
+    int num_regions = 0;
+    int num_workers = 0;
+    int num_tests = 0;
+    int position = 0;
+    double longest = 0.0;                                      // Total testtime of the slowest region
+
+    design.M_rows = problem->num_cores / problem->N_columns;
+    design.N_columns = problem->N_columns;
+    design.num_cores = problem->num_cores;
+    design.num_io_pairs = problem->num_io_pairs;
+    design.num_test_cores = problem->num_test_cores;
+    design.noc_nodes = problem->noc_nodes;
+    design.io_pairs = problem->io_pairs;
+
+    // A region holds at least one io pair
+    regions = (Mesh_region *) malloc (design.num_io_pairs * sizeof (Mesh_region));
+    num_regions = partition_mesh_regions (&design, regions);
+    init_table_cache (&table_cache);
+
+    if (context->out_file != NULL)
+        fprintf(context->out_file, " Hierarchical mode: %d regions, %s search per region\n", num_regions, find_search_engine_name (context->engine));
+
+    // Every region is a silent run of its own, seeded from the run's random stream in region order
+    for (int r = 0; r < num_regions; r++) {
+        region = &regions[r];
+        build_region_design (&design, region);
+
+        region->context = *context;
+        region->context.out_file = NULL;
+        region->context.hierarchical = 0;
+        // Torus wraparound links leave the region, its routes are taken from the mesh inside it
+        if (region->context.routing == ROUTING_TORUS)
+            region->context.routing = ROUTING_XY;
+        region->context.testtime_table = acquire_testtime_table (&table_cache, &region->design, region->context.routing);
+        region->context.route_table = region->context.testtime_table->route_table;
+        region->context.arena = NULL;
+        region->context.profile = NULL;
+        region->context.profile_file = NULL;
+        region->context.warm_start_file = NULL;
+        region->context.num_threads = 1;
+        region->context.checkpoint_file = NULL;
+        region->context.checkpoint_interval = 0;
+        region->context.resume_file = NULL;
+        region->context.validate = 0;
+        region->context.check = 0;
+        region->context.export_format = EXPORT_NONE;
+        region->context.num_full_evaluations = 0;
+        region->context.num_delta_evaluations = 0;
+        region->context.num_dominated_evaluations = 0;
+        init_genome (&region->best, region->design.num_test_cores);
+        region->context.best_mapping = &region->best;
+        seed_pso_context (&region->context, (unsigned int) nrand48 (context->rng_state));
+    }
+
+    pool.regions = regions;
+    pool.num_regions = num_regions;
+    pool.next_region = 0;
+    pthread_mutex_init (&pool.lock, NULL);
+    num_workers = (context->num_threads > 0 && context->num_threads < num_regions) ? context->num_threads : num_regions;
+    threads = (pthread_t *) malloc (num_workers * sizeof (pthread_t));
+    for (int w = 0; w < num_workers; w++)
+        pthread_create (&threads[w], NULL, region_worker, &pool);
+    for (int w = 0; w < num_workers; w++)
+        pthread_join (threads[w], NULL);
+    pthread_mutex_destroy (&pool.lock);
+    free (threads);
+
+    tests = (Region_test *) malloc (problem->num_test_cores * sizeof (Region_test));
+    first_test = (int *) malloc ((num_regions + 1) * sizeof (int));
+    next_test = (int *) malloc (num_regions * sizeof (int));
+
+    // Merge: the region mappings interleaved by the starttimes of their tests -- each region keeps its own order, which its schedule
+    // depends on, and among the regions the test that starts first goes first
+    for (int r = 0; r < num_regions; r++) {
+        region = &regions[r];
+        first_test[r] = num_tests;
+        next_test[r] = num_tests;
+        state = create_eval_state (region->design.noc_nodes, region->design.N_columns, region->design.num_cores, region->design.io_pairs,
+                                   region->design.num_io_pairs, &region->context, 0);
+        evaluate_from (state, &region->best, 0, NO_CUTOFF);
+        for (int i = 0; i < region->design.num_test_cores; i++) {
+            tests[num_tests].starttime = state->starttime[i];
+            tests[num_tests].region = r;
+            tests[num_tests].position = i;
+            num_tests++;
+        }
+        free_eval_state (state);
+
+        if (context->out_file != NULL)
+            fprintf(context->out_file, " Region %d: rows %d-%d, columns %d-%d, %d io pairs, %d test cores, testtime %lf\n", r + 1, region->row0, region->row0 + region->rows - 1,
+                    region->col0, region->col0 + region->cols - 1, region->num_io_pairs, region->design.num_test_cores, region->testtime);
+        longest = max(longest, region->testtime);
+        context->num_full_evaluations += region->context.num_full_evaluations;
+        context->num_delta_evaluations += region->context.num_delta_evaluations;
+        context->num_dominated_evaluations += region->context.num_dominated_evaluations;
+        context->stopped_early |= region->context.stopped_early;
+    }
+
+    first_test[num_regions] = num_tests;
+    init_genome (&merged.gbest_mapping, problem->num_test_cores);
+
+    for (int t = 0; t < num_tests; t++) {
+        next_region = -1;
+        for (int r = 0; r < num_regions; r++)
+            if (next_test[r] < first_test[r + 1] && (next_region < 0 || tests[next_test[r]].starttime < tests[next_test[next_region]].starttime))
+                next_region = r;
+
+        region = &regions[next_region];
+        position = tests[next_test[next_region]++].position;
+        merged.gbest_mapping.test_core[t] = (short) region->core_map[region->best.test_core[position] - 1];
+        merged.gbest_mapping.io_pair[t] = (unsigned char) region->io_pairs[region->best.io_pair[position] - 1];
+        merged.gbest_mapping.freq_index[t] = region->best.freq_index[position];
+        merged.gbest_mapping.preemption[t] = region->best.preemption[position];
+    }
+
+    // Repair: the merged mapping on the whole mesh, then local search on it
+    state = create_eval_state (problem->noc_nodes, problem->N_columns, problem->num_cores, problem->io_pairs, problem->num_io_pairs, context, 0);
+    merged.gbest_fitness = evaluate_from (state, &merged.gbest_mapping, 0, NO_CUTOFF);
+    free_eval_state (state);
+    if (context->out_file != NULL)
+        fprintf(context->out_file, " Merged schedule: %lf (slowest region %lf)\n", merged.gbest_fitness, longest);
+    note_search_progress (problem, merged.gbest_fitness);
+
+    refine_global_best ((&merged), problem->noc_nodes, problem->N_columns, problem->num_cores, problem->io_pairs, problem->num_io_pairs, context);
+    note_search_progress (problem, merged.gbest_fitness);
+
+    copy_genome (best, &merged.gbest_mapping);
+    free_genome (&merged.gbest_mapping);
+    free (tests);
+    free (first_test);
+    free (next_test);
+
+    for (int r = 0; r < num_regions; r++) {
+        free_genome (&regions[r].best);
+        free (regions[r].io_pairs);
+        free (regions[r].core_map);
+        release_testtime_table (&table_cache, regions[r].context.testtime_table);
+        free_noc_design (&regions[r].design);
+    }
+    free_table_cache (&table_cache);
+    free (regions);
+    return merged.gbest_fitness;
+}
+
+// ==========
+// BATCH MODE
+// ==========
+
+// Reads the batch manifest (one "<input file> [output file]" entry per line) and returns the number of jobs read (-1 on error)
+// Blank lines and lines starting with '#' are ignored; the output file defaults to "<input file>.out"
+
+int read_batch_manifest (const char *manifest_file, Batch_job **jobs) {
+
+    FILE *fptr;                                  // Manifest file pointer
+    char line[2 * MAX_PATH_LENGTH + 16];         // Current manifest line
+    char input_file[MAX_PATH_LENGTH];            // Input file of the current entry
+    char output_file[MAX_PATH_LENGTH];           // Output file of the current entry
+    int num_fields = 0;                          // Number of fields read from the current line
+    int num_jobs = 0;                            // Number of jobs read so far
+    int capacity = 16;                           // Allocated size of the jobs array
+    struct stat file_stat;
+
+    fptr = fopen (manifest_file, "r");
+    if (fptr == NULL)
+        return -1;
+
+    *jobs = (Batch_job *) malloc (capacity * sizeof (Batch_job));
+
+    while (fgets (line, sizeof (line), fptr) != NULL) {
+        num_fields = sscanf (line, "%511s %511s", input_file, output_file);
+        if (num_fields < 1 || input_file[0] == '#')
+            continue;
+
+        if (num_jobs == capacity) {
+            capacity *= 2;
+            *jobs = (Batch_job *) realloc (*jobs, capacity * sizeof (Batch_job));
+        }
+
+        snprintf ((*jobs)[num_jobs].input_file, MAX_PATH_LENGTH, "%s", input_file);
+        if (num_fields == 2)
+            snprintf ((*jobs)[num_jobs].output_file, MAX_PATH_LENGTH, "%s", output_file);
+        else
+            snprintf ((*jobs)[num_jobs].output_file, MAX_PATH_LENGTH, "%.507s.out", input_file);
+
+        // The description size is a cheap proxy for the job size (number of cores)
+        (*jobs)[num_jobs].cost = (stat (input_file, &file_stat) == 0) ? (long) file_stat.st_size : 0;
+        (*jobs)[num_jobs].status = 0;
+        num_jobs++;
+    }
+
+    fclose (fptr);
+    return num_jobs;
+}
+
+// Pops the newest job from a worker's own deque (-1 if the deque is empty)
+
+static int pop_own_job (Work_deque *deque) {
+    int job = -1;
+
+    pthread_mutex_lock (&deque->lock);
+    if (deque->bottom > deque->top) {
+        deque->bottom--;
+        job = deque->job_idx[deque->bottom];
+    }
+    pthread_mutex_unlock (&deque->lock);
+
+    return job;
+}
+
+// Steals the oldest job from another worker's deque (-1 if the deque is empty)
+
+static int steal_job (Work_deque *deque) {
+    int job = -1;
+
+    pthread_mutex_lock (&deque->lock);
+    if (deque->bottom > deque->top) {
+        job = deque->job_idx[deque->top];
+        deque->top++;
+    }
+    pthread_mutex_unlock (&deque->lock);
+
+    return job;
+}
+
+// Schedules a single batch job and writes its result file
+
+static void run_batch_job (Batch_pool *pool, Batch_job *job) {
+
+    NoC_design design;                           // Parsed SoC description of the job
+    PSO_context context = *pool->settings;       // Per-job PSO settings and random state
+    char checkpoint_file[MAX_PATH_LENGTH + 8];   // Per-job checkpoint file
+    char export_file[MAX_PATH_LENGTH + 8];       // Per-job schedule export file
+    char profile_file[MAX_PATH_LENGTH + 8];      // Per-job folded stacks file (profiling builds)
+    char warm_start_file[MAX_PATH_LENGTH + 8];   // Per-job binary schedule of the previous batch run
+    double testtime = 0.0;                       // Total testtime of the job's best schedule
+
+    // Designs that do not fit the scheduler are rejected here and fail only their own job
+    if (read_noc_design (job->input_file, &design) != 0) {
+        fprintf(stderr, " ERROR: Could not read the input file %s (missing, malformed or too large a design)\n", job->input_file);
+        job->status = -1;
+        return;
+    }
+
+    context.out_file = fopen (job->output_file, "w");
+    if (context.out_file == NULL) {
+        fprintf(stderr, " ERROR: Could not open the output file %s\n", job->output_file);
+        free_noc_design (&design);
+        job->status = -1;
+        return;
+    }
+
+    context.testtime_table = acquire_testtime_table (pool->table_cache, &design, context.routing);
+    context.route_table = context.testtime_table->route_table;
+    seed_pso_context (&context, job->seed);
+
+    // Jobs already run in parallel, the exact solver explores each one on a single thread
+    context.num_threads = 1;
+
+    // With checkpointing enabled, every job checkpoints next to its output file and picks up from there when the batch is rerun
+    if (context.checkpoint_interval > 0) {
+        snprintf (checkpoint_file, sizeof (checkpoint_file), "%s.ckpt", job->output_file);
+        context.checkpoint_file = checkpoint_file;
+        context.resume_file = checkpoint_file;
+    }
+    else {
+        context.checkpoint_file = NULL;
+        context.resume_file = NULL;
+    }
+
+    // Exported schedules also go next to the output file
+    if (context.export_format != EXPORT_NONE) {
+        snprintf (export_file, sizeof (export_file), "%s.%s", job->output_file, find_export_extension (context.export_format));
+        context.export_file = export_file;
+    }
+
+    // A warm-started batch starts every job from the binary schedule the previous run exported next to its output file
+    if (context.warm_start_file != NULL) {
+        snprintf (warm_start_file, sizeof (warm_start_file), "%s.nocs", job->output_file);
+        context.warm_start_file = warm_start_file;
+    }
+
+    // So do the folded stacks of profiled runs
+    if (context.profile_file != NULL) {
+        snprintf (profile_file, sizeof (profile_file), "%s.folded", job->output_file);
+        context.profile_file = profile_file;
+    }
+
+    testtime = run_search_engine (design.noc_nodes, design.num_cores, design.M_rows, pool->freq, pool->num_freq, design.io_pairs, design.num_io_pairs, &context);
+
+    // A search that ends without a complete schedule fails the job (NaN included)
+    if (!(testtime < NO_CUTOFF)) {
+        fprintf(stderr, " ERROR: No schedule found for %s\n", job->input_file);
+        job->status = -1;
+    }
+
+    // The job is complete -- a rerun of the batch starts it from scratch
+    if (context.checkpoint_interval > 0)
+        remove (checkpoint_file);
+
+    release_testtime_table (pool->table_cache, context.testtime_table);
+    fclose (context.out_file);
+    free_noc_design (&design);
+}
+
+// Batch worker -- drains its own deque first, then steals from the other workers until no work is left anywhere
+
+static void *batch_worker (void *arg) {
+
+    Batch_worker *worker = (Batch_worker *) arg;
+    Batch_pool *pool = worker->pool;
+    int job = 0;
+
+    while (1) {
+        job = pop_own_job (&pool->deques[worker->worker_no]);
+
+        // Own deque is empty -- try every other worker, starting with the next one
+        for (int k = 1; job < 0 && k < pool->num_workers; k++)
+            job = steal_job (&pool->deques[(worker->worker_no + k) % pool->num_workers]);
+
+        // Jobs never spawn new jobs, so once all deques are empty the batch is done
+        if (job < 0)
+            break;
+
+        // After a stop request the running jobs report their best schedules, queued jobs are not started
+        if (pool->settings->stop_requested != NULL && *pool->settings->stop_requested) {
+            pool->jobs[job].status = -1;
+            continue;
+        }
+
+        run_batch_job (pool, &pool->jobs[job]);
+    }
+
+    return NULL;
+}
+
+// Orders jobs by decreasing estimated cost
+
+static int compare_job_cost (const void *a, const void *b) {
+    long cost_a = ((const Batch_job *) a)->cost;
+    long cost_b = ((const Batch_job *) b)->cost;
+    return (cost_a < cost_b) - (cost_a > cost_b);
+}
+
+// Schedules all jobs of a batch concurrently on a work-stealing pool of num_workers threads
+
+int run_batch (Batch_job *jobs, int num_jobs, int num_workers, double *freq, int num_freq, PSO_context *settings) {
+
+    Batch_pool pool;                             // Work-stealing pool
+    Table_cache table_cache;                     // Route and testtime tables shared among the jobs
+    pthread_t threads[MAX_BATCH_THREADS];        // Worker threads
+    Batch_worker workers[MAX_BATCH_THREADS];     // Worker arguments
+    int num_failed = 0;                          // Number of jobs that could not be scheduled
+
+    if (num_workers < 1)
+        num_workers = 1;
+    if (num_workers > MAX_BATCH_THREADS)
+        num_workers = MAX_BATCH_THREADS;
+    if (num_workers > num_jobs)
+        num_workers = num_jobs;
+
+    init_table_cache (&table_cache);
+    pool.jobs = jobs;
+    pool.num_jobs = num_jobs;
+    pool.num_workers = num_workers;
+    pool.table_cache = &table_cache;
+    pool.freq = freq;
+    pool.num_freq = num_freq;
+    pool.settings = settings;
+    pool.deques = (Work_deque *) malloc (num_workers * sizeof (Work_deque));
+
+    for (int w = 0; w < num_workers; w++) {
+        pool.deques[w].job_idx = (int *) malloc (num_jobs * sizeof (int));
+        pool.deques[w].top = 0;
+        pool.deques[w].bottom = 0;
+        pthread_mutex_init (&pool.deques[w].lock, NULL);
+    }
+
+    // Deal the jobs round-robin in decreasing order of cost so every worker starts with a similar share
+    // The owner pops from the bottom, so each deque is filled cheapest-first: owners start with their
+    // largest job and thieves take the small leftovers
+    qsort (jobs, num_jobs, sizeof (Batch_job), compare_job_cost);
+
+    for (int i = num_jobs - 1; i >= 0; i--) {
+        Work_deque *deque = &pool.deques[i % num_workers];
+        deque->job_idx[deque->bottom++] = i;
+    }
+
+    for (int w = 0; w < num_workers; w++) {
+        workers[w].pool = &pool;
+        workers[w].worker_no = w;
+        pthread_create (&threads[w], NULL, batch_worker, &workers[w]);
+    }
+    for (int w = 0; w < num_workers; w++)
+        pthread_join (threads[w], NULL);
+
+    for (int i = 0; i < num_jobs; i++)
+        if (jobs[i].status != 0)
+            num_failed++;
+
+    for (int w = 0; w < num_workers; w++) {
+        free (pool.deques[w].job_idx);
+        pthread_mutex_destroy (&pool.deques[w].lock);
+    }
+    free (pool.deques);
+    free_table_cache (&table_cache);
+
+    return num_failed;
+}
+
+
+// ============
+// IO PLACEMENT
+// ============
+
+// Moves the io pairs of a design to the given placement; the test core parameters go to the remaining cores in their previous order
+// (the design becomes the one read from an input file listing the placed io pairs)
+
+void apply_io_placement (NoC_design *design, IO_placement *placement) {
+
+    int *test_patterns = (int *) malloc (design->num_cores * sizeof (int));         // Test core parameters in increasing core number
+    int *scan_chain_length = (int *) malloc (design->num_cores * sizeof (int));
+    int num_test_cores = 0;
+
+    for (int i = 0; i < design->num_cores; i++) {
+        if (design->noc_nodes[i].core_type == TEST_CORE) {
+            test_patterns[num_test_cores] = design->noc_nodes[i].test_patterns;
+            scan_chain_length[num_test_cores] = design->noc_nodes[i].scan_chain_length;
+            num_test_cores++;
+        }
+    }
+
+    initialize_nodes (design->noc_nodes, design->num_cores, design->M_rows, design->N_columns);
+    for (int k = 0; k < design->num_io_pairs; k++) {
+        design->noc_nodes[placement->io_cores[2 * k] - 1].core_type = INPUT_CORE;
+        design->noc_nodes[placement->io_cores[2 * k + 1] - 1].core_type = OUTPUT_CORE;
+        design->io_pairs[k].io_pair_no = k + 1;
+        design->io_pairs[k].input_core_no = placement->io_cores[2 * k];
+        design->io_pairs[k].output_core_no = placement->io_cores[2 * k + 1];
+    }
+
+    num_test_cores = 0;
+    for (int i = 0; i < design->num_cores; i++) {
+        if (design->noc_nodes[i].core_type == TEST_CORE) {
+            design->noc_nodes[i].test_patterns = test_patterns[num_test_cores];
+            design->noc_nodes[i].scan_chain_length = scan_chain_length[num_test_cores];
+            num_test_cores++;
+        }
+        else {
+            design->noc_nodes[i].test_patterns = 0;
+            design->noc_nodes[i].scan_chain_length = 0;
+        }
+    }
+
+    free (test_patterns);
+    free (scan_chain_length);
+}
+
+// Allocates the io cores of a placement of num_io_pairs io pairs (released by free_io_placement)
+
+void init_io_placement (IO_placement *placement, int num_io_pairs) {
+    placement->num_io_pairs = num_io_pairs;
+    placement->io_cores = (int *) malloc (2 * num_io_pairs * sizeof (int));
+}
+
+// Copies placement src into dst (allocated for the same number of io pairs)
+
+static void copy_io_placement (IO_placement *dst, IO_placement *src) {
+    memcpy (dst->io_cores, src->io_cores, 2 * src->num_io_pairs * sizeof (int));
+}
+
+// Releases the io cores of a placement
+
+void free_io_placement (IO_placement *placement) {
+    free (placement->io_cores);
+    placement->io_cores = NULL;
+}
+
+// Puts the io pairs of a placement in increasing order of input core
+
+static void sort_io_placement (IO_placement *placement, int num_io_pairs) {
+    int input_core = 0;
+    int output_core = 0;
+    int j = 0;
+
+    for (int i = 1; i < num_io_pairs; i++) {
+        input_core = placement->io_cores[2 * i];
+        output_core = placement->io_cores[2 * i + 1];
+        for (j = i; j > 0 && placement->io_cores[2 * (j - 1)] > input_core; j--) {
+            placement->io_cores[2 * j] = placement->io_cores[2 * (j - 1)];
+            placement->io_cores[2 * j + 1] = placement->io_cores[2 * (j - 1) + 1];
+        }
+        placement->io_cores[2 * j] = input_core;
+        placement->io_cores[2 * j + 1] = output_core;
+    }
+}
+
+// Hash of a placement (FNV-1a over its io cores)
+
+static unsigned int hash_io_placement (IO_placement *placement, int num_io_pairs) {
+    unsigned int hash = 2166136261u;
+
+    for (int i = 0; i < 2 * num_io_pairs; i++) {
+        hash ^= (unsigned int) placement->io_cores[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Cache slot of a placement -- the slot holding it, or the free slot it goes to (NULL if the cache is full)
+
+static Placement_entry *find_placement_entry (Placement_search *search, IO_placement *placement) {
+    int num_io_pairs = search->design->num_io_pairs;
+    unsigned int slot = hash_io_placement (placement, num_io_pairs);
+    Placement_entry *entry;
+
+    for (int probe = 0; probe < PLACEMENT_CACHE_SIZE; probe++) {
+        entry = &search->cache[(slot + probe) & (PLACEMENT_CACHE_SIZE - 1)];
+        if (!entry->used || memcmp (entry->placement.io_cores, placement->io_cores, 2 * num_io_pairs * sizeof (int)) == 0)
+            return entry;
+    }
+    return NULL;
+}
+
+// Stores the score of a placement in its cache slot
+
+static void store_placement_entry (Placement_entry *entry, IO_placement *placement, int pruned, double testtime) {
+    if (!entry->used)
+        init_io_placement (&entry->placement, placement->num_io_pairs);
+    copy_io_placement (&entry->placement, placement);
+    entry->used = 1;
+    entry->pruned = pruned;
+    entry->testtime = testtime;
+}
+
+// Builds a copy of the design with the io pairs at the given placement (own nodes, io pairs and IO schedule lists)
+
+static void build_placed_design (NoC_design *design, IO_placement *placement, NoC_design *placed) {
+    *placed = *design;
+    placed->noc_nodes = (NoC_node *) malloc (design->num_cores * sizeof (NoC_node));
+    placed->io_pairs = (IO_pairs *) malloc (design->num_io_pairs * sizeof (IO_pairs));
+    memcpy (placed->noc_nodes, design->noc_nodes, design->num_cores * sizeof (NoC_node));
+    for (int k = 0; k < design->num_io_pairs; k++)
+        placed->io_pairs[k].io_head = create_IO_list_head ();
+    apply_io_placement (placed, placement);
+}
+
+// Scores a candidate placement: rules it out if its lower bounds already reach the cutoff, otherwise runs a short silent search on it
+// Returns the best total testtime found (the lower bound if ruled out) and sets *pruned accordingly
+// The inner search is seeded from the placement, so a placement scores the same whichever thread or round scores it
+
+static double score_io_placement (Placement_search *search, IO_placement *placement, int *pruned) {
+    NoC_design design;                           // Design with the candidate placement
+    PSO_context context = *search->settings;     // Settings of the inner search
+    double testtime = 0.0;
+
+    build_placed_design (search->design, placement, &design);
+
+    context.out_file = NULL;
+    context.testtime_table = acquire_testtime_table (&search->table_cache, &design, context.routing);
+    context.route_table = context.testtime_table->route_table;
+    context.arena = NULL;
+    context.profile = NULL;
+    context.profile_file = NULL;
+    context.warm_start_file = NULL;
+    context.best_mapping = NULL;
+    context.num_threads = 1;
+    context.max_generations = search->generations;
+    context.time_limit = 0.0;
+    context.checkpoint_file = NULL;
+    context.checkpoint_interval = 0;
+    context.resume_file = NULL;
+    context.validate = 0;
+    context.check = 0;
+    context.export_format = EXPORT_NONE;
+    context.num_full_evaluations = 0;
+    context.num_delta_evaluations = 0;
+    context.num_dominated_evaluations = 0;
+    seed_pso_context (&context, search->seed + hash_io_placement (placement, design.num_io_pairs));
+
+    // No schedule of the placement can beat its lower bounds
+    compute_lower_bounds (design.noc_nodes, design.N_columns, design.num_cores, design.io_pairs, design.num_io_pairs, search->freq, search->num_freq, &context);
+    *pruned = (context.lower_bounds.best >= search->cutoff);
+    if (*pruned)
+        testtime = context.lower_bounds.best;
+    else
+        testtime = run_search_engine (design.noc_nodes, design.num_cores, design.M_rows, search->freq, search->num_freq, design.io_pairs, design.num_io_pairs, &context);
+
+    release_testtime_table (&search->table_cache, context.testtime_table);
+    free_noc_design (&design);
+    return testtime;
+}
+
+// Placement search thread -- scores candidates of the current round until none is left
+
+static void *placement_worker (void *arg) {
+    Placement_search *search = (Placement_search *) arg;
+    int c = 0;
+
+    while (1) {
+        pthread_mutex_lock (&search->lock);
+        c = search->next_candidate++;
+        pthread_mutex_unlock (&search->lock);
+        if (c >= search->num_candidates)
+            break;
+
+        search->testtimes[c] = score_io_placement (search, &search->candidates[c], &search->pruned[c]);
+    }
+    return NULL;
+}
+
+// Applies move m of the neighbourhood of a placement (m < 2 * num_io_pairs * num_cores: io core m / num_cores moves to core
+// m % num_cores + 1, otherwise the input and output core of io pair m - 2 * num_io_pairs * num_cores + 1 swap), returns 0 if the
+// move is not possible (the target core is an io core)
+
+static int move_io_placement (IO_placement *placement, int num_io_pairs, int num_cores, int m) {
+    int io_core = m / num_cores;
+    int target = m % num_cores + 1;
+    int temp = 0;
+
+    if (m >= 2 * num_io_pairs * num_cores) {
+        io_core = 2 * (m - 2 * num_io_pairs * num_cores);
+        temp = placement->io_cores[io_core];
+        placement->io_cores[io_core] = placement->io_cores[io_core + 1];
+        placement->io_cores[io_core + 1] = temp;
+        sort_io_placement (placement, num_io_pairs);
+        return 1;
+    }
+
+    for (int i = 0; i < 2 * num_io_pairs; i++)
+        if (placement->io_cores[i] == target)
+            return 0;
+    placement->io_cores[io_core] = target;
+    sort_io_placement (placement, num_io_pairs);
+    return 1;
+}
+
+// Searches for the io pair placement with the shortest total testtime -- hill climbing from the placement of the input file
+// Every round takes up to PLACEMENT_CANDIDATES neighbours not scored before (all of them if the neighbourhood is that small, a random
+// sample otherwise) and scores them on num_threads threads, each with a short inner search of the given number of generations.
+// Neighbours whose lower bounds reach the best testtime so far are ruled out without a search. The search moves to the best neighbour
+// if it improves on the current placement; it ends at a local optimum, after PLACEMENT_PATIENCE sampled rounds without improvement,
+// after max_rounds rounds, or on a stop request
+// Returns the best total testtime of the inner searches and leaves the best placement in best (allocated for the design's io pairs)
+
+double search_io_placement (NoC_design *design, double *freq, int num_freq, PSO_context *settings, int num_threads, int max_rounds, int generations,
+                            unsigned int seed, IO_placement *best) {
+
+    Placement_search search;                                       // Shared state of the scoring threads
+    pthread_t threads[MAX_BATCH_THREADS];                          // Scoring threads
+    IO_placement current;                                          // Best placement so far (the search moves from there)
+    IO_placement candidate;
+    Placement_entry *entry;
+    unsigned short rng_state[3];                                   // Random state of the neighbourhood samples
+    int *moves;                                                    // Moves of the neighbourhood, sampled moves first
+    int num_io_pairs = design->num_io_pairs;
+    int num_cores = design->num_cores;
+    int num_moves = 2 * num_io_pairs * num_cores + num_io_pairs;
+    int num_workers = 0;
+    int num_pruned = 0;                                            // Candidates of the round ruled out by their lower bounds
+    int sampled = 0;                                               // Set if the round left moves of the neighbourhood unscored
+    int stall = 0;                                                 // Sampled rounds in a row without improvement
+    int best_candidate = -1;                                       // Best candidate of the round that improves on the current placement
+    int i = 0;
+    int j = 0;
+    int temp = 0;
+    int pruned = 0;
+    double best_testtime = 0.0;                                    // Best total testtime so far (of the current placement)
+    double initial_testtime = 0.0;                                 // Total testtime of the placement of the input file
+    FILE *out_file = settings->out_file;
+
+    search.design = design;
+    search.freq = freq;
+    search.num_freq = num_freq;
+    search.settings = settings;
+    search.generations = (generations > 0) ? generations : PLACEMENT_GENERATIONS;
+    search.seed = seed;
+    search.cache = (Placement_entry *) calloc (PLACEMENT_CACHE_SIZE, sizeof (Placement_entry));
+    search.num_searches = 0;
+    search.num_hits = 0;
+    search.num_pruned = 0;
+    init_table_cache (&search.table_cache);
+    pthread_mutex_init (&search.lock, NULL);
+
+    if (num_threads < 1)
+        num_threads = 1;
+    if (num_threads > MAX_BATCH_THREADS)
+        num_threads = MAX_BATCH_THREADS;
+
+    rng_state[0] = 0x330E;
+    rng_state[1] = (unsigned short)(seed & 0xFFFF);
+    rng_state[2] = (unsigned short)(seed >> 16);
+
+    moves = (int *) malloc (num_moves * sizeof (int));
+    init_io_placement (&current, num_io_pairs);
+    init_io_placement (&candidate, num_io_pairs);
+    for (int c = 0; c < PLACEMENT_CANDIDATES; c++)
+        init_io_placement (&search.candidates[c], num_io_pairs);
+
+    // Start from the placement of the input file
+    for (int k = 0; k < num_io_pairs; k++) {
+        current.io_cores[2 * k] = design->io_pairs[k].input_core_no;
+        current.io_cores[2 * k + 1] = design->io_pairs[k].output_core_no;
+    }
+    sort_io_placement (&current, num_io_pairs);
+
+    if (out_file != NULL)
+        fprintf(out_file, " IO placement search: %d io pairs on %d cores, %s searches of %d generations, %d threads\n", num_io_pairs, num_cores,
+                find_search_engine_name (settings->engine), search.generations, num_threads);
+
+    search.cutoff = NO_CUTOFF;
+    best_testtime = score_io_placement (&search, &current, &pruned);
+    initial_testtime = best_testtime;
+    search.num_searches++;
+    store_placement_entry (find_placement_entry (&search, &current), &current, 0, best_testtime);
+    if (out_file != NULL)
+        fprintf(out_file, " Placement of the input file: %lf\n", best_testtime);
+
+    for (int round = 0; round < max_rounds; round++) {
+        if (settings->stop_requested != NULL && *settings->stop_requested)
+            break;
+
+        // Candidates: neighbours not scored before, in random order (partial Fisher-Yates shuffle of the moves)
+        for (i = 0; i < num_moves; i++)
+            moves[i] = i;
+        search.num_candidates = 0;
+        for (i = 0; i < num_moves && search.num_candidates < PLACEMENT_CANDIDATES; i++) {
+            j = i + nrand48 (rng_state) % (num_moves - i);
+            temp = moves[i];
+            moves[i] = moves[j];
+            moves[j] = temp;
+
+            copy_io_placement (&candidate, &current);
+            if (!move_io_placement (&candidate, num_io_pairs, num_cores, moves[i]))
+                continue;
+            entry = find_placement_entry (&search, &candidate);
+            if (entry != NULL && entry->used) {
+                search.num_hits++;
+                continue;
+            }
+            copy_io_placement (&search.candidates[search.num_candidates++], &candidate);
+        }
+        sampled = (i < num_moves);
+
+        // Every neighbour was scored before -- the current placement is a local optimum
+        if (search.num_candidates == 0)
+            break;
+
+        search.cutoff = best_testtime;
+        search.next_candidate = 0;
+        num_workers = (num_threads < search.num_candidates) ? num_threads : search.num_candidates;
+        for (int w = 0; w < num_workers; w++)
+            pthread_create (&threads[w], NULL, placement_worker, &search);
+        for (int w = 0; w < num_workers; w++)
+            pthread_join (threads[w], NULL);
+
+        // Results go to the cache in candidate order, so the search does not depend on which thread finished first
+        best_candidate = -1;
+        num_pruned = 0;
+        for (int c = 0; c < search.num_candidates; c++) {
+            entry = find_placement_entry (&search, &search.candidates[c]);
+            if (entry != NULL)
+                store_placement_entry (entry, &search.candidates[c], search.pruned[c], search.testtimes[c]);
+            if (search.pruned[c]) {
+                num_pruned++;
+                continue;
+            }
+            search.num_searches++;
+            if (search.testtimes[c] < ((best_candidate < 0) ? best_testtime : search.testtimes[best_candidate]))
+                best_candidate = c;
+        }
+        search.num_pruned += num_pruned;
+
+        if (out_file != NULL)
+            fprintf(out_file, " Placement round %d: %d candidates, %d ruled out by their lower bounds, best %lf\n", round + 1, search.num_candidates, num_pruned,
+                    (best_candidate >= 0) ? search.testtimes[best_candidate] : best_testtime);
+
+        if (best_candidate >= 0) {
+            copy_io_placement (&current, &search.candidates[best_candidate]);
+            best_testtime = search.testtimes[best_candidate];
+            stall = 0;
+        }
+        else if (!sampled || ++stall >= PLACEMENT_PATIENCE)
+            break;
+    }
+
+    if (out_file != NULL) {
+        fprintf(out_file, " Best placement: %lf (input file placement %lf), %ld inner searches, %ld cache hits, %ld ruled out by their lower bounds\n",
+                best_testtime, initial_testtime, search.num_searches, search.num_hits, search.num_pruned);
+        for (int k = 0; k < num_io_pairs; k++)
+            fprintf(out_file, "  IO pair %d: input core %d, output core %d\n", k + 1, current.io_cores[2 * k], current.io_cores[2 * k + 1]);
+        fprintf(out_file, "\n");
+    }
+
+    copy_io_placement (best, &current);
+
+    pthread_mutex_destroy (&search.lock);
+    free_table_cache (&search.table_cache);
+    for (int e = 0; e < PLACEMENT_CACHE_SIZE; e++)
+        if (search.cache[e].used)
+            free_io_placement (&search.cache[e].placement);
+    for (int c = 0; c < PLACEMENT_CANDIDATES; c++)
+        free_io_placement (&search.candidates[c]);
+    free_io_placement (&current);
+    free_io_placement (&candidate);
+    free (search.cache);
+    free (moves);
+    return best_testtime;
+}
+
+// ===================
+// SCHEDULE VALIDATION
+// ===================
+
+// Initializes an empty calendar queue for at most max_events pending events
+// Bucket count and width are sized from the expected number of events over the expected time span, so that every bucket holds
+// about one pending event and enqueue/dequeue stay O(1)
+
+void init_calendar_queue (Calendar_queue *queue, int max_events, long expected_events, double expected_span) {
+    queue->num_buckets = 1;
+    while (queue->num_buckets < 2 * max_events)
+        queue->num_buckets *= 2;
+
+    queue->bucket_width = (expected_events > 0 && expected_span > 0) ? 3.0 * expected_span / expected_events : 1.0;
+    queue->buckets = (Sim_event **) calloc (queue->num_buckets, sizeof (Sim_event *));
+    queue->current_bucket = 0;
+    queue->bucket_top = queue->bucket_width;
+    queue->size = 0;
+
+    // Events come from a fixed pool, so the replay does not allocate per event
+    queue->pool = (Sim_event *) malloc (max_events * sizeof (Sim_event));
+    queue->free_list = NULL;
+    for (int i = max_events - 1; i >= 0; i--) {
+        queue->pool[i].next = queue->free_list;
+        queue->free_list = &queue->pool[i];
+    }
+}
+
+// Adds an event to the calendar queue (events with equal times leave in insertion order), returns -1 if the event pool is exhausted
+
+int calendar_enqueue (Calendar_queue *queue, double time, int type, int segment) {
+    Sim_event *event = queue->free_list;
+    Sim_event **link;
+
+    if (event == NULL)
+        return -1;
+    queue->free_list = event->next;
+
+    event->time = time;
+    event->type = type;
+    event->segment = segment;
+
+    link = &queue->buckets[(long)(time / queue->bucket_width) & (queue->num_buckets - 1)];
+    while (*link != NULL && (*link)->time <= time)
+        link = &(*link)->next;
+    event->next = *link;
+    *link = event;
+    queue->size++;
+
+    return 0;
+}
+
+// Removes the earliest event from the calendar queue and copies it to *event, returns -1 if the queue is empty
+// Buckets are visited in calendar order; a full round without an event of the current year falls back to a direct search
+
+int calendar_dequeue (Calendar_queue *queue, Sim_event *event) {
+    Sim_event *earliest = NULL;
+    int bucket = 0;
+
+    if (queue->size == 0)
+        return -1;
+
+    for (int i = 0; i < queue->num_buckets; i++) {
+        if (queue->buckets[queue->current_bucket] != NULL && queue->buckets[queue->current_bucket]->time < queue->bucket_top) {
+            earliest = queue->buckets[queue->current_bucket];
+            bucket = queue->current_bucket;
+            break;
+        }
+        queue->current_bucket = (queue->current_bucket + 1) & (queue->num_buckets - 1);
+        queue->bucket_top += queue->bucket_width;
+    }
+
+    // All pending events lie beyond the current year -- jump to the earliest one
+    if (earliest == NULL) {
+        for (int b = 0; b < queue->num_buckets; b++) {
+            if (queue->buckets[b] != NULL && (earliest == NULL || queue->buckets[b]->time < earliest->time)) {
+                earliest = queue->buckets[b];
+                bucket = b;
+            }
+        }
+        queue->current_bucket = bucket;
+        queue->bucket_top = (floor (earliest->time / queue->bucket_width) + 1) * queue->bucket_width;
+    }
+
+    queue->buckets[bucket] = earliest->next;
+    *event = *earliest;
+    earliest->next = queue->free_list;
+    queue->free_list = earliest;
+    queue->size--;
+
+    return 0;
+}
+
+// Frees the buckets and the event pool of a calendar queue
+
+void free_calendar_queue (Calendar_queue *queue) {
+    free (queue->buckets);
+    free (queue->pool);
+}
+
+// Input port through which a link leaving a router through out_port enters the next router
+
+static int find_arrival_port (int out_port) {
+    switch (out_port) {
+        case EAST:  return WEST;
+        case WEST:  return EAST;
+        case NORTH: return SOUTH;
+        default:    return NORTH;
+    }
+}
+
+// Collects the router ports held by the circuit of a segment, returns their number
+// Resource (router, side, port) is numbered (router - 1) * 10 + side * 5 + port with side INPUT or OUTPUT; an output port stands for the
+// link leaving through it. With hold_ejection set, the ports of the router at the end of each leg are held as well (the busytime
+// model does not track them)
+
+static int find_circuit_resources (Eval_state *state, Test_segment *segment, int *resources, int hold_ejection) {
+    int ends[2][2];                                    // Source and destination core of both legs
+    int routes[2];                                     // Candidate route of both legs
+    Route_hop hops[MAX_ROUTE_HOPS];                    // Hops of one leg
+    int num_hops = 0;
+    int num_resources = 0;
+
+    ends[0][0] = state->io_pairs[segment->io_pair - 1].input_core_no;
+    ends[0][1] = segment->test_core;
+    ends[1][0] = segment->test_core;
+    ends[1][1] = state->io_pairs[segment->io_pair - 1].output_core_no;
+    routes[0] = segment->route_ic;
+    routes[1] = segment->route_co;
+
+    for (int leg = 0; leg < 2; leg++) {
+        num_hops = find_candidate_route (state->route_table, ends[leg][0], ends[leg][1], routes[leg], hops);
+        for (int h = 0; h < num_hops; h++) {
+            resources[num_resources++] = (hops[h].router - 1) * 10 + INPUT * 5 + hops[h].in_port;
+            resources[num_resources++] = (hops[h].router - 1) * 10 + OUTPUT * 5 + hops[h].out_port;
+        }
+        if (hold_ejection && num_hops > 0) {
+            resources[num_resources++] = (hops[num_hops - 1].next - 1) * 10 + INPUT * 5 + find_arrival_port (hops[num_hops - 1].out_port);
+            resources[num_resources++] = (hops[num_hops - 1].next - 1) * 10 + OUTPUT * 5 + EJECTION;
+        }
+    }
+
+    return num_resources;
+}
+
+// Appends a segment to the segments waiting for the circuit of another segment to be torn down
+
+static void add_sim_waiter (Sim_segment *sim, int segment, int waiter) {
+    sim[waiter].next_waiter = UNALLOCATED;
+    if (sim[segment].first_waiter == UNALLOCATED)
+        sim[segment].first_waiter = waiter;
+    else
+        sim[sim[segment].last_waiter].next_waiter = waiter;
+    sim[segment].last_waiter = waiter;
+}
+
+// Replays the schedule held by a fully evaluated state as a discrete-event simulation of circuit setup, test packets and teardown
+// - a segment sets up its circuit at its scheduled starttime, once the previous segments of its test and of its io pair are torn down
+//   and every router port and link on both legs is free (all or nothing); a setup finding a port held by another circuit is a conflict
+// - setup takes one cycle per hop, every pattern takes 1 + max hops + scan_chain_length - 1 cycles and the response tail min hops,
+//   with the actual hop counts of the routes (the busytime model uses its hop length estimate)
+// Events go through a calendar queue. A setup that cannot proceed waits on the one segment blocking it (the previous segment or the
+// holder of the first busy port) and is retried at that segment's teardown, so a teardown only wakes the segments it was blocking;
+// segments woken by the same teardown retry in the order they were blocked.
+// Returns -1 if the event pool overflows
+
+int simulate_schedule (Eval_state *state, Genome *mapping, Sim_report *report) {
+
+    int num_segments = state->num_segments;
+    Sim_segment *sim = (Sim_segment *) calloc (num_segments + 1, sizeof (Sim_segment));    // Replay state of every segment
+    int *order = (int *) malloc ((num_segments + 1) * sizeof (int));                          // Segments by scheduled starttime
+    int *owner = (int *) malloc (state->num_cores * 10 * sizeof (int));                       // Segment holding each router port (-1 --> free)
+    int *resources = (int *) malloc (4 * (state->num_cores + 2) * sizeof (int));              // Router ports of one circuit
+    int *last_of_io = (int *) malloc (state->num_io_pairs * sizeof (int));                    // Last segment seen per io pair
+    int *last_of_test = (int *) malloc (state->num_test_cores * sizeof (int));                // Last segment seen per position
+    Calendar_queue queue;
+    Sim_event event;
+    Test_segment *segment;
+    Sim_segment *s;
+    int num_resources = 0;
+    int num_hops_ic = 0;
+    int num_hops_co = 0;
+    int blocked = 0;
+    double frequency = 0.0;
+    long expected_events = 0;
+    int status = 0;
+
+    report->predicted_makespan = state->makespan;
+    report->simulated_makespan = 0.0;
+    report->num_segments = num_segments;
+    report->num_events = 0;
+    report->num_conflicts = 0;
+    report->num_delayed = 0;
+    report->max_delay = 0.0;
+    report->num_incomplete = 0;
+    report->first_conflict_core = 0;
+    report->first_conflict_router = 0;
+    report->first_conflict_time = 0.0;
+
+    for (int i = 0; i < state->num_cores * 10; i++)
+        owner[i] = UNALLOCATED;
+    for (int k = 0; k < state->num_io_pairs; k++)
+        last_of_io[k] = UNALLOCATED;
+    for (int i = 0; i < state->num_test_cores; i++)
+        last_of_test[i] = UNALLOCATED;
+
+    // Segments by scheduled starttime (insertion sort, segments of one io pair are already in order)
+    for (int i = 0; i < num_segments; i++) {
+        int j = i;
+        while (j > 0 && state->segments[order[j - 1]].starttime > state->segments[i].starttime) {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = i;
+    }
+
+    // Dependencies and cycle counts of every segment
+    for (int i = 0; i < num_segments; i++) {
+        segment = &state->segments[i];
+        s = &sim[i];
+
+        // Segments of a test are stored in segment order
+        s->prev_test = last_of_test[segment->position];
+        last_of_test[segment->position] = i;
+
+        num_hops_ic = find_candidate_route_length (state->route_table, state->io_pairs[segment->io_pair - 1].input_core_no, segment->test_core, segment->route_ic);
+        num_hops_co = find_candidate_route_length (state->route_table, segment->test_core, state->io_pairs[segment->io_pair - 1].output_core_no, segment->route_co);
+        frequency = state->context->freq[mapping->freq_index[segment->position]];
+
+        s->setup_time = (num_hops_ic + num_hops_co) / frequency;
+        s->pattern_time = (1 + max(num_hops_ic, num_hops_co) + (state->noc_nodes[segment->test_core - 1].scan_chain_length - 1)) / frequency;
+        s->tail_time = ((num_hops_ic < num_hops_co) ? num_hops_ic : num_hops_co) / frequency;
+        s->patterns_left = segment->num_patterns;
+        s->status = SIM_WAITING;
+        s->first_waiter = UNALLOCATED;
+        s->last_waiter = UNALLOCATED;
+        s->next_waiter = UNALLOCATED;
+        expected_events += segment->num_patterns + 2;
+    }
+    for (int i = 0; i < num_segments; i++) {
+        segment = &state->segments[order[i]];
+        sim[order[i]].prev_io = last_of_io[segment->io_pair - 1];
+        last_of_io[segment->io_pair - 1] = order[i];
+    }
+
+    // At most one setup and one pattern or teardown event are pending per segment
+    init_calendar_queue (&queue, 2 * num_segments + 2, expected_events, state->makespan);
+    for (int i = 0; i < num_segments; i++) {
+        calendar_enqueue (&queue, state->segments[i].starttime, SIM_SETUP, i);
+        sim[i].setup_pending = 1;
+    }
+
+    while (status == 0 && calendar_dequeue (&queue, &event) == 0) {
+        report->num_events++;
+        segment = &state->segments[event.segment];
+        s = &sim[event.segment];
+
+        switch (event.type) {
+
+            case SIM_SETUP:
+                s->setup_pending = 0;
+                if (s->status != SIM_WAITING)
+                    break;
+
+                // The previous segments of the test and of the io pair have to be torn down first
+                if (s->prev_test != UNALLOCATED && sim[s->prev_test].status != SIM_DONE) {
+                    add_sim_waiter (sim, s->prev_test, event.segment);
+                    break;
+                }
+                if (s->prev_io != UNALLOCATED && sim[s->prev_io].status != SIM_DONE) {
+                    add_sim_waiter (sim, s->prev_io, event.segment);
+                    break;
+                }
+
+                // All or nothing -- a port held by another circuit blocks the setup until that circuit is torn down
+                num_resources = find_circuit_resources (state, segment, resources, 1);
+                blocked = UNALLOCATED;
+                for (int r = 0; r < num_resources && blocked == UNALLOCATED; r++)
+                    if (owner[resources[r]] != UNALLOCATED && owner[resources[r]] != event.segment)
+                        blocked = resources[r];
+                if (blocked != UNALLOCATED) {
+                    if (!s->conflicted) {
+                        s->conflicted = 1;
+                        if (report->num_conflicts++ == 0) {
+                            report->first_conflict_core = segment->test_core;
+                            report->first_conflict_router = blocked / 10 + 1;
+                            report->first_conflict_time = event.time;
+                        }
+                    }
+                    add_sim_waiter (sim, owner[blocked], event.segment);
+                    break;
+                }
+
+                for (int r = 0; r < num_resources; r++)
+                    owner[resources[r]] = event.segment;
+                s->status = SIM_ACTIVE;
+                s->starttime = event.time;
+                if (event.time - segment->starttime > 1e-9) {
+                    report->num_delayed++;
+                    report->max_delay = max(report->max_delay, event.time - segment->starttime);
+                }
+
+                if (s->patterns_left > 0)
+                    status = calendar_enqueue (&queue, event.time + s->setup_time + s->pattern_time, SIM_PATTERN, event.segment);
+                else
+                    status = calendar_enqueue (&queue, event.time + s->setup_time + s->tail_time, SIM_TEARDOWN, event.segment);
+                break;
+
+            case SIM_PATTERN:
+                s->patterns_left--;
+                if (s->patterns_left > 0)
+                    status = calendar_enqueue (&queue, event.time + s->pattern_time, SIM_PATTERN, event.segment);
+                else
+                    status = calendar_enqueue (&queue, event.time + s->tail_time, SIM_TEARDOWN, event.segment);
+                break;
+
+            default:
+                num_resources = find_circuit_resources (state, segment, resources, 1);
+                for (int r = 0; r < num_resources; r++)
+                    if (owner[resources[r]] == event.segment)
+                        owner[resources[r]] = UNALLOCATED;
+                s->status = SIM_DONE;
+                s->endtime = event.time;
+                report->simulated_makespan = max(report->simulated_makespan, event.time);
+
+                // The segments this circuit was blocking may now be able to set up theirs
+                for (int i = s->first_waiter; i != UNALLOCATED && status == 0; i = sim[i].next_waiter) {
+                    status = calendar_enqueue (&queue, event.time, SIM_SETUP, i);
+                    sim[i].setup_pending = 1;
+                }
+                s->first_waiter = UNALLOCATED;
+                break;
+        }
+    }
+
+    for (int i = 0; i < num_segments; i++)
+        if (sim[i].status != SIM_DONE)
+            report->num_incomplete++;
+
+    free_calendar_queue (&queue);
+    free (sim);
+    free (order);
+    free (owner);
+    free (resources);
+    free (last_of_io);
+    free (last_of_test);
+
+    return status;
+}
+
+// Prints the result of a schedule replay (nothing if out_file is NULL)
+
+void print_sim_report (FILE *out_file, Sim_report *report) {
+    if (out_file == NULL)
+        return;
+    fprintf(out_file, " Validation: simulated testtime %lf vs predicted %lf (%+.2lf%%), %d segments, %ld events\n", report->simulated_makespan, report->predicted_makespan,
+            (report->predicted_makespan > 0) ? 100 * (report->simulated_makespan - report->predicted_makespan) / report->predicted_makespan : 0.0,
+            report->num_segments, report->num_events);
+    fprintf(out_file, " Validation: %d circuit conflicts, %d segments started late (max delay %lf)", report->num_conflicts, report->num_delayed, report->max_delay);
+    if (report->num_conflicts > 0)
+        fprintf(out_file, ", first conflict: core %d blocked at router %d at %lf", report->first_conflict_core, report->first_conflict_router, report->first_conflict_time);
+    if (report->num_incomplete > 0)
+        fprintf(out_file, ", %d segments never completed", report->num_incomplete);
+    fprintf(out_file, "\n");
+}
+
+
+// Orders resource intervals by router port, then by starttime (segment index on ties, so the order is deterministic)
+
+static int compare_resource_intervals (const void *a, const void *b) {
+    const Resource_interval *x = (const Resource_interval *) a;
+    const Resource_interval *y = (const Resource_interval *) b;
+
+    if (x->resource != y->resource)
+        return (x->resource < y->resource) ? -1 : 1;
+    if (x->starttime != y->starttime)
+        return (x->starttime < y->starttime) ? -1 : 1;
+    return (x->segment > y->segment) - (x->segment < y->segment);
+}
+
+// Expands every segment of a fully evaluated state into one interval per router port held by its circuit (the resources of the busytime
+// model, an output port standing for the link leaving through it) and sorts them by port and starttime. Returns the intervals
+// (NULL if out of memory), *num_intervals is set to their number
+
+static Resource_interval *find_resource_intervals (Eval_state *state, int *num_intervals) {
+    int *resources = (int *) malloc (4 * (state->num_cores + 2) * sizeof (int));              // Router ports of one circuit
+    Resource_interval *intervals = NULL;     // Port intervals of all segments
+    int num_resources = 0;
+    Test_segment *segment;
+
+    *num_intervals = 0;
+    if (resources == NULL)
+        return NULL;
+
+    // Count the intervals first, so they fit in one allocation
+    for (int s = 0; s < state->num_segments; s++)
+        *num_intervals += find_circuit_resources (state, &state->segments[s], resources, 0);
+    intervals = (Resource_interval *) malloc ((*num_intervals + 1) * sizeof (Resource_interval));
+    if (intervals == NULL) {
+        free (resources);
+        return NULL;
+    }
+
+    *num_intervals = 0;
+    for (int s = 0; s < state->num_segments; s++) {
+        segment = &state->segments[s];
+        num_resources = find_circuit_resources (state, segment, resources, 0);
+        for (int r = 0; r < num_resources; r++) {
+            intervals[*num_intervals].resource = resources[r];
+            intervals[*num_intervals].segment = s;
+            intervals[*num_intervals].starttime = segment->starttime;
+            intervals[*num_intervals].endtime = segment->endtime;
+            (*num_intervals)++;
+        }
+    }
+    qsort (intervals, *num_intervals, sizeof (Resource_interval), compare_resource_intervals);
+
+    free (resources);
+    return intervals;
+}
+
+// Checks the schedule held by a fully evaluated state for router ports and links used by two segments at once
+// Every segment holds the ports along both legs of its circuit from its starttime to its endtime. The sorted port intervals are swept
+// once, each compared with the latest-ending earlier interval on the same port, so the check is O(n log n) in the number of intervals.
+// Intervals of the same segment never conflict; touching intervals do not overlap
+
+int check_schedule_conflicts (Eval_state *state, Conflict_report *report) {
+
+    int num_intervals = 0;
+    Resource_interval *intervals = find_resource_intervals (state, &num_intervals);   // Port intervals of all segments
+    int latest = 0;                          // Latest-ending interval so far on the current port
+    Test_segment *segment;
+    Schedule_conflict *conflict;
+
+    report->num_intervals = 0;
+    report->num_conflicts = 0;
+    if (intervals == NULL)
+        return -1;
+
+    for (int i = 1; i < num_intervals; i++) {
+        if (intervals[i].resource != intervals[latest].resource) {
+            latest = i;
+            continue;
+        }
+        if (intervals[i].segment != intervals[latest].segment && intervals[i].starttime < intervals[latest].endtime) {
+            if (report->num_conflicts < MAX_REPORTED_CONFLICTS) {
+                conflict = &report->conflicts[report->num_conflicts];
+                conflict->router = intervals[i].resource / 10 + 1;
+                conflict->side = (intervals[i].resource % 10) / 5;
+                conflict->port = intervals[i].resource % 5;
+                for (int k = 0; k < 2; k++) {
+                    segment = &state->segments[intervals[(k == 0) ? latest : i].segment];
+                    conflict->core[k] = segment->test_core;
+                    conflict->segment_no[k] = segment->segment_no;
+                    conflict->starttime[k] = segment->starttime;
+                    conflict->endtime[k] = segment->endtime;
+                }
+            }
+            report->num_conflicts++;
+        }
+        if (intervals[i].endtime > intervals[latest].endtime)
+            latest = i;
+    }
+    report->num_intervals = num_intervals;
+
+    free (intervals);
+
+    return report->num_conflicts;
+}
+
+// Prints the result of a conflict check (nothing if out_file is NULL)
+
+void print_conflict_report (FILE *out_file, Conflict_report *report) {
+    Schedule_conflict *conflict;
+
+    if (out_file == NULL)
+        return;
+    fprintf(out_file, " Conflict check: %d conflicts in %d router port intervals\n", report->num_conflicts, report->num_intervals);
+    for (int i = 0; i < report->num_conflicts && i < MAX_REPORTED_CONFLICTS; i++) {
+        conflict = &report->conflicts[i];
+        fprintf(out_file, "  router %d %s port %d: core %d segment %d (%lf to %lf) overlaps core %d segment %d (%lf to %lf)\n",
+                conflict->router, (conflict->side == INPUT) ? "input" : "output", conflict->port,
+                conflict->core[1], conflict->segment_no[1] + 1, conflict->starttime[1], conflict->endtime[1],
+                conflict->core[0], conflict->segment_no[0] + 1, conflict->starttime[0], conflict->endtime[0]);
+    }
+    if (report->num_conflicts > MAX_REPORTED_CONFLICTS)
+        fprintf(out_file, "  ... %d more\n", report->num_conflicts - MAX_REPORTED_CONFLICTS);
+}
+
+
+// ===============
+// SCHEDULE EXPORT
+// ===============
+
+// Builds the binary schedule of a fully evaluated state in memory, laid out exactly as the file (header, mapping, io pairs, segments,
+// router port occupancy), so writing it is a single fwrite. Segments are grouped by io pair with a stable counting sort -- the segments
+// of an io pair are scheduled in order of starttime, so each group is already in time order
+
+int create_schedule_view (Eval_state *state, Genome *mapping, Lower_bounds *bounds, Schedule_view *view) {
+
+    int num_test_cores = state->num_test_cores;
+    int num_io_pairs = state->num_io_pairs;
+    int num_intervals = 0;
+    Resource_interval *intervals = find_resource_intervals (state, &num_intervals);   // Sorted port intervals of all segments
+    int *file_segment = (int *) malloc ((state->num_segments + 1) * sizeof (int));   // Segment record of each segment of the state
+    Schedule_file_header *header;
+    Schedule_file_io_pair *io_pair;
+    Schedule_file_segment *record;
+    Test_segment *segment;
+    long long size = sizeof (Schedule_file_header);
+
+    if (intervals == NULL || file_segment == NULL) {
+        free (intervals);
+        free (file_segment);
+        return -1;
+    }
+
+    view->base = calloc (1, size + num_test_cores * sizeof (Schedule_file_mapping) + num_io_pairs * sizeof (Schedule_file_io_pair) +
+                         state->num_segments * sizeof (Schedule_file_segment) + num_intervals * sizeof (Resource_interval));
+    if (view->base == NULL) {
+        free (intervals);
+        free (file_segment);
+        return -1;
+    }
+    view->mapped = 0;
+
+    header = view->header = (Schedule_file_header *) view->base;
+    memcpy (header->magic, SCHEDULE_MAGIC, sizeof (header->magic));
+    header->version = SCHEDULE_VERSION;
+    header->routing = state->route_table->routing;
+    header->num_cores = state->num_cores;
+    header->N_columns = state->N_columns;
+    header->num_test_cores = num_test_cores;
+    header->num_io_pairs = num_io_pairs;
+    header->num_segments = state->num_segments;
+    header->num_intervals = num_intervals;
+    header->total_testtime = state->makespan;
+    header->lower_bound = bounds->best;
+    header->optimality_gap = find_optimality_gap (bounds, state->makespan);
+    header->mapping_offset = size;
+    size += num_test_cores * sizeof (Schedule_file_mapping);
+    header->io_pair_offset = size;
+    size += num_io_pairs * sizeof (Schedule_file_io_pair);
+    header->segment_offset = size;
+    size += state->num_segments * sizeof (Schedule_file_segment);
+    header->interval_offset = size;
+    size += num_intervals * sizeof (Resource_interval);
+    header->file_size = size;
+
+    view->mapping = (Schedule_file_mapping *) ((char *) view->base + header->mapping_offset);
+    view->io_pairs = (Schedule_file_io_pair *) ((char *) view->base + header->io_pair_offset);
+    view->segments = (Schedule_file_segment *) ((char *) view->base + header->segment_offset);
+    view->intervals = (Resource_interval *) ((char *) view->base + header->interval_offset);
+
+    for (int i = 0; i < num_test_cores; i++) {
+        view->mapping[i].test_core = mapping->test_core[i];
+        view->mapping[i].io_pair = mapping->io_pair[i];
+        view->mapping[i].frequency = state->context->freq[mapping->freq_index[i]];
+        view->mapping[i].preemption = mapping->preemption[i];
+    }
+
+    // Count the segments per io pair, then place them behind the segments of the preceding io pairs
+    for (int p = 0; p < num_io_pairs; p++) {
+        view->io_pairs[p].input_core = state->io_pairs[p].input_core_no;
+        view->io_pairs[p].output_core = state->io_pairs[p].output_core_no;
+    }
+    for (int s = 0; s < state->num_segments; s++)
+        view->io_pairs[state->segments[s].io_pair - 1].num_segments++;
+    for (int p = 1; p < num_io_pairs; p++)
+        view->io_pairs[p].first_segment = view->io_pairs[p - 1].first_segment + view->io_pairs[p - 1].num_segments;
+
+    for (int s = 0; s < state->num_segments; s++) {
+        segment = &state->segments[s];
+        io_pair = &view->io_pairs[segment->io_pair - 1];
+        file_segment[s] = io_pair->first_segment++;
+        record = &view->segments[file_segment[s]];
+        record->io_pair = segment->io_pair;
+        record->test_core = segment->test_core;
+        record->segment_no = segment->segment_no;
+        record->num_segments = find_num_segments (state->noc_nodes[segment->test_core - 1].test_patterns, mapping->preemption[segment->position]);
+        record->num_patterns = segment->num_patterns;
+        record->position = segment->position;
+        record->route_ic = segment->route_ic;
+        record->route_co = segment->route_co;
+        record->starttime = segment->starttime;
+        record->endtime = segment->endtime;
+    }
+    for (int p = 0; p < num_io_pairs; p++)
+        view->io_pairs[p].first_segment -= view->io_pairs[p].num_segments;
+
+    for (int i = 0; i < num_intervals; i++) {
+        view->intervals[i] = intervals[i];
+        view->intervals[i].segment = file_segment[intervals[i].segment];
+    }
+
+    free (intervals);
+    free (file_segment);
+    return 0;
+}
+
+// Writes a binary schedule to a file
+// The file is written under a temporary name and renamed, so readers never map a partially written schedule
+
+int write_schedule_file (const char *file_name, Schedule_view *view) {
+    char temp_file_name[MAX_PATH_LENGTH + 8];                  // Temporary file written before the rename
+    FILE *fptr;
+    int ok = 1;
+
+    snprintf (temp_file_name, sizeof (temp_file_name), "%s.tmp", file_name);
+    fptr = fopen (temp_file_name, "wb");
+    if (fptr == NULL)
+        return -1;
+
+    ok = (fwrite (view->base, (size_t) view->header->file_size, 1, fptr) == 1);
+    ok = (fclose (fptr) == 0) && ok;
+
+    if (!ok || rename (temp_file_name, file_name) != 0) {
+        remove (temp_file_name);
+        return -1;
+    }
+    return 0;
+}
+
+// Checks that a section of num_records records of record_size bytes at the given offset lies behind the header and inside the file,
+// and starts 8-byte aligned (the records hold doubles and are used in place)
+
+static int check_schedule_section (long long offset, int num_records, size_t record_size, long long file_size) {
+    return offset >= (long long) sizeof (Schedule_file_header) && offset % 8 == 0 && offset <= file_size && num_records >= 0 &&
+           num_records <= (file_size - offset) / (long long) record_size;
+}
+
+// Checks the record fields of a binary schedule that index other records: the segment range of every io pair and the segment of
+// every occupancy record have to lie within the segment records
+
+static int check_schedule_records (Schedule_view *view) {
+    Schedule_file_header *header = view->header;
+
+    for (int p = 0; p < header->num_io_pairs; p++)
+        if (view->io_pairs[p].first_segment < 0 || view->io_pairs[p].num_segments < 0 ||
+            (long long) view->io_pairs[p].first_segment + view->io_pairs[p].num_segments > header->num_segments)
+            return 0;
+    for (int i = 0; i < header->num_intervals; i++)
+        if (view->intervals[i].segment < 0 || view->intervals[i].segment >= header->num_segments)
+            return 0;
+    return 1;
+}
+
+// Maps a binary schedule file read-only
+// The magic, the version, every section's extent and alignment, and every record index are checked before any record is handed out
+
+int map_schedule_file (const char *file_name, Schedule_view *view) {
+    struct stat file_stat;
+    Schedule_file_header *header;
+    int fd = open (file_name, O_RDONLY);
+    int ok = 0;
+
+    if (fd < 0)
+        return -1;
+    if (fstat (fd, &file_stat) != 0 || file_stat.st_size < (off_t) sizeof (Schedule_file_header)) {
+        close (fd);
+        return -1;
+    }
+
+    view->base = mmap (NULL, (size_t) file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close (fd);
+    if (view->base == MAP_FAILED)
+        return -1;
+    view->mapped = 1;
+
+    header = view->header = (Schedule_file_header *) view->base;
+    ok = (memcmp (header->magic, SCHEDULE_MAGIC, sizeof (header->magic)) == 0 && header->version == SCHEDULE_VERSION &&
+          header->file_size == (long long) file_stat.st_size &&
+          check_schedule_section (header->mapping_offset, header->num_test_cores, sizeof (Schedule_file_mapping), header->file_size) &&
+          check_schedule_section (header->io_pair_offset, header->num_io_pairs, sizeof (Schedule_file_io_pair), header->file_size) &&
+          check_schedule_section (header->segment_offset, header->num_segments, sizeof (Schedule_file_segment), header->file_size) &&
+          check_schedule_section (header->interval_offset, header->num_intervals, sizeof (Resource_interval), header->file_size));
+
+    if (ok) {
+        view->mapping = (Schedule_file_mapping *) ((char *) view->base + header->mapping_offset);
+        view->io_pairs = (Schedule_file_io_pair *) ((char *) view->base + header->io_pair_offset);
+        view->segments = (Schedule_file_segment *) ((char *) view->base + header->segment_offset);
+        view->intervals = (Resource_interval *) ((char *) view->base + header->interval_offset);
+        ok = check_schedule_records (view);
+    }
+    if (!ok) {
+        munmap (view->base, (size_t) file_stat.st_size);
+        return -1;
+    }
+    return 0;
+}
+
+// Releases a binary schedule built by create_schedule_view or mapped by map_schedule_file
+
+void free_schedule_view (Schedule_view *view) {
+    if (view->mapped)
+        munmap (view->base, (size_t) view->header->file_size);
+    else
+        free (view->base);
+    view->base = NULL;
+}
+
+// Streams a binary schedule as CSV or JSON text, one record per line
+// CSV lines start with the record type (objective, mapping, segment, occupancy); the field list of every type is given in the
+// leading comment lines. Times are printed with 17 significant digits, so the text holds the same values as the binary file
+
+void write_schedule_text (FILE *out_file, Schedule_view *view, int format) {
+    Schedule_file_header *header = view->header;
+    Schedule_file_mapping *test;
+    Schedule_file_io_pair *io_pair;
+    Schedule_file_segment *segment;
+    Resource_interval *interval;
+    const char *side;                        // Side of an occupied router port
+
+    if (format == EXPORT_CSV) {
+        fprintf(out_file, "# NoC test schedule, version %d\n", SCHEDULE_VERSION);
+        fprintf(out_file, "# objective,name,value\n");
+        fprintf(out_file, "# mapping,position,test_core,io_pair,frequency,preemption\n");
+        fprintf(out_file, "# segment,io_pair,test_core,segment_no,num_segments,num_patterns,starttime,endtime\n");
+        fprintf(out_file, "# occupancy,router,side,port,test_core,segment_no,starttime,endtime\n");
+        fprintf(out_file, "objective,total_testtime,%.17g\n", header->total_testtime);
+        fprintf(out_file, "objective,lower_bound,%.17g\n", header->lower_bound);
+        fprintf(out_file, "objective,optimality_gap,%.17g\n", header->optimality_gap);
+    }
+    else {
+        fprintf(out_file, "{\n \"version\": %d,\n", SCHEDULE_VERSION);
+        fprintf(out_file, " \"objectives\": {\"total_testtime\": %.17g, \"lower_bound\": %.17g, \"optimality_gap\": %.17g},\n",
+                header->total_testtime, header->lower_bound, header->optimality_gap);
+        fprintf(out_file, " \"mapping\": [");
+    }
+
+    for (int i = 0; i < header->num_test_cores; i++) {
+        test = &view->mapping[i];
+        if (format == EXPORT_CSV)
+            fprintf(out_file, "mapping,%d,%d,%d,%.17g,%.17g\n", i, test->test_core, test->io_pair, test->frequency, test->preemption);
+        else
+            fprintf(out_file, "%s\n  {\"position\": %d, \"test_core\": %d, \"io_pair\": %d, \"frequency\": %.17g, \"preemption\": %.17g}",
+                    (i > 0) ? "," : "", i, test->test_core, test->io_pair, test->frequency, test->preemption);
+    }
+
+    if (format == EXPORT_JSON)
+        fprintf(out_file, "\n ],\n \"io_pairs\": [");
+    for (int p = 0; p < header->num_io_pairs; p++) {
+        io_pair = &view->io_pairs[p];
+        if (format == EXPORT_JSON)
+            fprintf(out_file, "%s\n  {\"io_pair\": %d, \"input_core\": %d, \"output_core\": %d, \"segments\": [", (p > 0) ? "," : "",
+                    p + 1, io_pair->input_core, io_pair->output_core);
+        for (int s = io_pair->first_segment; s < io_pair->first_segment + io_pair->num_segments; s++) {
+            segment = &view->segments[s];
+            if (format == EXPORT_CSV)
+                fprintf(out_file, "segment,%d,%d,%d,%d,%d,%.17g,%.17g\n", segment->io_pair, segment->test_core, segment->segment_no,
+                        segment->num_segments, segment->num_patterns, segment->starttime, segment->endtime);
+            else
+                fprintf(out_file, "%s\n   {\"test_core\": %d, \"segment_no\": %d, \"num_segments\": %d, \"num_patterns\": %d, \"starttime\": %.17g, \"endtime\": %.17g}",
+                        (s > io_pair->first_segment) ? "," : "", segment->test_core, segment->segment_no, segment->num_segments,
+                        segment->num_patterns, segment->starttime, segment->endtime);
+        }
+        if (format == EXPORT_JSON)
+            fprintf(out_file, "\n  ]}");
+    }
+
+    if (format == EXPORT_JSON)
+        fprintf(out_file, "\n ],\n \"occupancy\": [");
+    for (int i = 0; i < header->num_intervals; i++) {
+        interval = &view->intervals[i];
+        segment = &view->segments[interval->segment];
+        side = ((interval->resource % 10) / 5 == INPUT) ? "input" : "output";
+        if (format == EXPORT_CSV)
+            fprintf(out_file, "occupancy,%d,%s,%d,%d,%d,%.17g,%.17g\n", interval->resource / 10 + 1, side, interval->resource % 5,
+                    segment->test_core, segment->segment_no, interval->starttime, interval->endtime);
+        else
+            fprintf(out_file, "%s\n  {\"router\": %d, \"side\": \"%s\", \"port\": %d, \"test_core\": %d, \"segment_no\": %d, \"starttime\": %.17g, \"endtime\": %.17g}",
+                    (i > 0) ? "," : "", interval->resource / 10 + 1, side, interval->resource % 5, segment->test_core, segment->segment_no,
+                    interval->starttime, interval->endtime);
+    }
+    if (format == EXPORT_JSON)
+        fprintf(out_file, "\n ]\n}\n");
+}
+
+// Exports the schedule held by a fully evaluated state in the given format (binary file, or streamed CSV/JSON text)
+
+int export_schedule (const char *file_name, int format, Eval_state *state, Genome *mapping, Lower_bounds *bounds) {
+    Schedule_view view;
+    FILE *fptr;
+    int status = 0;
+
+    if (create_schedule_view (state, mapping, bounds, &view) != 0)
+        return -1;
+
+    if (format == EXPORT_BINARY)
+        status = write_schedule_file (file_name, &view);
+    else {
+        fptr = fopen (file_name, "w");
+        if (fptr == NULL)
+            status = -1;
+        else {
+            write_schedule_text (fptr, &view, format);
+            status = (fclose (fptr) == 0) ? 0 : -1;
+        }
+    }
+
+    free_schedule_view (&view);
+    return status;
+}
+
+// File name extension of an export format
+
+const char *find_export_extension (int format) {
+    switch (format) {
+        case EXPORT_CSV:  return "csv";
+        case EXPORT_JSON: return "json";
+        default:          return "nocs";
+    }
+}
+
+// Finds the export format with the given name (binary, csv, json), returns -1 if there is none
+
+int find_export_format (const char *name) {
+    if (strcmp (name, "binary") == 0)
+        return EXPORT_BINARY;
+    if (strcmp (name, "csv") == 0)
+        return EXPORT_CSV;
+    if (strcmp (name, "json") == 0)
+        return EXPORT_JSON;
+    return -1;
+}
+
+
+// ==================
+// SCHEDULING LIBRARY
+// ==================
+
+// Reads a SoC description and sets up everything its evaluations and searches need (tables, lower bounds, evaluation state)
+// The tables come from table_cache if given (shared with other schedulers), from a cache of the scheduler's own otherwise; the
+// frequencies from freq if given, the default test frequency otherwise. Returns NULL if the file cannot be read
+
+static NoC_scheduler *open_noc_scheduler (const char *input_file, PSO_context *settings, Table_cache *table_cache, double *freq, int num_freq) {
+    NoC_scheduler *scheduler;
+
+    if (strlen (input_file) >= MAX_PATH_LENGTH)
+        return NULL;
+    scheduler = (NoC_scheduler *) malloc (sizeof (NoC_scheduler));
+    if (read_noc_design (input_file, &scheduler->design) != 0) {
+        free (scheduler);
+        return NULL;
+    }
+    strcpy (scheduler->file_name, input_file);
+
+    scheduler->freq[0] = 1.0;
+    if (freq == NULL) {
+        freq = scheduler->freq;
+        num_freq = 1;
+    }
+    if (table_cache == NULL) {
+        init_table_cache (&scheduler->own_tables);
+        table_cache = &scheduler->own_tables;
+    }
+    scheduler->table_cache = table_cache;
+    scheduler->stop = 0;
+
+    scheduler->context = *settings;
+    scheduler->context.out_file = NULL;
+    scheduler->context.testtime_table = acquire_testtime_table (table_cache, &scheduler->design, scheduler->context.routing);
+    scheduler->context.route_table = scheduler->context.testtime_table->route_table;
+    scheduler->context.freq = freq;
+    scheduler->context.num_freq = num_freq;
+    scheduler->context.arena = NULL;
+    scheduler->context.best_mapping = NULL;
+    if (scheduler->context.stop_requested == NULL)
+        scheduler->context.stop_requested = &scheduler->stop;
+    compute_lower_bounds (scheduler->design.noc_nodes, scheduler->design.N_columns, scheduler->design.num_cores, scheduler->design.io_pairs,
+                          scheduler->design.num_io_pairs, freq, num_freq, &scheduler->context);
+
+    scheduler->state = create_eval_state (scheduler->design.noc_nodes, scheduler->design.N_columns, scheduler->design.num_cores,
+                                          scheduler->design.io_pairs, scheduler->design.num_io_pairs, &scheduler->context, 1);
+    init_genome (&scheduler->last_mapping, scheduler->design.num_test_cores);
+    scheduler->num_evaluations = 0;
+    return scheduler;
+}
+
+// Checks that a mapping tests every test core of the design once, with valid io pairs, frequencies and preemption points
+// Returns -1 with an error message if it does not
+
+static int check_noc_mapping (NoC_scheduler *scheduler, Genome *mapping, int num_tests, char *error, size_t error_length) {
+    NoC_design *design = &scheduler->design;
+    char *used;                                 // Set for every test core already in the mapping
+    int test_core = 0;
+    int status = 0;
+
+    if (num_tests != design->num_test_cores) {
+        snprintf (error, error_length, "%d of %d tests given", num_tests, design->num_test_cores);
+        return -1;
+    }
+    used = (char *) calloc (design->num_cores + 1, sizeof (char));
+    for (int i = 0; i < num_tests && status == 0; i++) {
+        test_core = mapping->test_core[i];
+        if (test_core < 1 || test_core > design->num_cores || design->noc_nodes[test_core - 1].core_type != TEST_CORE || used[test_core]) {
+            snprintf (error, error_length, "core %d is not a test core or is tested twice", test_core);
+            status = -1;
+        }
+        else if (mapping->io_pair[i] < 1 || mapping->io_pair[i] > design->num_io_pairs || mapping->freq_index[i] >= scheduler->context.num_freq ||
+                 !(mapping->preemption[i] >= PREEMPTION_MIN && mapping->preemption[i] <= 1.0)) {
+            snprintf (error, error_length, "io pair, frequency or preemption point of core %d out of range", test_core);
+            status = -1;
+        }
+        else
+            used[test_core] = 1;
+    }
+    free (used);
+    return status;
+}
+
+// Total testtime of a valid mapping, rescheduled from the first test that differs from the previously evaluated mapping
+// Sets *num_reused to the number of tests whose schedule was reused
+
+static double evaluate_changed_tests (NoC_scheduler *scheduler, Genome *mapping, int *num_reused) {
+    Genome *last = &scheduler->last_mapping;
+    int position = 0;
+    double testtime;
+
+    if (scheduler->num_evaluations > 0)
+        while (position < scheduler->design.num_test_cores && last->test_core[position] == mapping->test_core[position] &&
+               last->io_pair[position] == mapping->io_pair[position] && last->freq_index[position] == mapping->freq_index[position] &&
+               last->preemption[position] == mapping->preemption[position])
+            position++;
+
+    testtime = evaluate_from (scheduler->state, mapping, position, NO_CUTOFF);
+    copy_genome (&scheduler->last_mapping, mapping);
+    scheduler->num_evaluations++;
+    *num_reused = position;
+    return testtime;
+}
+
+// Runs a search on the scheduler's design with the engine, time limit and random state of run (the other settings are those of
+// a silent single run), returns the best total testtime and copies the best mapping to run->best_mapping (if not NULL)
+// The scheduler's random stream carries on from where the search left it
+
+static double optimize_noc_mapping (NoC_scheduler *scheduler, PSO_context *run) {
+    double testtime;
+
+    run->max_generations = (run->time_limit > 0) ? INT_MAX : scheduler->context.max_generations;
+    run->generation = 0;
+    run->checkpoint_file = NULL;
+    run->checkpoint_interval = 0;
+    run->resume_file = NULL;
+    run->profile_file = NULL;
+    run->warm_start_file = NULL;
+    run->validate = 0;
+    run->check = 0;
+    run->export_format = EXPORT_NONE;
+    run->num_full_evaluations = 0;
+    run->num_delta_evaluations = 0;
+    run->num_dominated_evaluations = 0;
+
+    testtime = run_search_engine (scheduler->design.noc_nodes, scheduler->design.num_cores, scheduler->design.M_rows, run->freq, run->num_freq,
+                                  scheduler->design.io_pairs, scheduler->design.num_io_pairs, run);
+    memcpy (scheduler->context.rng_state, run->rng_state, sizeof (run->rng_state));
+    return testtime;
+}
+
+// Reads a SoC description and prepares its tables for the given routing algorithm (NULL --> xy), returns NULL on failure
+// Library schedulers run the exact solver on one thread, as they are meant to run side by side
+
+NoC_scheduler *create_noc_scheduler (const char *input_file, const char *routing) {
+    PSO_context settings;                       // Defaults of the scheduler's runs
+
+    init_pso_context (&settings, NULL);
+    settings.num_threads = 1;
+    if (routing != NULL && (settings.routing = find_routing_algorithm (routing)) < 0)
+        return NULL;
+    return open_noc_scheduler (input_file, &settings, NULL, NULL, 0);
+}
+
+// Sets the stream receiving the search trace and schedule reports (NULL --> no output)
+
+void set_noc_scheduler_log (NoC_scheduler *scheduler, FILE *log_file) {
+    scheduler->context.out_file = log_file;
+}
+
+// Number of tests in a mapping of the design
+
+int get_noc_num_tests (NoC_scheduler *scheduler) {
+    return scheduler->design.num_test_cores;
+}
+
+// Lower bound on the total testtime of the design
+
+double get_noc_lower_bound (NoC_scheduler *scheduler) {
+    return scheduler->context.lower_bounds.best;
+}
+
+// Total testtime of a mapping, -1 if it is not a valid mapping of the design
+
+double evaluate_noc_schedule (NoC_scheduler *scheduler, const NoC_test *tests, int num_tests) {
+    Genome mapping;
+    char error[128];
+    int num_reused;
+    double testtime = -1;
+
+    if (num_tests != scheduler->design.num_test_cores)
+        return -1;
+    init_genome (&mapping, num_tests);
+    for (int i = 0; i < num_tests; i++) {
+        if (tests[i].test_core < 1 || tests[i].test_core > scheduler->design.num_cores) {
+            free_genome (&mapping);
+            return -1;
+        }
+        mapping.test_core[i] = (short) tests[i].test_core;
+        mapping.io_pair[i] = (unsigned char) ((tests[i].io_pair >= 0 && tests[i].io_pair <= scheduler->design.num_io_pairs) ? tests[i].io_pair : 0);
+        mapping.freq_index[i] = 0;
+        mapping.preemption[i] = (float) tests[i].preemption;
+    }
+    if (check_noc_mapping (scheduler, &mapping, num_tests, error, sizeof (error)) == 0)
+        testtime = evaluate_changed_tests (scheduler, &mapping, &num_reused);
+    free_genome (&mapping);
+    return testtime;
+}
+
+// Searches for the best mapping with the given engine within time_limit seconds, stores it in best (if not NULL) and returns its
+// total testtime, -1 if the engine is unknown
+
+double optimize_noc_schedule (NoC_scheduler *scheduler, const char *engine, double time_limit, unsigned int seed, NoC_test *best) {
+    PSO_context run = scheduler->context;       // Settings of this search
+    Genome best_mapping;                        // Best mapping found
+    double testtime;
+
+    run.engine = (engine != NULL) ? find_search_engine (engine) : ENGINE_PSO;
+    if (run.engine < 0)
+        return -1;
+    run.time_limit = (time_limit > 0) ? time_limit : 0.0;
+    seed_pso_context (&run, seed);
+    init_genome (&best_mapping, scheduler->design.num_test_cores);
+    run.best_mapping = &best_mapping;
+
+    scheduler->stop = 0;
+    testtime = optimize_noc_mapping (scheduler, &run);
+
+    if (best != NULL)
+        for (int i = 0; i < scheduler->design.num_test_cores; i++) {
+            best[i].test_core = best_mapping.test_core[i];
+            best[i].io_pair = best_mapping.io_pair[i];
+            best[i].preemption = best_mapping.preemption[i];
+        }
+    free_genome (&best_mapping);
+    return testtime;
+}
+
+// Makes the optimize_noc_schedule call in progress on the scheduler return its best mapping so far
+
+void cancel_noc_scheduler (NoC_scheduler *scheduler) {
+    scheduler->stop = 1;
+}
+
+// Frees a scheduler (tables shared through a cache stay in the cache)
+
+void free_noc_scheduler (NoC_scheduler *scheduler) {
+    free_eval_state (scheduler->state);
+    free_genome (&scheduler->last_mapping);
+    release_testtime_table (scheduler->table_cache, scheduler->context.testtime_table);
+    if (scheduler->table_cache == &scheduler->own_tables)
+        free_table_cache (&scheduler->own_tables);
+    free_noc_design (&scheduler->design);
+    free (scheduler);
+}
+
+
+// =================
+// SCHEDULING SERVER
+// =================
+
+// Initializes a scheduling server with no design loaded
+
+void init_schedule_server (Schedule_server *server, double *freq, int num_freq, PSO_context *settings) {
+    for (int d = 0; d < MAX_SERVER_DESIGNS; d++)
+        server->designs[d] = NULL;
+    init_table_cache (&server->table_cache);
+    server->settings = settings;
+    server->freq = freq;
+    server->num_freq = num_freq;
+    server->num_requests = 0;
+    server->shutdown = 0;
+}
+
+// Frees all designs and tables held by a scheduling server
+
+void free_schedule_server (Schedule_server *server) {
+    for (int d = 0; d < MAX_SERVER_DESIGNS; d++)
+        if (server->designs[d] != NULL)
+            free_noc_scheduler (server->designs[d]);
+    free_table_cache (&server->table_cache);
+}
+
+// Finds a resident design by its id or by the file it was loaded from, returns -1 if it is not loaded
+
+static int find_server_design (Schedule_server *server, const char *name) {
+    char *end;
+    long design_id = strtol (name, &end, 10);
+
+    if (*end == '\0' && design_id >= 0 && design_id < MAX_SERVER_DESIGNS && server->designs[design_id] != NULL)
+        return (int) design_id;
+    for (int d = 0; d < MAX_SERVER_DESIGNS; d++)
+        if (server->designs[d] != NULL && strcmp (server->designs[d]->file_name, name) == 0)
+            return d;
+    return -1;
+}
+
+// Loads a design with its tables from the server's cache, returns its id
+// A design that is already resident is not read again; returns -1 if the file cannot be read, -2 if no slot is free
+
+static int load_server_design (Schedule_server *server, const char *file_name) {
+    int design_id = find_server_design (server, file_name);
+
+    if (design_id >= 0)
+        return design_id;
+    for (design_id = 0; design_id < MAX_SERVER_DESIGNS && server->designs[design_id] != NULL; design_id++);
+    if (design_id == MAX_SERVER_DESIGNS)
+        return -2;
+
+    server->designs[design_id] = open_noc_scheduler (file_name, server->settings, &server->table_cache, server->freq, server->num_freq);
+    return (server->designs[design_id] != NULL) ? design_id : -1;
+}
+
+// Parses a mapping given as one "test_core:io_pair[:freq_index[:preemption]]" token per test, in test order
+// (frequency index 0 and no preemption unless given), returns -1 with an error message if it is not a valid mapping of the design
+
+static int parse_server_mapping (NoC_scheduler *design, char **save, Genome *mapping, char *error, size_t error_length) {
+    char *token;
+    int num_tests = 0;
+    int test_core = 0;
+    int io_pair = 0;
+    int freq_index = 0;
+    float preemption = 1.0;
+
+    while ((token = strtok_r (NULL, " \t\r\n", save)) != NULL) {
+        freq_index = 0;
+        preemption = 1.0;
+
+        if (sscanf (token, "%d:%d:%d:%f", &test_core, &io_pair, &freq_index, &preemption) < 2) {
+            snprintf (error, error_length, "malformed test %s", token);
+            return -1;
+        }
+        if (num_tests == design->design.num_test_cores) {
+            snprintf (error, error_length, "more than %d tests", design->design.num_test_cores);
+            return -1;
+        }
+        if (test_core < 1 || test_core > design->design.num_cores) {
+            snprintf (error, error_length, "core %d is not a test core", test_core);
+            return -1;
+        }
+        if (io_pair < 1 || io_pair > design->design.num_io_pairs || freq_index < 0 || freq_index > 255) {
+            snprintf (error, error_length, "io pair, frequency or preemption point of core %d out of range", test_core);
+            return -1;
+        }
+
+        mapping->test_core[num_tests] = (short) test_core;
+        mapping->io_pair[num_tests] = (unsigned char) io_pair;
+        mapping->freq_index[num_tests] = (unsigned char) freq_index;
+        mapping->preemption[num_tests] = preemption;
+        num_tests++;
+    }
+
+    return check_noc_mapping (design, mapping, num_tests, error, error_length);
+}
+
+// Writes a mapping in the request format (test_core:io_pair:freq_index:preemption per test)
+
+static void print_server_mapping (FILE *out_file, Genome *mapping, int num_test_cores) {
+    for (int i = 0; i < num_test_cores; i++)
+        fprintf(out_file, " %d:%d:%d:%.9g", mapping->test_core[i], mapping->io_pair[i], mapping->freq_index[i], mapping->preemption[i]);
+}
+
+// evaluate <design> <mapping> -- total testtime of a mapping, rescheduled from the first test that differs from the last mapping
+// evaluated on the design
+
+static void serve_evaluate_request (NoC_scheduler *design, char **save, FILE *out_file) {
+    Genome mapping;
+    char error[128];
+    int num_reused = 0;
+    double start_time;
+    double testtime;
+
+    init_genome (&mapping, design->design.num_test_cores);
+    if (parse_server_mapping (design, save, &mapping, error, sizeof (error)) != 0) {
+        fprintf(out_file, "error %s\n", error);
+        free_genome (&mapping);
+        return;
+    }
+
+    start_time = get_wall_time ();
+    testtime = evaluate_changed_tests (design, &mapping, &num_reused);
+    free_genome (&mapping);
+
+    fprintf(out_file, "ok testtime %.2lf gap %.4lf reused %d time_us %.1lf\n", testtime, find_optimality_gap (&design->context.lower_bounds, testtime),
+            num_reused, 1e6 * (get_wall_time () - start_time));
+}
+
+// optimize <design> <seconds> [engine] [seed] -- searches for the best mapping within the wall-clock budget
+// Without a seed, the design's random stream carries on from the previous request
+
+static void serve_optimize_request (NoC_scheduler *design, char **save, FILE *out_file) {
+    PSO_context run = design->context;          // Settings of this search
+    Genome best_mapping;                        // Best mapping found
+    char *token;
+    double start_time = get_wall_time ();
+    double testtime;
+
+    token = strtok_r (NULL, " \t\r\n", save);
+    run.time_limit = (token != NULL) ? atof (token) : 0.0;
+    if (run.time_limit <= 0) {
+        fprintf(out_file, "error optimize needs a time budget in seconds\n");
+        return;
+    }
+    if ((token = strtok_r (NULL, " \t\r\n", save)) != NULL) {
+        run.engine = find_search_engine (token);
+        if (run.engine < 0) {
+            fprintf(out_file, "error unknown search engine %s\n", token);
+            return;
+        }
+    }
+    if ((token = strtok_r (NULL, " \t\r\n", save)) != NULL)
+        seed_pso_context (&run, (unsigned int) strtoul (token, NULL, 10));
+
+    init_genome (&best_mapping, design->design.num_test_cores);
+    run.best_mapping = &best_mapping;
+    testtime = optimize_noc_mapping (design, &run);
+
+    fprintf(out_file, "ok testtime %.2lf gap %.4lf engine %s evaluations %ld time_s %.3lf mapping", testtime,
+            find_optimality_gap (&design->context.lower_bounds, testtime), find_search_engine_name (run.engine),
+            run.num_full_evaluations + run.num_delta_evaluations, get_wall_time () - start_time);
+    print_server_mapping (out_file, &best_mapping, design->design.num_test_cores);
+    fprintf(out_file, "\n");
+    free_genome (&best_mapping);
+}
+
+// Handles one request line and writes its response line ("ok ..." or "error ..."), returns -1 if the client closes the connection
+// Requests: load <file>, unload <design>, evaluate <design> <mapping>, optimize <design> <seconds> [engine] [seed], stats, quit,
+// shutdown; a design is named by its id or its file; blank lines and lines starting with '#' get no response
+
+int handle_server_request (Schedule_server *server, char *request, FILE *out_file) {
+    char *save = NULL;
+    char *command = strtok_r (request, " \t\r\n", &save);
+    char *name;
+    int design_id = -1;
+    int num_designs = 0;
+    int num_route_tables = 0;
+    int num_testtime_tables = 0;
+
+    if (command == NULL || command[0] == '#')
+        return 0;
+    server->num_requests++;
+
+    if (strcmp (command, "quit") == 0) {
+        fprintf(out_file, "ok bye\n");
+        return -1;
+    }
+    if (strcmp (command, "shutdown") == 0) {
+        fprintf(out_file, "ok shutting down\n");
+        server->shutdown = 1;
+        return -1;
+    }
+    if (strcmp (command, "stats") == 0) {
+        for (int d = 0; d < MAX_SERVER_DESIGNS; d++)
+            num_designs += (server->designs[d] != NULL);
+        for (Route_table *table = server->table_cache.route_tables; table != NULL; table = table->next)
+            num_route_tables++;
+        for (Testtime_table *table = server->table_cache.testtime_tables; table != NULL; table = table->next)
+            num_testtime_tables++;
+        fprintf(out_file, "ok designs %d requests %ld route_tables %d testtime_tables %d\n", num_designs, server->num_requests, num_route_tables, num_testtime_tables);
+        return 0;
+    }
+
+    // All other requests name a design
+    name = strtok_r (NULL, " \t\r\n", &save);
+    if (name == NULL) {
+        fprintf(out_file, "error %s needs a design\n", command);
+        return 0;
+    }
+
+    if (strcmp (command, "load") == 0) {
+        design_id = load_server_design (server, name);
+        if (design_id == -1)
+            fprintf(out_file, "error could not read %s\n", name);
+        else if (design_id < 0)
+            fprintf(out_file, "error no room for %s (at most %d designs)\n", name, MAX_SERVER_DESIGNS);
+        else
+            fprintf(out_file, "ok design %d mesh %dx%d test_cores %d io_pairs %d lower_bound %.2lf\n", design_id, server->designs[design_id]->design.M_rows,
+                    server->designs[design_id]->design.N_columns, server->designs[design_id]->design.num_test_cores,
+                    server->designs[design_id]->design.num_io_pairs, server->designs[design_id]->context.lower_bounds.best);
+        return 0;
+    }
+
+    design_id = find_server_design (server, name);
+    if (design_id < 0) {
+        fprintf(out_file, "error design %s is not loaded\n", name);
+        return 0;
+    }
+
+    if (strcmp (command, "unload") == 0) {
+        free_noc_scheduler (server->designs[design_id]);
+        server->designs[design_id] = NULL;
+        fprintf(out_file, "ok unloaded %d\n", design_id);
+    }
+    else if (strcmp (command, "evaluate") == 0)
+        serve_evaluate_request (server->designs[design_id], &save, out_file);
+    else if (strcmp (command, "optimize") == 0)
+        serve_optimize_request (server->designs[design_id], &save, out_file);
+    else
+        fprintf(out_file, "error unknown request %s\n", command);
+    return 0;
+}
+
+// Serves request lines from in_file until end of file, a quit or shutdown request or a stop request (SIGINT/SIGTERM)
+// Every response is flushed at once, so that a client can wait for it before sending the next request
+
+void serve_requests (Schedule_server *server, FILE *in_file, FILE *out_file) {
+    char request[MAX_REQUEST_LENGTH];
+    volatile sig_atomic_t *stop_requested = server->settings->stop_requested;
+    int c;
+
+    while (!server->shutdown && !(stop_requested != NULL && *stop_requested) && fgets (request, sizeof (request), in_file) != NULL) {
+
+        // Overlong requests are dropped as a whole
+        if (strchr (request, '\n') == NULL && !feof (in_file)) {
+            while ((c = fgetc (in_file)) != EOF && c != '\n');
+            fprintf(out_file, "error request longer than %d characters\n", MAX_REQUEST_LENGTH - 2);
+        }
+        else if (handle_server_request (server, request, out_file) < 0) {
+            fflush (out_file);
+            break;
+        }
+        fflush (out_file);
+    }
+}
+
+// Serves clients on a Unix socket, one connection at a time, until a shutdown or stop request
+// Returns -1 if the socket cannot be set up; the socket file is removed when the server stops
+
+int serve_unix_socket (Schedule_server *server, const char *socket_path) {
+    struct sockaddr_un address;
+    volatile sig_atomic_t *stop_requested = server->settings->stop_requested;
+    FILE *in_file;
+    FILE *out_file;
+    int listen_fd;
+    int fd;
+
+    if (strlen (socket_path) >= sizeof (address.sun_path))
+        return -1;
+    memset (&address, 0, sizeof (address));
+    address.sun_family = AF_UNIX;
+    strcpy (address.sun_path, socket_path);
+
+    listen_fd = socket (AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd < 0)
+        return -1;
+    unlink (socket_path);
+    if (bind (listen_fd, (struct sockaddr *) &address, sizeof (address)) != 0 || listen (listen_fd, 8) != 0) {
+        close (listen_fd);
+        return -1;
+    }
+
+    // A client that goes away mid-response must not take the server down
+    signal (SIGPIPE, SIG_IGN);
+
+    while (!server->shutdown && !(stop_requested != NULL && *stop_requested)) {
+        fd = accept (listen_fd, NULL, NULL);
+        if (fd < 0) {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        in_file = fdopen (fd, "r");
+        out_file = fdopen (dup (fd), "w");
+        if (in_file != NULL && out_file != NULL)
+            serve_requests (server, in_file, out_file);
+        if (in_file != NULL)
+            fclose (in_file);
+        else
+            close (fd);
+        if (out_file != NULL)
+            fclose (out_file);
+    }
+
+    close (listen_fd);
+    unlink (socket_path);
+    return 0;
+}
+
+
+// =================
+// UTILITY FUNCTIONS
+// =================
+
+// Finds the maximum of two given numbers
+
+double max (double a, double b) {
+    if (a >= b)
+        return a;
+    else 
+        return b;
+}
+
+// Returns a monotonic wall-clock time in seconds
+
+double get_wall_time () {
+    struct timespec now;
+    clock_gettime (CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+// Prints the resource matrix with calculated busytimes (links for src != dst, routers for src == dst), nothing if out_file is NULL
+
+void print_resource_matrix (FILE *out_file, Eval_state *state) {
+    double *busytimes;                       // Router state record of the source core
+    int N_columns = state->N_columns;
+    int M_rows = state->num_cores / N_columns;
+    int wrap = (state->route_table->routing == ROUTING_TORUS);     // Links also connect opposite edges of the mesh
+    int dx = 0;                              // Offset of the destination core in x-direction
+    int dy = 0;                              // Offset of the destination core in y-direction
+    double link_busytime = 0.0;              // Busytime of the link(s) src --> dst
+
+    if (out_file == NULL)
+        return;
+
+    fprintf(out_file, "\n\n");
+    for (int i = 0; i < state->num_cores; i++) {
+        busytimes = &state->busytimes[i * ROUTER_STATE_SLOTS];
+        for (int j = 0; j < state->num_cores; j++) {
+            dx = state->noc_nodes[j].x_cord - state->noc_nodes[i].x_cord;
+            dy = state->noc_nodes[j].y_cord - state->noc_nodes[i].y_cord;
+
+            if (i == j) {
+                fprintf(out_file, " | %.2lf", busytimes[ROUTER_SLOT]);
+                continue;
+            }
+
+            // On a torus with two rows or columns, both links of a dimension may lead to the same neighbour
+            link_busytime = 0.0;
+            if (dy == 0 && (dx == 1 || (wrap && dx == 1 - N_columns)))
+                link_busytime = max(link_busytime, busytimes[LINK_SLOT(EAST)]);
+            if (dy == 0 && (dx == -1 || (wrap && dx == N_columns - 1)))
+                link_busytime = max(link_busytime, busytimes[LINK_SLOT(WEST)]);
+            if (dx == 0 && (dy == 1 || (wrap && dy == 1 - M_rows)))
+                link_busytime = max(link_busytime, busytimes[LINK_SLOT(NORTH)]);
+            if (dx == 0 && (dy == -1 || (wrap && dy == M_rows - 1)))
+                link_busytime = max(link_busytime, busytimes[LINK_SLOT(SOUTH)]);
+            fprintf(out_file, " | %.2lf", link_busytime);
+        }
+        fprintf(out_file, " |\n\n");
+    }
+}
+
+// Prints the mapping and test schedule information for all PSO particles, nothing if out_file is NULL
+
+void print_pso_particle_info (FILE *out_file, PSO_particle *pso_particle, int num_particles, int num_test_cores, double *freq) {
+    int p = 0;
+    int i = 0;
+    int j = 0;
+    
+    if (out_file == NULL)
+        return;
+
+    for (p = 0; p < num_particles; p++) {
+        fprintf(out_file, " Particle %d\n", p + 1);
+
+        fprintf(out_file, " Test core IDs: \n");
+        for (i = 0; i < num_test_cores; i++)
+            fprintf(out_file, " %d\t", pso_particle[p].mapping.test_core[i]);
+
+        fprintf(out_file, "\n Corresponding IO pair IDs: \n");
+        for (i = 0; i < num_test_cores; i++)
+            fprintf(out_file, " %d\t", pso_particle[p].mapping.io_pair[i]);
+
+        fprintf(out_file, "\n Test frequencies (normalized): \n");
+        for (i = 0; i < num_test_cores; i++)
+            fprintf(out_file, " %.2lf\t", freq[pso_particle[p].mapping.freq_index[i]]);
+
+        fprintf(out_file, "\n Preemption points: \n");
+        for (i = 0; i < num_test_cores; i++)
+            fprintf(out_file, " %.2lf\t", pso_particle[p].mapping.preemption[i]);
+
+        fprintf(out_file, "\n Particle fitness: %.2lf", pso_particle[p].fitness);
+        fprintf(out_file, "\n\n"); 
+    }
+}
+
+// Prints the mapping and test schedule information for the global best PSO particle, nothing if out_file is NULL
+
+void print_global_best_info (FILE *out_file, Gbest_PSO_particle *gbest_pso_particle, int num_test_cores, double *freq) {
+    int i = 0;
+
+    if (out_file == NULL)
+        return;
+    fprintf(out_file, " Global best info\n");
+
+    fprintf(out_file, " Test core IDs: ");
+    for (i = 0; i < num_test_cores; i++)
+        fprintf(out_file, " %d\t", gbest_pso_particle->gbest_mapping.test_core[i]);
+
+    fprintf(out_file, "\n Corresponding IO pair IDs: ");
+    for (i = 0; i < num_test_cores; i++)
+        fprintf(out_file, " %d\t", gbest_pso_particle->gbest_mapping.io_pair[i]);
+
+    fprintf(out_file, "\n Test frequencies (normalized): ");
+    for (i = 0; i < num_test_cores; i++)
+        fprintf(out_file, " %.2lf\t", freq[gbest_pso_particle->gbest_mapping.freq_index[i]]);
+
+    fprintf(out_file, "\n Preemption points: ");
+    for (i = 0; i < num_test_cores; i++)
+        fprintf(out_file, " %.2lf\t", gbest_pso_particle->gbest_mapping.preemption[i]);
+
+    fprintf(out_file, "\n Particle fitness: %.2lf", gbest_pso_particle->gbest_fitness);
+    fprintf(out_file, "\n\n");
+}
+
+// Print IO schedule lists (nothing if out_file is NULL)
+
+void print_IO_schedule_lists (FILE *out_file, IO_head* head) {
+
+    IO_node *temp;
+    temp = head->head_node;
+
+    if (out_file == NULL)
+        return;
 
-    printf("\n");
+    fprintf(out_file, "\n");
     if (temp == NULL)
-        printf (" The List is Empty\n");
+        fprintf(out_file, " The List is Empty\n");
     else {
         while (temp != NULL) {
-            printf(" Test core: %d (%lf to %lf) -->",temp->test_core, temp->starttime, temp->endtime);
+            if (temp->num_segments > 1)
+                fprintf(out_file, " Test core: %d [%d/%d] (%lf to %lf) -->",temp->test_core, temp->segment_no + 1, temp->num_segments, temp->starttime, temp->endtime);
+            else
+                fprintf(out_file, " Test core: %d (%lf to %lf) -->",temp->test_core, temp->starttime, temp->endtime);
             temp=temp->next;
         }
-        printf("\n");
+        fprintf(out_file, "\n");
     }
 } 
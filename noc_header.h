@@ -1,11 +1,33 @@
+#include <stdio.h>
+#include <signal.h>
+#include <pthread.h>
+#include "noc_scheduler.h"
+
 // =================
 // MACRO DEFINITIONS
 // =================
 
-#define MAX_NUM_CORES 30                           // Maximum number of cores allowed for a NoC -- just for array declaration convenience
-#define MAX_IO_PAIRS 5                             // Maximum number of io pairs allowed for a NoC -- just for array declaration convenience
-#define NUM_PSO_PARTICLES 1                        // Number of PSO particles considered for simulation
+#define MAX_NUM_CORES 32767                        // Maximum number of cores allowed for a NoC -- mappings store core numbers as short
+#define MAX_IO_PAIRS 255                           // Maximum number of io pairs allowed for a NoC -- mappings store io pair numbers as unsigned char
+#define DEFAULT_NUM_PARTICLES 10                   // Number of PSO particles unless given on the command line
+#define DEFAULT_MAX_GENERATIONS 20                 // Number of search generations run unless given on the command line
 #define UNALLOCATED -1                             // To indicate UNALLOCATED field elements
+#define MAX_ROUTE_HOPS 256                         // Maximum number of hops on a route b/w two cores (M_rows + N_columns - 2 on a mesh)
+#define MAX_ROUTE_CHOICES 8                        // Maximum number of candidate routes b/w two cores
+#define NO_CUTOFF 1e300                            // Cutoff value for evaluations that have to run to completion
+#define GENOME_BYTES_PER_TEST (sizeof (float) + sizeof (short) + 2 * sizeof (unsigned char))  // Size of one position of a mapping
+
+// Routing algorithms -- route tables hold the legal minimal routes of the selected algorithm
+
+#define ROUTING_XY 0                               // Mesh, dimension order: X then Y
+#define ROUTING_YX 1                               // Mesh, dimension order: Y then X
+#define ROUTING_WEST_FIRST 2                       // Mesh, turn model: all WEST hops first, then X then Y or Y then X
+#define ROUTING_TORUS 3                            // Torus (wraparound links), shorter way round each ring, X then Y or Y then X
+
+// Evaluation results
+
+#define EVAL_COMPLETE 0                            // All test cores were scheduled
+#define EVAL_DOMINATED 1                           // Stopped early, the total testtime reaches the cutoff
 
 // NoC node parameter values
 
@@ -13,11 +35,73 @@
 #define INPUT_CORE 2                               // core_type flag value 2 corresponds to input core
 #define OUTPUT_CORE 3                              // core_type flag value 3 corresponds to output core       
 
-// PSO evolution constants
+// PSO evolution constants -- initial probabilities of moving an element towards the local best (ALPHA) and the global best (BETA)
 
 #define ALPHA 0.5
 #define BETA 0.5
 
+// Adaptive PSO coefficients -- the attraction probabilities are adjusted every generation from the success rate and the swarm diversity
+
+#define ADAPT_MIN 0.1                              // Bounds of the attraction probabilities
+#define ADAPT_MAX 0.9
+#define ADAPT_STEP 0.05                            // Directed adjustment per generation
+#define ADAPT_JITTER 0.02                          // Bound of the random perturbation added per generation
+#define ADAPT_SMOOTHING 0.2                        // Weight of the latest generation in the smoothed success rate
+#define ADAPT_SUCCESS_LOW 0.1                      // Below this success rate the swarm is stagnating
+#define ADAPT_DIVERSITY_LOW 0.1                    // Below this diversity the swarm has collapsed onto the global best
+
+// Preemption points are drawn from [PREEMPTION_MIN, PREEMPTION_MAX)
+
+#define PREEMPTION_MIN 0.1
+#define PREEMPTION_MAX 1.0
+
+// Swarm seeding -- part of the swarm starts from constructive schedules, the rest from Latin hypercube draws
+
+#define SEED_FRACTION 4                            // One particle in SEED_FRACTION (at least one) starts from a constructed mapping
+#define NUM_SEED_HEURISTICS 2                      // Constructions: longest test first on the least loaded io pair, or as a list schedule
+
+// Local search (memetic refinement of the global best)
+
+#define DEFAULT_REFINE_INTERVAL 10                 // Generations between two refinements unless given on the command line
+#define LOCAL_SEARCH_MAX_PASSES 3                  // Maximum number of improving passes per refinement
+#define LOCAL_SEARCH_WINDOW 4                      // Maximum distance a core is moved by an insertion move
+#define PREEMPTION_NUDGE 0.05                      // Step by which a preemption point is nudged
+
+// Search engines -- every engine scores mappings with the same evaluator on the same precomputed tables
+
+#define ENGINE_PSO 0                               // Particle swarm optimization (with memetic refinement)
+#define ENGINE_SA 1                                // Simulated annealing
+#define ENGINE_GA 2                                // Permutation genetic algorithm
+#define ENGINE_TABU 3                              // Tabu search
+#define ENGINE_BNB 4                               // Exact branch-and-bound over test order and io pairs (tests unpreempted)
+#define NUM_ENGINES 5
+#define ANNEALING_MOVES 16                         // Annealing moves per generation
+#define ANNEALING_START_TEMPERATURE 0.05           // Initial temperature as a fraction of the initial total testtime
+#define ANNEALING_END_TEMPERATURE 0.0005           // Final temperature (same scale), reached at the end of the generation or time budget
+#define GA_POPULATION 16                           // Mappings per GA generation
+#define GA_MUTATION_RATE 0.2                       // Probability that a child mapping is mutated
+#define TABU_CANDIDATES 16                         // Neighbour moves sampled per tabu generation
+#define TABU_TENURE 5                              // Generations a moved test core stays tabu
+#define MAX_TRACE_POINTS 64                        // Improvements of the best total testtime recorded per run
+#define MAX_BENCHMARK_RUNS 16                      // Maximum number of runs per engine in a benchmark
+#define BENCHMARK_RUNS 3                           // Runs per engine unless given on the command line
+#define BENCHMARK_TIME_LIMIT 1.0                   // Wall-clock budget per benchmark run unless given on the command line
+#define BENCHMARK_TOLERANCE 0.01                   // Time-to-quality target: within 1% of the best total testtime found by any run
+
+// IO placement search
+
+#define PLACEMENT_CANDIDATES 16                    // Neighbouring placements scored per round of the placement search
+#define PLACEMENT_ROUNDS 32                        // Rounds of the placement search unless given on the command line
+#define PLACEMENT_GENERATIONS 40                   // Generations of the inner search that scores a placement unless given on the command line
+#define PLACEMENT_PATIENCE 4                       // Rounds without improvement after which a sampled neighbourhood is given up
+#define PLACEMENT_CACHE_SIZE 4096                  // Slots of the placement cache (power of 2)
+
+// Exact solver
+
+#define EXACT_SYNC_NODES 1024                      // Nodes a branch-and-bound worker explores between two looks at the shared incumbent and the deadline
+#define EXACT_TABLE_SIZE (1 << 18)                 // Slots of a worker's table of explored partial schedules (power of 2)
+#define EXACT_TABLE_DEPTH 3                        // Partial schedules with fewer tests left are not looked up in the table
+
 // Router ports
 
 // 16 Valid Router Statuses -- in accordance with XY routing
@@ -40,11 +124,27 @@
 
 #define EJECTION 0
 
-// Busyports struct 2D array second indices - indicating if the port and busytime information is for OUTPUT port corresponding to port index or INPUT port corresponding to port index
+// Port pair second indices - indicating if the port and busytime information is for OUTPUT port corresponding to port index or INPUT port corresponding to port index
 
 #define INPUT 0
 #define OUTPUT 1
 
+// Router state record -- per router, ROUTER_STATE_SLOTS contiguous busytimes and one packed word of port pair assignments
+// Port pair (port, type): the INPUT port connected to OUTPUT port `port` (type INPUT) or the OUTPUT port connected to INPUT port `port`
+// (type OUTPUT). For instance, WEST stored for (EAST, INPUT) implies WEST is the INPUT port corresponding to OUTPUT port EAST
+
+#define PORT_PAIR_SLOT(port, type) ((type) * 5 + (port))  // Busytime slot of a port pair (0 .. 9)
+#define ROUTER_SLOT 10                                    // Busytime slot of the router (latest among its port pairs)
+#define LINK_SLOT(out_port) (10 + (out_port))             // Busytime slot of the outgoing link through NORTH/EAST/SOUTH/WEST (11 .. 14)
+#define ROUTER_STATE_SLOTS 16                             // Busytime slots per router (padded to two cache lines)
+#define PORT_FIELD_BITS 3                                 // Bits per port number in the packed port pair word
+#define PORT_FIELD_MASK 7                                 // Packed value of UNALLOCATED
+#define PORT_MAP_UNALLOCATED 0x3fffffffu                  // Packed port pair word with all 10 port pairs UNALLOCATED
+
+// Preemption -- a test is split into segments of preemption_point * test_patterns patterns, resumed later on any io pair
+
+#define MAX_SEGMENTS_PER_CORE 10                   // Maximum number of segments per test (1 / PREEMPTION_MIN)
+
 // To indicate test completion (completion of all preemption instances)
 
 #define LAST_TEST_ADMINISTERED -73
@@ -53,6 +153,77 @@
 #define FILLED 1
 #define NOT_FILLED 0
 
+// Batch mode
+
+#define MAX_PATH_LENGTH 512                        // Maximum length of a file path in the batch manifest
+#define MAX_BATCH_THREADS 64                       // Maximum number of worker threads in the batch pool
+
+// Schedule validation -- event types and segment states of the discrete-event replay
+
+#define SIM_SETUP 0                                // A segment sets up its circuit
+#define SIM_PATTERN 1                              // One test pattern of a segment has been applied
+#define SIM_TEARDOWN 2                             // A segment releases its circuit
+#define SIM_WAITING 0                              // Circuit not set up yet
+#define SIM_ACTIVE 1                               // Circuit set up, patterns being applied
+#define SIM_DONE 2                                 // Circuit torn down
+#define MAX_REPORTED_CONFLICTS 8                    // Overlaps kept in a conflict report (all are counted)
+
+// Schedule export
+
+#define SCHEDULE_MAGIC "NOCSCHED"                  // First 8 bytes of every binary schedule file
+#define SCHEDULE_VERSION 1                         // Binary schedule file format version
+#define EXPORT_NONE 0                              // Export formats of the reported schedule
+#define EXPORT_BINARY 1
+#define EXPORT_CSV 2
+#define EXPORT_JSON 3
+
+// Scheduling server
+
+#define MAX_SERVER_DESIGNS 16                      // Designs kept resident by the scheduling server
+#define MAX_REQUEST_LENGTH 8192                    // Maximum length of a request line
+
+// Profiling build (-DNOC_PROFILE) -- cycle counts of the evaluation phases, route hops and swarm operators, per site and per
+// call stack of sites (folded-stack output); without NOC_PROFILE the profiling sites compile to nothing
+
+#define PROFILE_SEARCH 0                           // Profiling sites
+#define PROFILE_GENERATION 1
+#define PROFILE_SWAP_IO_PAIR 2
+#define PROFILE_SWAP_FREQUENCY 3
+#define PROFILE_SWAP_SEQUENCE 4
+#define PROFILE_SWAP_TEST_CORES 5
+#define PROFILE_LOCAL_SEARCH 6
+#define PROFILE_ADAPT 7
+#define PROFILE_FULL_EVALUATION 8
+#define PROFILE_DELTA_EVALUATION 9
+#define PROFILE_PREPARE 10
+#define PROFILE_SCHEDULE_TEST 11
+#define PROFILE_RESUME 12
+#define PROFILE_SELECT_ROUTE 13
+#define PROFILE_ROUTER_HOP 13                      // + output port (NORTH .. WEST)
+#define PROFILE_LINK_HOP 17                        // + output port (NORTH .. WEST)
+#define NUM_PROFILE_SITES 22
+#define PROFILE_BUCKETS 40                         // Histogram buckets per site (bucket b: 2^b .. 2^(b+1) - 1 cycles)
+#define MAX_PROFILE_DEPTH 16                       // Deepest stack of sites recorded
+#define MAX_PROFILE_NODES 512                      // Distinct stacks of sites recorded
+
+#ifdef NOC_PROFILE
+#define PROFILE_ENTER(profile, site) profile_enter (profile, site)
+#define PROFILE_EXIT(profile) profile_exit (profile)
+#else
+#define PROFILE_ENTER(profile, site) ((void) 0)
+#define PROFILE_EXIT(profile) ((void) 0)
+#endif
+
+// Evaluation arena -- scratch memory of full evaluations (evaluation state, IO schedule list nodes, times list)
+
+#define EVAL_ARENA_SIZE 65536                      // Initial size of an evaluation arena in bytes (grows to the largest evaluation seen)
+#define EVAL_ARENA_ALIGN 16                        // Alignment of every arena allocation
+
+// Checkpoints
+
+#define CHECKPOINT_MAGIC "NOCPSOCK"                // First 8 bytes of every checkpoint file
+#define CHECKPOINT_VERSION 5                       // Checkpoint file format version
+
 // NoC node
 
 typedef struct {
@@ -71,6 +242,8 @@ struct _io_node {
     double starttime;                              // Test start time
     double endtime;                                // Test end time
     int test_core;                                 // Core under test
+    int segment_no;                                // Segment of the test (0 --> first)
+    int num_segments;                              // Number of segments the test is split into
     struct _io_node *next;
 };
 
@@ -93,40 +266,37 @@ typedef struct {
     IO_head *io_head;                              // IO schedule list head
 } IO_pairs;
 
+// Mapping (genome of a PSO particle) -- per position of the test core sequence, the test core, the io pair of its first segment,
+// its test frequency and its preemption point. The four arrays share one heap block sized by the number of tests (init_genome)
+
+typedef struct {
+    int num_tests;                                 // Number of positions of the mapping
+    short *test_core;                              // Test core sequence (permutation of the test core numbers) -- gives order of testing
+    unsigned char *io_pair;                        // IO pair assigned to each test
+    unsigned char *freq_index;                     // Test frequency of each test (index into the valid test frequencies)
+    float *preemption;                             // Preemption point of each test (start of the block)
+} Genome;
+
 // PSO particle
 
 typedef struct {
-    double mapping[4 * MAX_NUM_CORES];             // Mapping structure: | test core ids | io pairs assigned | test frequency | preemptions |
+    Genome mapping;                                // Mapping of the particle
     double testtime;                               // Test time required for testing all the cores with the current mapping
     double SNR;                                    // Worst case SNR generated at the time of testing
     double communication_cost;                     // Communication cost for the given mapping (number of active MRs * number of test packets)
     double fitness;                                // Fitness function value calculated for the given mapping
-    double lbest_mapping[4 * MAX_NUM_CORES];       // The mapping corresponding to the best fitness function value obtained this particle till now
+    Genome lbest_mapping;                          // The mapping corresponding to the best fitness function value obtained this particle till now
     double lbest_fitness;                          // The best fitness function value obtained this particle till now
+    int dominated;                                 // Set if the last evaluation stopped at the cutoff (testtime is then only a lower bound)
 } PSO_particle;
 
 // Global best particle
 
 typedef struct {
-    double gbest_mapping [4 * MAX_NUM_CORES];      // The mapping corresponding to the best fitness function value obtained this among all particles
+    Genome gbest_mapping;                          // The mapping corresponding to the best fitness function value obtained this among all particles
     double gbest_fitness;                          // The best fitness function value obtained among all particles 
 } Gbest_PSO_particle;
 
-typedef struct {
-    int port; 
-    double busytime;
-} Busyports;
-
-// Resource matrix
-
-typedef struct {
-    double busytime;                               // If the resource status is BUSY, this field gives the time till which the resource remains occupied  
-    Busyports busyports[5][2];                     // If the resource type is a router, this structure tracks all ACTIVE busy statuses and their busytimes
-                                                   // First index gives port, second index gives the port type for which information is stored
-                                                   // For instance, busyports[EAST][INPUT].port = WEST implies, the WEST is the INPUT port corresponding
-                                                   // to OUTPUT port EAST, busytime for corresponding pair is stored in busyports[EAST][INPUT].busytimes
-} Resource;
-
 // Swap operators
 
 typedef struct {
@@ -134,6 +304,14 @@ typedef struct {
     int swap_idx2;                                 // Index of the second element to be swapped 
 } Swap_operator;
 
+// Scratch space of the swap operator sequence generation (allocated once per PSO run, reused for every particle)
+
+typedef struct {
+    int *sequence;                                 // Test core sequence being transformed into the target sequence (core numbers)
+    int *position;                                 // Position of every core number in sequence (indexed by core number)
+    Swap_operator *swap_operators;                 // Generated sequence of swap operators
+} Swap_scratch;
+
 // Sorted list of all starttimes and endtimes
 // (Used to create CLAP input list)
 
@@ -156,78 +334,1005 @@ typedef struct {
 // CLAP input list
 
 struct _clap_inputs {
-    Test_signals test_signals[2 * MAX_IO_PAIRS];
+    Test_signals *test_signals;                    // Two per io pair
     struct _clap_inputs *next;
 };
 
 typedef struct _clap_inputs Clap_inputs;
 
+// Parsed SoC description (one input file)
+
+typedef struct {
+    int M_rows;                                    // Number of rows in the mesh network
+    int N_columns;                                 // Number of columns in the mesh network
+    int num_cores;                                 // Total number of cores in the mesh network
+    int num_io_pairs;                              // Number of io pairs available
+    int num_test_cores;                            // Number of test cores
+    NoC_node *noc_nodes;                           // NoC node structure array
+    IO_pairs *io_pairs;                            // IO pairs structure array
+} NoC_design;
+
+// Route hop -- one router (input port --> output port) and the link leaving it
+
+typedef struct {
+    int router;                                    // Core number of the router
+    int in_port;                                   // Router input port
+    int out_port;                                  // Router output port (direction of the outgoing link)
+    int next;                                      // Core number at the other end of the outgoing link
+} Route_hop;
+
+// Candidate route -- a minimal route is fixed by its dimension order and the steps along each dimension (see find_dimension_order_route)
+
+typedef struct {
+    signed char x_first;                           // Set if the route moves in x-direction before y-direction
+    signed char x_step;                            // +1 --> EAST, -1 --> WEST
+    signed char y_step;                            // +1 --> NORTH, -1 --> SOUTH
+    short num_x_hops;                              // Number of hops in x-direction
+    short num_y_hops;                              // Number of hops in y-direction
+} Route_shape;
+
+// Route table -- depends only on the mesh dimensions and the routing algorithm, shared by all designs with the same mesh
+// Candidate routes only depend on the offset b/w the two cores (dx, dy), so the table holds one entry per offset, not per core pair;
+// the hops of a route are expanded when they are needed (find_candidate_route)
+
+struct _route_table {
+    int M_rows;                                    // Number of rows in the mesh network
+    int N_columns;                                 // Number of columns in the mesh network
+    int num_cores;                                 // Total number of cores in the mesh network
+    int routing;                                   // Routing algorithm the candidate routes follow (ROUTING_*)
+    int *hop_length;                               // hop_length[offset]: hop length used by the testtime model b/w two cores at that offset
+    int *num_routes;                               // num_routes[offset]: number of candidate routes b/w two cores at that offset
+    Route_shape *routes;                           // [offset * MAX_ROUTE_CHOICES + r]: candidate route r
+    struct _route_table *next;
+};
+
+typedef struct _route_table Route_table;
+
+// Testtime table -- testtime coefficients for every (test core, io pair) combination of a design
+// Testtime = (cycles_per_pattern * patterns applied + tail_cycles) / frequency
+
+struct _testtime_table {
+    int num_cores;                                 // Total number of cores in the mesh network
+    int num_io_pairs;                              // Number of io pairs available
+    int *cycles_per_pattern;                       // [(test_core - 1) * num_io_pairs + (io_pair - 1)]: [1 + Max{hop_length_ic, hop_length_co} + scan_chain_length - 1]
+    int *tail_cycles;                              // [(test_core - 1) * num_io_pairs + (io_pair - 1)]: Min{hop_length_ic, hop_length_co}
+    int *key;                                      // Design parameters the table was built from (mesh, io pairs, core parameters)
+    int key_length;                                // Number of elements in key
+    Route_table *route_table;                      // Route table the coefficients were derived from
+    int ref_count;                                 // Number of jobs currently using this table
+    struct _testtime_table *next;
+};
+
+typedef struct _testtime_table Testtime_table;
+
+// Cache of route and testtime tables shared by concurrently scheduled designs
+
+typedef struct {
+    Route_table *route_tables;                     // List of route tables (one per mesh dimension and routing algorithm)
+    Testtime_table *testtime_tables;               // List of testtime tables (one per distinct design)
+    pthread_mutex_t lock;                          // Protects both lists and the reference counts
+} Table_cache;
+
+// Lower bounds on the total testtime of a design
+
+typedef struct {
+    double io_workload;                            // Cheapest total test workload balanced across all io pairs
+    double longest_test;                           // Cheapest testtime of the longest test
+    double link_cut;                               // Cheapest load on the links across the most loaded mesh cut
+    double best;                                   // Maximum of the bounds above
+} Lower_bounds;
+
+// Improvements of the best total testtime over a search run
+
+typedef struct {
+    int num_points;                                // Number of improvements recorded
+    double time[MAX_TRACE_POINTS];                 // Seconds since the start of the run
+    double testtime[MAX_TRACE_POINTS];             // Best total testtime from then on
+} Search_trace;
+
+// Profile node -- one distinct stack of profiling sites
+
+typedef struct {
+    int site;                                      // Innermost site of the stack (PROFILE_*)
+    int parent;                                    // Node of the stack without its innermost site (-1 --> root)
+    int first_child;                               // First node extending this stack by one site (-1 --> none)
+    int next_sibling;                              // Next node with the same parent (-1 --> none)
+    unsigned long long cycles;                     // Cycles spent in this stack, including deeper sites
+    unsigned long long calls;                      // Number of times this stack was entered
+} Profile_node;
+
+// Cycle profile of a run (profiling builds only)
+
+typedef struct {
+    Profile_node nodes[MAX_PROFILE_NODES];         // Stacks of sites seen so far (node 0 --> root, no site)
+    int num_nodes;                                 // Number of nodes in use
+    int current;                                   // Node of the stack of sites currently open
+    int depth;                                     // Number of sites currently open
+    int open_site[MAX_PROFILE_DEPTH];              // Each open site
+    int open_node[MAX_PROFILE_DEPTH];              // Node of each open site (-1 --> not recorded in the stack tree)
+    unsigned long long open_time[MAX_PROFILE_DEPTH];   // Cycle counter when each open site was entered
+    unsigned long long site_cycles[NUM_PROFILE_SITES];     // Cycles per site, including deeper sites
+    unsigned long long site_calls[NUM_PROFILE_SITES];      // Calls per site
+    unsigned long long histogram[NUM_PROFILE_SITES][PROFILE_BUCKETS];   // Cycles per call, log2 buckets per site
+    long num_dropped;                              // Calls missing from the stack tree (past the node pool, or past MAX_PROFILE_DEPTH and not counted at all)
+} Profile;
+
+// Overflow block of an evaluation arena (used until the next reset merges it into the arena block)
+
+struct _arena_block {
+    struct _arena_block *next;
+    double data[];                                 // Allocation (double --> aligned for every scratch struct)
+};
+
+typedef struct _arena_block Arena_block;
+
+// Bump allocator for the scratch memory of one evaluation -- reset in O(1) when the next evaluation starts
+// An evaluation that does not fit spills into overflow blocks; the reset then grows the arena block to hold it, so that in
+// steady state evaluations make no heap calls
+
+typedef struct {
+    char *base;                                    // Arena block
+    size_t size;                                   // Size of the arena block in bytes
+    size_t used;                                   // Bytes handed out from the arena block since the last reset
+    size_t spilled;                                // Bytes handed out from overflow blocks since the last reset
+    Arena_block *overflow;                         // Overflow blocks allocated since the last reset
+    long num_heap_calls;                           // Number of mallocs done by the arena (arena and overflow blocks)
+} Eval_arena;
+
+// Per-run settings and state of a PSO run
+
+typedef struct {
+    FILE *out_file;                                // Stream receiving the schedule and trace output (stdout for single runs, NULL --> no output)
+    Testtime_table *testtime_table;                // Precomputed testtimes for the design (NULL --> computed from the node structs)
+    double *freq;                                  // Valid test frequencies (normalized wrt default test freq), indexed by Genome.freq_index
+    int num_freq;                                  // Number of valid test frequencies
+    int routing;                                   // Routing algorithm (ROUTING_*)
+    int validate;                                  // Set to replay the reported schedule in the discrete-event simulator
+    int check;                                     // Set to check the reported schedule for conflicting resource use
+    int export_format;                             // Export format of the reported schedule (EXPORT_*)
+    const char *export_file;                       // File the reported schedule is exported to (NULL --> schedule.<format>)
+    Route_table *route_table;                      // Candidate routes of the design's mesh (NULL --> built for the run)
+    unsigned short rng_state[3];                   // State of the run's random number generator (erand48/nrand48)
+    int num_particles;                             // Number of PSO particles (swarm size)
+    int max_generations;                           // Number of PSO generations to run
+    int generation;                                // Number of generations completed so far
+    const char *checkpoint_file;                   // File the optimiser state is periodically written to (NULL --> no checkpoints)
+    int checkpoint_interval;                       // Number of generations between two checkpoints
+    const char *resume_file;                       // Checkpoint to resume from (NULL or unreadable --> fresh start)
+    double time_limit;                             // Wall-clock budget of the run in seconds (0 --> no limit)
+    volatile sig_atomic_t *stop_requested;         // Set asynchronously (e.g. by a SIGINT/SIGTERM handler) to stop at the next generation boundary
+    int stopped_early;                             // Set when the run ended before max_generations (deadline or stop request)
+    int refine_interval;                           // Generations between two local search refinements of the global best (0 --> never)
+    long num_full_evaluations;                     // Number of complete find_resource_busytimes passes
+    long num_delta_evaluations;                    // Number of delta evaluations done by the local search
+    long num_dominated_evaluations;                // Number of evaluations stopped early at their cutoff
+    Lower_bounds lower_bounds;                     // Lower bounds of the design being scheduled
+    double target_gap;                             // Stop once the global best is within this relative gap of the lower bound (0 --> never)
+    int target_reached;                            // Set when the run ended because the target gap was reached
+    int engine;                                    // Search engine of the run (ENGINE_*)
+    Search_trace trace;                            // Improvements of the best total testtime during the run
+    int num_threads;                               // Worker threads of the exact solver (0 --> one per online CPU)
+    int adaptive;                                  // Set to adapt the attraction probabilities online (0 --> fixed ALPHA and BETA)
+    int seeding;                                   // Set to start part of the swarm from constructive schedules (0 --> random start)
+    double alpha;                                  // Current probability of moving an element towards the local best
+    double beta;                                   // Current probability of moving an element towards the global best
+    double success_rate;                           // Smoothed fraction of particles improving their local best per generation
+    double diversity;                              // Mean fraction of mapping elements in which the particles differ from the global best
+    Eval_arena *arena;                             // Scratch memory of full evaluations (NULL --> created for the run)
+    Genome *best_mapping;                          // Receives the best mapping of the run (caller-allocated, NULL --> not kept)
+    Profile *profile;                              // Cycle profile of the run (profiling builds, NULL --> not profiled)
+    const char *profile_file;                      // File the folded stacks of the profile are written to (NULL --> no profile)
+    int hierarchical;                              // Set to schedule the mesh region by region and merge the region schedules
+    const char *warm_start_file;                   // Binary schedule of an earlier version of the design the swarm starts from (NULL --> random start)
+} PSO_context;
+
+// Scheduling problem handed to a search engine -- the design, and the run it is searched in (settings, random state, shared tables)
+
+typedef struct {
+    NoC_node *noc_nodes;
+    int num_cores;
+    int N_columns;
+    int num_test_cores;
+    IO_pairs *io_pairs;
+    int num_io_pairs;
+    double *freq;                                  // Valid test frequencies
+    int num_freq;
+    PSO_context *context;
+    double start_time;                             // Wall-clock time the run started at
+    double deadline;                               // Wall-clock time at which the run has to stop (0 --> none)
+} Search_problem;
+
+// Evaluation journal entry -- previous value of a modified busytime (and port)
+
+typedef struct {
+    double *time;                                  // Modified busytime
+    double old_time;                               // Its value before the modification
+    unsigned int *port_map;                        // Modified packed port pair word (NULL if only the busytime changed)
+    unsigned int old_port_map;                     // Its value before the modification
+} Journal_entry;
+
+// Scheduled test segment
+
+typedef struct {
+    int position;                                  // Position of the test in the mapping
+    int test_core;                                 // Core under test
+    int io_pair;                                   // IO pair the segment runs on
+    int segment_no;                                // Segment number within the test (0 --> first)
+    int num_patterns;                              // Number of patterns applied in the segment
+    int route_ic;                                  // Candidate route taken from the input core to the test core
+    int route_co;                                  // Candidate route taken from the test core to the output core
+    double starttime;                              // Segment starttime
+    double endtime;                                // Segment endtime
+    int next_segment;                              // Number of the segment that resumes the test, LAST_TEST_ADMINISTERED if the test is complete
+} Test_segment;
+
+// Pending segment of a preempted test (priority queue entry)
+
+typedef struct {
+    double ready_time;                             // Time at which the previous segment of the test ends
+    int position;                                  // Position of the test in the mapping
+    int segment_no;                                // Segment number within the test
+} Segment_event;
+
+// Evaluation state -- resources and io pairs after scheduling a prefix of the test core sequence of a mapping
+
+typedef struct {
+    NoC_node *noc_nodes;                           // Design the state belongs to
+    int N_columns;
+    int num_cores;
+    int num_test_cores;
+    IO_pairs *io_pairs;
+    int num_io_pairs;
+    PSO_context *context;                          // Run the state is used in (testtime table, counters)
+    Route_table *route_table;                      // Candidate routes b/w all pairs of cores
+    double *busytimes;                             // [(router - 1) * ROUTER_STATE_SLOTS + slot]: port pairs, router and outgoing links
+    unsigned int *port_maps;                       // [router - 1]: port pair assignments, PORT_FIELD_BITS per port pair
+    double *io_busytime;                           // [io_pair - 1]: time till which each io pair is busy
+    double makespan;                               // Latest busytime among all resources
+    double cutoff;                                 // Scheduling stops once the total testtime is known to reach this value
+    double bound;                                  // Lower bound on the total testtime found while checking the cutoff
+    double *remaining_workload;                    // [io_pair - 1]: testtimes still to be scheduled per io pair (only maintained with a cutoff)
+    double *testtime;                              // Testtime of the first segment of the core at each position
+    double *starttime;                             // Starttime of the first segment of the core at each position
+    double *endtime;                               // Endtime of the first segment of the core at each position
+    Test_segment *segments;                        // All segments scheduled so far, in scheduling order (MAX_SEGMENTS_PER_CORE per test)
+    int num_segments;                              // Number of segments scheduled so far
+    int *segment_mark;                             // [position]: number of segments before the position was scheduled (num_test_cores + 1)
+    Segment_event *pending;                        // Pending segments of preempted tests (heap, at most one per test)
+    int num_scheduled;                             // Number of positions scheduled so far (num_test_cores + 1 once the resumed segments are scheduled)
+    int num_valid;                                 // Number of leading positions known to match the mapping (delta evaluation)
+    int journaling;                                // Set if changes are journaled (needed for rollback)
+    Journal_entry *journal;                        // Journal of all changes, in order
+    int journal_size;                              // Number of journal entries in use
+    int journal_capacity;                          // Number of journal entries allocated
+    int *journal_mark;                             // [position]: journal size before the position was scheduled (num_test_cores --> resumed segments)
+    Profile *profile;                              // Cycle profile the evaluations are recorded in (NULL --> not profiled)
+} Eval_state;
+
+// Discrete-event replay -- event
+
+struct _sim_event {
+    double time;                                   // Time at which the event happens
+    int type;                                      // SIM_SETUP, SIM_PATTERN or SIM_TEARDOWN
+    int segment;                                   // Index of the segment in the evaluation state
+    struct _sim_event *next;                       // Next event in the same bucket (or in the free list)
+};
+
+typedef struct _sim_event Sim_event;
+
+// Calendar queue -- pending events hashed by time into buckets of bucket_width, one "year" spans num_buckets * bucket_width
+
+typedef struct {
+    Sim_event **buckets;                           // Time-ordered event list per bucket
+    int num_buckets;                               // Number of buckets (power of 2)
+    double bucket_width;                           // Time span of a bucket
+    int current_bucket;                            // Bucket holding the current time
+    double bucket_top;                             // End of the current bucket in the current year
+    int size;                                      // Number of pending events
+    Sim_event *pool;                               // Preallocated events
+    Sim_event *free_list;                          // Unused events of the pool
+} Calendar_queue;
+
+// Discrete-event replay -- state of one segment
+
+typedef struct {
+    int status;                                    // SIM_WAITING, SIM_ACTIVE or SIM_DONE
+    int prev_test;                                 // Previous segment of the same test (UNALLOCATED if none)
+    int prev_io;                                   // Previous segment on the same io pair (UNALLOCATED if none)
+    int setup_pending;                             // Set while a SIM_SETUP event of the segment is queued
+    int conflicted;                                // Set once a setup of the segment found a port held by another circuit
+    int first_waiter;                              // Segments whose setup waits for this circuit to be torn down (UNALLOCATED if none)
+    int last_waiter;
+    int next_waiter;                               // Next segment waiting for the same teardown
+    int patterns_left;                             // Number of patterns still to be applied
+    double setup_time;                             // Circuit setup latency
+    double pattern_time;                           // Time per pattern
+    double tail_time;                              // Time from the last pattern to the teardown
+    double starttime;                              // Time the circuit was set up
+    double endtime;                                // Time the circuit was torn down
+} Sim_segment;
+
+// Result of a schedule replay
+
+typedef struct {
+    double predicted_makespan;                     // Total testtime predicted by the busytime model
+    double simulated_makespan;                     // Total testtime achieved in the replay
+    int num_segments;                              // Number of segments replayed
+    long num_events;                               // Number of events processed
+    int num_conflicts;                             // Number of segments whose setup found a port or link held by another circuit
+    int num_delayed;                               // Number of segments set up later than scheduled
+    double max_delay;                              // Largest setup delay
+    int num_incomplete;                            // Number of segments that never completed (event pool overflow)
+    int first_conflict_core;                       // Test core, router and time of the first conflict
+    int first_conflict_router;
+    double first_conflict_time;
+} Sim_report;
+
+// Conflict checker -- use of one router port by one segment
+// Resource (router, side, port) is numbered (router - 1) * 10 + side * 5 + port with side INPUT or OUTPUT
+
+typedef struct {
+    int resource;                                  // Router port used
+    int segment;                                   // Index of the segment in the evaluation state
+    double starttime;                              // Interval during which the segment's circuit holds the port
+    double endtime;
+} Resource_interval;
+
+// Conflict checker -- two segments holding the same router port at the same time
+
+typedef struct {
+    int router;                                    // Router, side (INPUT/OUTPUT) and port held twice
+    int side;
+    int port;
+    int core[2];                                   // Test cores of the earlier and the later segment
+    int segment_no[2];                             // Their segment numbers
+    double starttime[2];                           // Their intervals on the port
+    double endtime[2];
+} Schedule_conflict;
+
+// Result of a conflict check
+
+typedef struct {
+    int num_intervals;                             // Number of resource intervals checked
+    int num_conflicts;                             // Number of intervals starting before an earlier one on the same port has ended
+    Schedule_conflict conflicts[MAX_REPORTED_CONFLICTS];    // The first conflicts in (router, side, port, time) order
+} Conflict_report;
+
+// Binary schedule file header, followed by the sections at the given offsets (host byte order, every record 8-byte aligned)
+// The in-memory layout of a Schedule_view is identical, so a mapped file is used without any decoding
+
+typedef struct {
+    char magic[8];                                 // SCHEDULE_MAGIC
+    int version;                                   // SCHEDULE_VERSION
+    int routing;                                   // Routing algorithm of the routes (ROUTING_*)
+    int num_cores;                                 // Mesh of the design
+    int N_columns;
+    int num_test_cores;                            // Number of mapping records
+    int num_io_pairs;                              // Number of io pair records
+    int num_segments;                              // Number of segment records
+    int num_intervals;                             // Number of router port occupancy records
+    double total_testtime;                         // Objectives of the schedule
+    double lower_bound;
+    double optimality_gap;
+    long long mapping_offset;                      // Byte offsets of the sections from the start of the file
+    long long io_pair_offset;
+    long long segment_offset;
+    long long interval_offset;
+    long long file_size;                           // Total size of the file
+} Schedule_file_header;
+
+// Binary schedule file -- one test of the mapping, in mapping order
+
+typedef struct {
+    int test_core;                                 // Test core number
+    int io_pair;                                   // IO pair of its first segment
+    double frequency;                              // Normalized test frequency
+    double preemption;                             // Preemption point
+} Schedule_file_mapping;
+
+// Binary schedule file -- one io pair and its segments (segment records first_segment .. first_segment + num_segments - 1)
+
+typedef struct {
+    int input_core;                                // Input and output core numbers
+    int output_core;
+    int first_segment;
+    int num_segments;
+} Schedule_file_io_pair;
+
+// Binary schedule file -- one segment, grouped by io pair in order of starttime
+
+typedef struct {
+    int io_pair;                                   // IO pair number
+    int test_core;                                 // Test core number
+    int segment_no;                                // Segment of the test (0 .. num_segments - 1)
+    int num_segments;                              // Number of segments of the test
+    int num_patterns;                              // Test patterns applied in this segment
+    int position;                                  // Position of the test in the mapping
+    int route_ic;                                  // Candidate routes input core --> test core and test core --> output core
+    int route_co;
+    double starttime;
+    double endtime;
+} Schedule_file_segment;
+
+// Binary schedule in memory -- built from an evaluation state or mapped from a file
+// The occupancy records are Resource_intervals sorted by router port and starttime, their segment is a segment record index
+
+typedef struct {
+    Schedule_file_header *header;
+    Schedule_file_mapping *mapping;
+    Schedule_file_io_pair *io_pairs;
+    Schedule_file_segment *segments;
+    Resource_interval *intervals;
+    void *base;                                    // Start of the header (and of the allocation or mapping)
+    int mapped;                                    // Set if base is a read-only file mapping
+} Schedule_view;
+
+// Checkpoint file header (followed by the particles and the global best, see save_pso_checkpoint)
+
+typedef struct {
+    char magic[8];                                 // CHECKPOINT_MAGIC
+    int version;                                   // CHECKPOINT_VERSION
+    int num_cores;                                 // Design the checkpoint belongs to
+    int num_io_pairs;
+    int num_particles;                             // Swarm size of the writing run
+    int generation;                                // Number of generations completed
+    unsigned short rng_state[3];                   // Random number generator state at the generation boundary
+    double alpha;                                  // Attraction probabilities and smoothed success rate at the generation boundary
+    double beta;
+    double success_rate;
+} Checkpoint_header;
+
+// Batch job (one SoC description to be scheduled)
+
+typedef struct {
+    char input_file[MAX_PATH_LENGTH];              // SoC description file
+    char output_file[MAX_PATH_LENGTH];             // File receiving the schedule for this job
+    long cost;                                     // Estimated job size, used to distribute the jobs among the workers
+    unsigned int seed;                             // Seed for the job's random number generator
+    int status;                                    // 0 on success, -1 if the job could not be scheduled
+} Batch_job;
+
+// Work deque -- the owner pops from the bottom, idle workers steal from the top
+
+typedef struct {
+    int *job_idx;                                  // Indices of the jobs queued on this worker
+    int top;                                       // Index of the oldest queued job (steal end)
+    int bottom;                                    // One past the index of the newest queued job (owner end)
+    pthread_mutex_t lock;
+} Work_deque;
+
+// Work-stealing pool running a batch of jobs
+
+typedef struct {
+    Batch_job *jobs;                               // Jobs of the batch
+    int num_jobs;                                  // Number of jobs in the batch
+    Work_deque *deques;                            // One work deque per worker
+    int num_workers;                               // Number of worker threads
+    Table_cache *table_cache;                      // Tables shared among the jobs
+    double *freq;                                  // Valid test frequencies (normalized wrt default test freq)
+    int num_freq;                                  // Number of valid test frequencies
+    PSO_context *settings;                         // PSO settings every job starts from
+} Batch_pool;
+
+typedef struct {
+    Batch_pool *pool;
+    int worker_no;
+} Batch_worker;
+
+// IO placement -- input and output core of every io pair, pairs in increasing order of input core (so that placements which only
+// number the io pairs differently are the same placement)
+
+typedef struct {
+    int num_io_pairs;                              // Number of io pairs placed
+    int *io_cores;                                 // [2 * (io_pair - 1)]: input core, [2 * (io_pair - 1) + 1]: output core
+} IO_placement;
+
+// Placement cache slot
+
+typedef struct {
+    IO_placement placement;                        // Placement scored (allocated when the slot is first used)
+    int used;                                      // Set once the slot holds a placement
+    int pruned;                                    // Set if the lower bounds ruled the placement out before an inner search
+    double testtime;                               // Best total testtime of the inner search (lower bound if pruned)
+} Placement_entry;
+
+// IO placement search -- state shared by the threads scoring the candidates of a round
+// Candidate designs keep the test core parameters of the input file in their order: they go to the test cores in increasing
+// core number, as if the input file had listed the candidate io pairs
+
+typedef struct {
+    NoC_design *design;                            // Design whose io pairs are placed
+    double *freq;                                  // Valid test frequencies (normalized wrt default test freq)
+    int num_freq;                                  // Number of valid test frequencies
+    PSO_context *settings;                         // Settings every inner search starts from
+    int generations;                               // Generations of every inner search
+    unsigned int seed;                             // Inner searches are seeded with seed + placement hash
+    Table_cache table_cache;                       // Route table of the mesh and testtime tables of the candidates
+    Placement_entry *cache;                        // Placements scored so far (PLACEMENT_CACHE_SIZE slots, open addressing)
+    IO_placement candidates[PLACEMENT_CANDIDATES]; // Candidates of the current round
+    double testtimes[PLACEMENT_CANDIDATES];        // Their best total testtimes (lower bounds if pruned)
+    int pruned[PLACEMENT_CANDIDATES];              // Set for candidates ruled out by their lower bounds
+    int num_candidates;                            // Number of candidates in the current round
+    double cutoff;                                 // Candidates whose lower bound reaches this are not searched (best testtime so far)
+    pthread_mutex_t lock;                          // Protects next_candidate
+    int next_candidate;                            // Next candidate of the round to be scored
+    long num_searches;                             // Inner searches run
+    long num_hits;                                 // Candidates found in the cache
+    long num_pruned;                               // Candidates ruled out by their lower bounds
+} Placement_search;
+
+// Exact solver -- branch-and-bound state shared by all workers
+// The first two levels of the tree (first test core and its io pair) are handed out to the workers one subtree at a time
+
+typedef struct {
+    Search_problem *problem;
+    double *testtimes;                             // [(test_core - 1) * num_io_pairs + (io_pair - 1)]: testtime of the unpreempted test
+    double *min_testtimes;                         // [test_core - 1]: testtime through the fastest io pair
+    int integral;                                  // Set if every testtime is a whole number (so is every total testtime)
+    int *order;                                    // Test cores, longest test first (branching order)
+    int transpositions;                            // Set if explored partial schedules are remembered (one candidate route per pair)
+    unsigned long long *slot_masks;                // [(test_core - 1) * num_mask_words + w]: busytime slots the routes of the test read, 64 per word
+    int num_mask_words;                            // Words of a slot mask
+    double *cut_loads;                             // [(test_core - 1) * num_cut_dirs + c]: least link time of the test across cut direction c
+    double *cut_shares;                            // [c]: 1 / number of links across cut direction c
+    int num_cut_dirs;                              // Cut directions of the mesh, two per row and column boundary (0 on a torus)
+    int freq_index;                                // Frequency every test runs at (the fastest one)
+    pthread_mutex_t lock;                          // Protects the fields below
+    double incumbent;                              // Total testtime of the best complete schedule found so far
+    Genome best;                                   // Mapping of the incumbent
+    int next_task;                                 // Next first-level subtree to explore
+    int num_tasks;                                 // Number of first-level subtrees (test cores * io pairs)
+    int stop;                                      // Set once the search has to end (deadline, stop request, lower bound reached)
+    int stopped_early;                             // Set if the search ended before the tree was exhausted (no proof of optimality)
+    long num_nodes;                                // Nodes explored by all finished workers
+    long num_hits;                                 // Partial schedules skipped by all finished workers as already explored
+} Exact_search;
+
+// Exact solver -- table entry of a partial schedule whose subtree was explored to the end
+// Partial schedules of the same tests with the same last starttime and the same busytimes from then on (on the resources the
+// remaining tests can use) have the same completions
+
+typedef struct {
+    unsigned long long key;                        // Hash of the tests placed, the last starttime and the busytimes that matter (0 --> empty)
+    double makespan;                               // Makespan of the partial schedule (completions of a larger one are no better)
+    int last_core;                                 // Last test core (a later test starting at the same time has a higher core number)
+} Exact_entry;
+
+// Exact solver -- per-worker state
+
+typedef struct {
+    Exact_search *search;
+    Eval_state *state;                             // Journaling evaluation state of the partial schedule
+    Genome mapping;                                // Partial schedule (positions before the current depth)
+    char *placed;                                  // [test_core]: set if the test core is in the partial schedule
+    int *io_order;                                 // [depth * num_io_pairs + j]: io pairs of a child, earliest possible end first
+    double *finish;                                // [depth * num_io_pairs + k]: earliest possible end of the child on io pair k + 1
+    double *io_free;                               // Scratch of the bound: times the io pairs become free, earliest first
+    double *cut_load;                              // [depth * num_cut_dirs + c]: link time of the tests not in the partial schedule across cut direction c
+    Exact_entry *table;                            // Partial schedules explored to the end (EXACT_TABLE_SIZE slots, NULL --> not remembered)
+    unsigned long long *slot_mask;                 // Scratch of the table: busytime slots the remaining tests read
+    double cutoff;                                 // Local copy of the incumbent
+    int stop;                                      // Local copy of the shared stop flag
+    long num_nodes;                                // Nodes explored by this worker
+    long num_hits;                                 // Partial schedules skipped as already explored
+    pthread_t thread;
+} Exact_worker;
+
+// Mesh region -- rectangular part of the mesh scheduled as a design of its own in hierarchical mode (a region holds whole io pairs)
+
+typedef struct {
+    int row0;                                      // First row of the region
+    int col0;                                      // First column of the region
+    int rows;                                      // Number of rows of the region
+    int cols;                                      // Number of columns of the region
+    int *io_pairs;                                 // IO pairs of the whole mesh in the region (io pair numbers)
+    int num_io_pairs;                              // Number of io pairs in the region
+    double workload;                               // Test workload of the region (patterns times scan chain length over its test cores)
+    NoC_design design;                             // The region as a design (core and io pair numbers local to the region)
+    int *core_map;                                 // [local core - 1]: core number in the whole mesh
+    PSO_context context;                           // Run the region is scheduled in
+    Genome best;                                   // Best mapping of the region (local core and io pair numbers)
+    double testtime;                               // Total testtime of the region's best mapping
+} Mesh_region;
+
+// Hierarchical mode -- regions handed out to the threads that schedule them
+
+typedef struct {
+    Mesh_region *regions;
+    int num_regions;
+    pthread_mutex_t lock;                          // Protects next_region
+    int next_region;                               // Next region to be scheduled
+} Region_pool;
+
+// Test of a region schedule -- the region mappings are merged by the starttimes of their tests
+
+typedef struct {
+    double starttime;                              // Starttime of the test's first segment in its region schedule
+    int region;                                    // Region of the test
+    int position;                                  // Position of the test in the region's mapping
+} Region_test;
+
+// Scheduler of one SoC description (library context, and resident design of the scheduling server)
+
+struct _noc_scheduler {
+    char file_name[MAX_PATH_LENGTH];               // SoC description file the design was loaded from
+    NoC_design design;                             // Parsed SoC description
+    PSO_context context;                           // Settings, random state, tables and lower bounds of the design
+    Eval_state *state;                             // Journaling evaluation state shared by all evaluations
+    Genome last_mapping;                           // Mapping last evaluated in state (its valid prefix is reused)
+    long num_evaluations;                          // Number of evaluations served
+    Table_cache *table_cache;                      // Cache holding the design's tables (own_tables unless shared)
+    Table_cache own_tables;                        // Tables of a scheduler that shares none
+    double freq[1];                                // Valid test frequencies unless given by the owner (default test frequency only)
+    volatile sig_atomic_t stop;                    // Set by cancel_noc_scheduler
+};
+
+// Scheduling server -- keeps designs and their tables resident between requests
+
+typedef struct {
+    NoC_scheduler *designs[MAX_SERVER_DESIGNS];    // Loaded designs, the index is the design id (NULL --> free slot)
+    Table_cache table_cache;                       // Route and testtime tables of all designs loaded so far
+    PSO_context *settings;                         // Settings every loaded design starts from
+    double *freq;                                  // Valid test frequencies (normalized wrt default test freq)
+    int num_freq;                                  // Number of valid test frequencies
+    long num_requests;                             // Number of requests served
+    int shutdown;                                  // Set by a shutdown request
+} Schedule_server;
+
 // Function declarations
 
 // Initializes the node structs with ids, core type and coordinates info
 void initialize_nodes (NoC_node *noc_nodes, int num_cores, int M_rows, int N_columns);
 
 // Reads the input and output core indices from the file and stores info in IO pair struct array 
-// Also configures the corresponding node structs as INPUT/OUTPUT CORES                      
-void configure_io_pairs (FILE* in_file, IO_pairs *io_pairs, NoC_node *noc_nodes, int num_io_pairs);
+// Also configures the corresponding node structs as INPUT/OUTPUT CORES, returns the number of valid io pairs read
+int configure_io_pairs (FILE* in_file, IO_pairs *io_pairs, NoC_node *noc_nodes, int num_cores, int num_io_pairs);
 
 // Reads the number of test patterns and scan chain lengths for each test core from the file and stores this info in node struct array
-void read_test_core_parameters (FILE* in_file, IO_pairs *io_pairs, NoC_node *noc_nodes, int num_cores, int num_test_cores);
+// Returns -1 if the parameters of a test core are missing or negative
+int read_test_core_parameters (FILE* in_file, IO_pairs *io_pairs, NoC_node *noc_nodes, int num_cores, int num_test_cores);
 
-// Finds testtime for the given mapping assuming there are no resource conflicts involved (XY routing, circuit switching)
-double find_individual_testtime (NoC_node *noc_nodes, int input_core, int output_core, int test_core, double frequency, double preemption_point);
+// Reads a complete SoC description (mesh dimensions, io pairs, test core parameters) from the given file
+// Returns -1 if the file cannot be read or the design does not fit the scheduler (test core and io pair limits, io cores)
+int read_noc_design (const char *file_name, NoC_design *design);
+
+// Frees the node structs, io pairs and IO schedule lists of a design
+void free_noc_design (NoC_design *design);
+
+// Hop length b/w two cores as used by the testtime model (1 if the cores share a row or column, 2 otherwise)
+int find_hop_length (int x1, int y1, int x2, int y2);
+
+// Finds a dimension-ordered route starting at src_core as a sequence of hops, returns the number of hops
+int find_dimension_order_route (int M_rows, int N_columns, int src_core, int x_first, int x_step, int num_x_hops, int y_step, int num_y_hops, Route_hop *hops);
+
+// Builds the route table (hop lengths and candidate routes, one entry per offset b/w two cores) for the given mesh dimensions and routing algorithm
+Route_table *create_route_table (int M_rows, int N_columns, int routing);
+
+// Index of the offset b/w two cores in the route table
+int find_route_offset (Route_table *route_table, int src_core, int dst_core);
+
+// Hop length b/w two cores as used by the testtime model, looked up in the route table
+int find_route_hop_length (Route_table *route_table, int src_core, int dst_core);
+
+// Stores the hops of candidate route route_no b/w two cores in hops (room for MAX_ROUTE_HOPS), returns their number
+int find_candidate_route (Route_table *route_table, int src_core, int dst_core, int route_no, Route_hop *hops);
+
+// Number of hops of candidate route route_no b/w two cores
+int find_candidate_route_length (Route_table *route_table, int src_core, int dst_core, int route_no);
+
+// Frees a route table
+void free_route_table (Route_table *route_table);
+
+// Routing algorithm for the given name (xy, yx, west-first, torus), -1 if the name is unknown
+int find_routing_algorithm (const char *name);
+
+// Builds the testtime table for the given design using the hop lengths of the given route table
+Testtime_table *create_testtime_table (NoC_design *design, Route_table *route_table);
+
+// Initializes an empty table cache
+void init_table_cache (Table_cache *cache);
+
+// Returns the testtime table for a design, reusing cached route and testtime tables wherever the design matches
+Testtime_table *acquire_testtime_table (Table_cache *cache, NoC_design *design, int routing);
+
+// Releases a testtime table obtained from acquire_testtime_table
+void release_testtime_table (Table_cache *cache, Testtime_table *testtime_table);
+
+// Frees all tables held by the cache
+void free_table_cache (Table_cache *cache);
+
+// Number of patterns per segment when a test is preempted at the given preemption point (fraction of its patterns per segment)
+int find_segment_patterns (int test_patterns, double preemption_point);
+
+// Number of segments a test is split into at the given preemption point
+int find_num_segments (int test_patterns, double preemption_point);
+
+// Finds testtime for a segment of num_patterns test patterns assuming there are no resource conflicts involved (circuit switching)
+double find_segment_testtime (NoC_node *noc_nodes, int input_core, int output_core, int test_core, double frequency, int num_patterns);
+
+// Same as find_segment_testtime, using the precomputed coefficients of a testtime table
+double lookup_segment_testtime (Testtime_table *testtime_table, int test_core, int io_pair, double frequency, int num_patterns);
 
 // Finds the communication cost for a given PSO particle mapping --> consider hops (circuit switching scenario) --> use testtime (non-preemptive, single frequency)
 void find_communication_cost (PSO_particle *pso_particle, NoC_node *noc_nodes, int num_cores, IO_pairs *io_pairs, int num_io_pairs);
 
-// Maintains an ordered list of all starttimes and endtimes (used to generate CLAP input) 
-void update_times_list (All_times **head, double time);
+// Maintains an ordered list of all starttimes and endtimes (used to generate CLAP input), nodes come from the evaluation arena
+void update_times_list (Eval_arena *arena, All_times **head, double time);
 
 // Creates IO schedule lists
 IO_head *create_IO_list_head ();
 
-// Updates IO schedule lists
-void update_IO_list (IO_head *head, double starttime, double endtime, int testcore);
+// Empties an IO schedule list (its nodes belong to the evaluation arena)
+void clear_IO_list (IO_head *head);
+
+// Updates IO schedule lists, nodes come from the evaluation arena
+void update_IO_list (Eval_arena *arena, IO_head *head, double starttime, double endtime, int testcore, int segment_no, int num_segments);
 
 // Creates an input list for the CLAP tool 
 void create_clap_input_list (Clap_inputs *head, IO_pairs *io_pairs, int num_io_pairs);
 
-// Populates the resource matrix with busytimes for all resources [links and router ports] in accordance with the XY-routing algorithm
-void find_resource_busytimes (PSO_particle *pso_particle, NoC_node *noc_nodes, int N_columns, int num_cores, IO_pairs *io_pairs, int num_io_pairs);
+// Populates the resource matrix with busytimes for all resources [links and router ports] along the least-loaded candidate routes
+// Returns EVAL_DOMINATED as soon as the total testtime is known to reach the cutoff (NO_CUTOFF --> always runs to completion)
+int find_resource_busytimes (PSO_particle *pso_particle, NoC_node *noc_nodes, int N_columns, int num_cores, IO_pairs *io_pairs, int num_io_pairs, PSO_context *context, double cutoff);
+
+// Finds the XY route from src_core to dst_core as a sequence of hops, returns the number of hops
+int find_xy_route (NoC_node *noc_nodes, int N_columns, int src_core, int dst_core, Route_hop *hops);
+
+// Creates an evaluation state for the given design (with journaling, the state can be rolled back to any position)
+Eval_state *create_eval_state (NoC_node *noc_nodes, int N_columns, int num_cores, IO_pairs *io_pairs, int num_io_pairs, PSO_context *context, int journaling);
+
+// Resets the evaluation state to an empty NoC
+void reset_eval_state (Eval_state *state);
+
+// Frees an evaluation state
+void free_eval_state (Eval_state *state);
+
+// Creates an evaluation arena with an arena block of the given size
+Eval_arena *create_eval_arena (size_t size);
+
+// Hands out size bytes from the evaluation arena (from an overflow block if the arena block is full)
+void *arena_alloc (Eval_arena *arena, size_t size);
+
+// Releases everything handed out by the evaluation arena in O(1); overflow blocks are merged into a larger arena block first
+void reset_eval_arena (Eval_arena *arena);
+
+// Frees an evaluation arena and all of its blocks
+void free_eval_arena (Eval_arena *arena);
+
+// Creates an empty cycle profile
+Profile *create_profile (void);
+
+// Prints the per-site cycle summary of a profile and writes its folded stacks (one "site;site;site cycles" line per stack, for
+// flame graph tools) to the given file, returns -1 if the file could not be written
+int report_profile (Profile *profile, FILE *out_file, const char *folded_file);
+
+// Schedules the first segment of the test core at the given position of the mapping on top of the current state, EVAL_DOMINATED once the cutoff is reached
+int schedule_test_core (Eval_state *state, Genome *mapping, int position);
+
+// Schedules the remaining segments of all preempted tests once every first segment is scheduled, EVAL_DOMINATED once the cutoff is reached
+int resume_preempted_tests (Eval_state *state, Genome *mapping);
+
+// Rolls a journaling evaluation state back to the point before the given position was scheduled
+void rollback_eval_state (Eval_state *state, int position);
+
+// Delta evaluation: reschedules the mapping from the given position onwards, reusing the scheduled prefix, returns the total testtime
+double evaluate_from (Eval_state *state, Genome *mapping, int position, double cutoff);
 
 // Initializes PSO particles by initializing the I/O core, frequencies and test core mapping; calculates the fitness value for each particle 
-void init_pso_particles (PSO_particle *pso_particle, Gbest_PSO_particle *gbest_pso_particle, NoC_node *noc_nodes, int num_cores, double *freq, int num_freq, IO_pairs *io_pairs, int num_io_pairs, int N_columns);
+void init_pso_particles (PSO_particle *pso_particle, Gbest_PSO_particle *gbest_pso_particle, NoC_node *noc_nodes, int num_cores, int num_freq, IO_pairs *io_pairs, int num_io_pairs, int N_columns, PSO_context *context);
+
+// Seeds the swarm from constructive schedules (longest test first, balanced io pairs or a list schedule on the resource model)
+// and Latin hypercube draws; sets the local and global bests
+void seed_pso_particles (Search_problem *problem, PSO_particle *pso_particle, Gbest_PSO_particle *gbest_pso_particle);
+
+// Initializes a mapping with a random test core sequence, io pairs, frequencies and preemption points
+void init_random_genome (Genome *mapping, int *test_cores, int num_test_cores, int num_io_pairs, int num_freq, unsigned short *rng_state);
+
+// Allocates the arrays of a mapping of num_tests tests (released by free_genome)
+void init_genome (Genome *mapping, int num_tests);
+
+// Copies mapping src into dst (allocated for the same number of tests)
+void copy_genome (Genome *dst, Genome *src);
+
+// Releases the arrays of a mapping
+void free_genome (Genome *mapping);
+
+// Seeds the random number generator of a PSO run
+void seed_pso_context (PSO_context *context, unsigned int seed);
+
+// Initializes run settings with the defaults of a single run (PSO, XY routing, adaptive coefficients, no checkpoints, replays or exports)
+void init_pso_context (PSO_context *context, FILE *out_file);
 
 // Generates random number between 0 and 1 (probability distribution: uniform)
-double generate_random_number ();
+double generate_random_number (unsigned short *rng_state);
 
 // Swaps io pairs with given probability 
-void swap_io_pair (int num_test_cores, double *a, double *b, double probability);
+void swap_io_pair (int num_test_cores, Genome *a, Genome *b, double probability, unsigned short *rng_state);
 
 // Checks frequency validity for newly assigned test core, swaps frequencies
-void swap_frequencies (int num_test_cores, double *a, double *b, double probability);
+void swap_frequencies (int num_test_cores, Genome *a, Genome *b, double probability, unsigned short *rng_state);
 
 // Generates a sequence of swap operators for evolving a given particle's test core sequence
-int generate_swap_operator_sequence (int num_test_cores, double *a, double *b, Swap_operator* swap_operator);
+int generate_swap_operator_sequence (int num_test_cores, Genome *a, Genome *b, Swap_operator* swap_operator, Swap_scratch *scratch);
+
+// Allocates the scratch space of the swap operator sequence generation for test cores numbered 1 .. num_cores
+Swap_scratch *create_swap_scratch (int num_test_cores, int num_cores);
+
+// Frees the scratch space of the swap operator sequence generation
+void free_swap_scratch (Swap_scratch *scratch);
 
 // Applies the sequence of swap operators on test core sequence a with give probability
-void swap_test_core_sequence (int num_test_cores, double *a, Swap_operator* swap_operator, int num_swap_operators, double probability);
+void swap_test_core_sequence (int num_test_cores, Genome *a, Swap_operator* swap_operator, int num_swap_operators, double probability, unsigned short *rng_state);
 
 // Modifies the preemption points for test cores in a given particle (new position of a particle in continuous PSO)
 // void modify_preemption_points (int num_test_cores, double *a, double *b, double *c);
 
-// Simulates Particle Swarm Optimization algorithm to determine the mapping with minimum cost
-void particle_swarm_optimization (NoC_node *noc_nodes, int num_cores, int M_rows, double *freq, int num_freq, IO_pairs *io_pairs, int num_io_pairs);
+// Adjusts the attraction probabilities of a PSO run after a generation in which num_improved particles improved their local best
+void adapt_pso_coefficients (PSO_context *context, PSO_particle *pso_particle, Gbest_PSO_particle *gbest_pso_particle, int num_test_cores, int num_improved);
+
+// Simulates Particle Swarm Optimization algorithm to determine the mapping with minimum cost, returns its total testtime
+double particle_swarm_optimization (Search_problem *problem, Genome *best);
+
+// Writes the complete optimiser state (particles, local and global bests, random state, generation counter) to a binary checkpoint file
+int save_pso_checkpoint (const char *file_name, PSO_particle *pso_particle, Gbest_PSO_particle *gbest_pso_particle, int num_cores, int num_io_pairs, PSO_context *context);
+
+// Restores the optimiser state from a checkpoint written by save_pso_checkpoint
+int load_pso_checkpoint (const char *file_name, PSO_particle *pso_particle, Gbest_PSO_particle *gbest_pso_particle, int num_cores, int num_io_pairs, PSO_context *context);
+
+// Computes the io workload, longest test and link cut lower bounds of a design and stores them in the context
+void compute_lower_bounds (NoC_node *noc_nodes, int N_columns, int num_cores, IO_pairs *io_pairs, int num_io_pairs, double *freq, int num_freq, PSO_context *context);
+
+// Relative gap b/w a total testtime and the best lower bound
+double find_optimality_gap (Lower_bounds *bounds, double testtime);
+
+// Refines the global best mapping by local search scored with delta evaluations
+void refine_global_best (Gbest_PSO_particle *gbest_pso_particle, NoC_node *noc_nodes, int N_columns, int num_cores, IO_pairs *io_pairs, int num_io_pairs, PSO_context *context);
+
+// Repairs the mapping of a binary schedule of an earlier version of the design to fit the design, returns the number of tests taken over
+// (-1 if the file could not be read or belongs to another mesh); *num_old_tests is set to the tests of the earlier schedule, *num_moved to those given a new io pair
+int repair_warm_start (const char *file_name, NoC_node *noc_nodes, int num_cores, int N_columns, IO_pairs *io_pairs, int num_io_pairs, double *freq, int num_freq,
+                       Genome *mapping, int *num_old_tests, int *num_moved);
+
+// Seeds the swarm with the repaired mapping of context->warm_start_file and its neighbours and refines the global best,
+// returns -1 (swarm untouched) if the file could not be read or belongs to another mesh
+int warm_start_pso_particles (Search_problem *problem, PSO_particle *pso_particle, Gbest_PSO_particle *gbest_pso_particle);
+
+// Creates an evaluator for the mappings of a search problem -- evaluate_from on it scores a mapping (the shared "score genome" interface)
+Eval_state *create_problem_evaluator (Search_problem *problem, int journaling);
+
+// Simulated annealing on the mapping, returns the total testtime of the best mapping found
+double simulated_annealing (Search_problem *problem, Genome *best);
+
+// Permutation genetic algorithm on the mapping, returns the total testtime of the best mapping found
+double genetic_algorithm (Search_problem *problem, Genome *best);
+
+// Tabu search on the mapping, returns the total testtime of the best mapping found
+double tabu_search (Search_problem *problem, Genome *best);
+
+// Exact branch-and-bound over test order and io pairs with every test unpreempted at the fastest frequency, returns the total testtime of the best mapping found
+double branch_and_bound (Search_problem *problem, Genome *best);
+
+// Splits the mesh into rectangular regions of whole io pairs by recursive bisection (balancing the test workload per io pair),
+// returns the number of regions (regions has room for one per io pair, their io pair lists are released by the caller)
+int partition_mesh_regions (NoC_design *design, Mesh_region *regions);
+
+// Hierarchical mode: schedules every region of the mesh with the selected engine in parallel, merges the region schedules by starttime
+// and repairs the merged mapping by local search on the whole mesh, returns the total testtime of the best mapping found
+double region_decomposed_search (Search_problem *problem, Genome *best);
+
+// Sets up the shared tables of a design, runs the search engine selected in the context and reports the best schedule, returns its total testtime
+double run_search_engine (NoC_node *noc_nodes, int num_cores, int M_rows, double *freq, int num_freq, IO_pairs *io_pairs, int num_io_pairs, PSO_context *context);
+
+// Runs every search engine num_runs times on a design with the same seeds and wall-clock budget and reports their time-to-quality
+void benchmark_search_engines (NoC_design *design, double *freq, int num_freq, PSO_context *settings, unsigned int seed, int num_runs, FILE *out_file);
+
+// Maps a search engine name (pso, sa, ga, tabu, bnb) to its ENGINE_* value, -1 if unknown
+int find_search_engine (const char *name);
+
+// Name of a search engine
+const char *find_search_engine_name (int engine);
+
+// Reads the batch manifest (one "<input file> [output file]" entry per line) and returns the number of jobs read (-1 on error)
+int read_batch_manifest (const char *manifest_file, Batch_job **jobs);
+
+// Schedules all jobs of a batch concurrently on a work-stealing pool of num_workers threads, returns the number of failed jobs
+int run_batch (Batch_job *jobs, int num_jobs, int num_workers, double *freq, int num_freq, PSO_context *settings);
+
+// Moves the io pairs of a design to the given placement; the test core parameters go to the remaining cores in their previous order
+void apply_io_placement (NoC_design *design, IO_placement *placement);
+
+// Allocates the io cores of a placement of num_io_pairs io pairs (released by free_io_placement)
+void init_io_placement (IO_placement *placement, int num_io_pairs);
+
+// Releases the io cores of a placement
+void free_io_placement (IO_placement *placement);
+
+// Searches for the io pair placement with the shortest total testtime -- hill climbing over moves of single io cores, every candidate
+// scored by a short inner search (cached by placement, pruned by its lower bounds, num_threads candidates at a time)
+// Returns the best total testtime of the inner searches and leaves the best placement in best (allocated for the design's io pairs)
+double search_io_placement (NoC_design *design, double *freq, int num_freq, PSO_context *settings, int num_threads, int max_rounds, int generations,
+                            unsigned int seed, IO_placement *best);
+
+// Initializes an empty calendar queue for at most max_events pending events, sized for expected_events over expected_span
+void init_calendar_queue (Calendar_queue *queue, int max_events, long expected_events, double expected_span);
+
+// Adds an event to the calendar queue, returns -1 if the event pool is exhausted
+int calendar_enqueue (Calendar_queue *queue, double time, int type, int segment);
+
+// Removes the earliest event from the calendar queue, returns -1 if the queue is empty
+int calendar_dequeue (Calendar_queue *queue, Sim_event *event);
+
+// Frees the buckets and the event pool of a calendar queue
+void free_calendar_queue (Calendar_queue *queue);
+
+// Replays the schedule held by a fully evaluated state at circuit setup, test packet and teardown level, returns -1 on event pool overflow
+int simulate_schedule (Eval_state *state, Genome *mapping, Sim_report *report);
+
+// Prints the result of a schedule replay (nothing if out_file is NULL)
+void print_sim_report (FILE *out_file, Sim_report *report);
+
+// Checks the schedule held by a fully evaluated state for router ports and links used by two segments at once, returns the number
+// of conflicts (-1 if out of memory)
+int check_schedule_conflicts (Eval_state *state, Conflict_report *report);
+
+// Prints the result of a conflict check (nothing if out_file is NULL)
+void print_conflict_report (FILE *out_file, Conflict_report *report);
+
+// Builds the binary schedule of a fully evaluated state in memory, returns -1 if out of memory
+int create_schedule_view (Eval_state *state, Genome *mapping, Lower_bounds *bounds, Schedule_view *view);
+
+// Writes a binary schedule to a file, returns -1 on failure
+int write_schedule_file (const char *file_name, Schedule_view *view);
+
+// Maps a binary schedule file read-only, returns -1 if it cannot be mapped or is not a valid schedule file (sections out of
+// the file or misaligned, record indices out of range)
+int map_schedule_file (const char *file_name, Schedule_view *view);
+
+// Releases a binary schedule built by create_schedule_view or mapped by map_schedule_file
+void free_schedule_view (Schedule_view *view);
+
+// Streams a binary schedule as CSV or JSON text
+void write_schedule_text (FILE *out_file, Schedule_view *view, int format);
+
+// Exports the schedule held by a fully evaluated state in the given format, returns -1 on failure
+int export_schedule (const char *file_name, int format, Eval_state *state, Genome *mapping, Lower_bounds *bounds);
+
+// Finds the export format with the given name (binary, csv, json), returns -1 if there is none
+int find_export_format (const char *name);
+
+// File name extension of an export format
+const char *find_export_extension (int format);
+
+// Initializes a scheduling server with no design loaded
+void init_schedule_server (Schedule_server *server, double *freq, int num_freq, PSO_context *settings);
+
+// Frees all designs and tables held by a scheduling server
+void free_schedule_server (Schedule_server *server);
+
+// Handles one request line and writes its response line, returns -1 if the client closes the connection
+int handle_server_request (Schedule_server *server, char *request, FILE *out_file);
+
+// Serves request lines from in_file until end of file, a quit or shutdown request or a stop request
+void serve_requests (Schedule_server *server, FILE *in_file, FILE *out_file);
+
+// Serves clients on a Unix socket one connection at a time until a shutdown or stop request, returns -1 if the socket cannot be set up
+int serve_unix_socket (Schedule_server *server, const char *socket_path);
 
 // Finds the maximum of two given numbers
 double max (double a, double b);
 
-// Prints the mapping and test schedule information for all PSO particles
-void print_pso_particle_info (PSO_particle *pso_particle, int num_test_cores);
+// Returns a monotonic wall-clock time in seconds
+double get_wall_time ();
+
+// Prints the resource matrix with calculated busytimes (links for src != dst, routers for src == dst), nothing if out_file is NULL
+void print_resource_matrix (FILE *out_file, Eval_state *state);
+
+// Prints the mapping and test schedule information for all PSO particles, nothing if out_file is NULL
+void print_pso_particle_info (FILE *out_file, PSO_particle *pso_particle, int num_particles, int num_test_cores, double *freq);
 
-// Prints the mapping and test schedule information for the global best PSO particle
-void print_global_best_info (Gbest_PSO_particle *gbest_pso_particle, int num_test_cores);
+// Prints the mapping and test schedule information for the global best PSO particle, nothing if out_file is NULL
+void print_global_best_info (FILE *out_file, Gbest_PSO_particle *gbest_pso_particle, int num_test_cores, double *freq);
 
-// Prints IO schedule lists
-void print_IO_schedule_lists (IO_head* head);
+// Prints IO schedule lists (nothing if out_file is NULL)
+void print_IO_schedule_lists (FILE *out_file, IO_head* head);
 
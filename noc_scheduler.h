@@ -0,0 +1,53 @@
+// ==================
+// SCHEDULING LIBRARY
+// ==================
+
+// Reentrant interface for embedding the scheduler in other tools (build noc_functions.c into the tool, no driver needed)
+// Every scheduler owns its design, tables, evaluation state, random stream and output, and keeps no global state, so different
+// schedulers can be used from different threads at the same time. One scheduler is used by one thread at a time, except for
+// cancel_noc_scheduler. Nothing is printed unless a log stream is set.
+
+#ifndef NOC_SCHEDULER_H
+#define NOC_SCHEDULER_H
+
+#include <stdio.h>
+
+// Opaque scheduler for one SoC description
+
+typedef struct _noc_scheduler NoC_scheduler;
+
+// One test of a mapping (mappings list the tests in test order)
+
+typedef struct {
+    int test_core;                                 // Core under test
+    int io_pair;                                   // IO pair of the first segment (1 .. number of io pairs)
+    double preemption;                             // Fraction of the test patterns per segment (1.0 --> not preempted)
+} NoC_test;
+
+// Reads a SoC description and prepares its tables for the given routing algorithm (NULL --> xy), returns NULL on failure
+NoC_scheduler *create_noc_scheduler (const char *input_file, const char *routing);
+
+// Sets the stream receiving the search trace and schedule reports (NULL --> no output, the default)
+void set_noc_scheduler_log (NoC_scheduler *scheduler, FILE *log_file);
+
+// Number of tests in a mapping of the design
+int get_noc_num_tests (NoC_scheduler *scheduler);
+
+// Lower bound on the total testtime of the design
+double get_noc_lower_bound (NoC_scheduler *scheduler);
+
+// Total testtime of a mapping (every test at the default test frequency), -1 if it is not a valid mapping of the design
+// Only the tests from the first one that differs from the previous call are rescheduled
+double evaluate_noc_schedule (NoC_scheduler *scheduler, const NoC_test *tests, int num_tests);
+
+// Searches for the best mapping with the given engine (pso, sa, ga, tabu, bnb; NULL --> pso) within time_limit seconds
+// (0 --> the default number of generations), stores it in best (if not NULL) and returns its total testtime, -1 on a bad argument
+double optimize_noc_schedule (NoC_scheduler *scheduler, const char *engine, double time_limit, unsigned int seed, NoC_test *best);
+
+// Makes the optimize_noc_schedule call in progress on the scheduler return its best mapping so far (callable from any thread)
+void cancel_noc_scheduler (NoC_scheduler *scheduler);
+
+// Frees a scheduler
+void free_noc_scheduler (NoC_scheduler *scheduler);
+
+#endif
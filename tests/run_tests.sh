@@ -0,0 +1,124 @@
+#!/bin/sh
+# Regression tests -- builds the driver into a scratch directory, runs every case on the designs in tests/designs and compares the
+# results with tests/expected
+# Usage: sh tests/run_tests.sh [extra compiler flags, e.g. -fsanitize=address]
+
+TESTS=$(cd "$(dirname "$0")" && pwd)
+REPO=$(dirname "$TESTS")
+DESIGNS="$TESTS/designs"
+EXPECTED="$TESTS/expected"
+WORK=$(mktemp -d)
+CC=${CC:-gcc}
+failed=0
+
+trap 'rm -rf "$WORK"' EXIT
+
+$CC -O2 "$@" -o "$WORK/noc_driver" "$REPO/noc_driver.c" "$REPO/noc_functions.c" -lm -lpthread || exit 1
+$CC -O2 "$@" -o "$WORK/schedule_text" "$TESTS/schedule_text.c" "$REPO/noc_functions.c" -lm -lpthread || exit 1
+$CC -O2 "$@" -o "$WORK/schedule_conflicts" "$TESTS/schedule_conflicts.c" "$REPO/noc_functions.c" -lm -lpthread || exit 1
+NOC="$WORK/noc_driver"
+SCHEDULE_TEXT="$WORK/schedule_text"
+SCHEDULE_CONFLICTS="$WORK/schedule_conflicts"
+cd "$WORK" || exit 1
+
+# Reports a case as passed if both files are identical, shows the difference otherwise
+check () {
+    if cmp -s "$2" "$3"; then
+        echo "PASS $1"
+    else
+        echo "FAIL $1"
+        diff "$2" "$3" | head -20
+        failed=1
+    fi
+}
+
+# Final report of a run: everything from the last global best on (the evaluation counters depend on the run's history)
+final_report () {
+    awk '/Global best info/ { report = "" } { report = report $0 "\n" } END { printf "%s", report }' "$1" | grep -v "Evaluations:"
+}
+
+# Best mapping and total testtime of a run
+best_mapping () {
+    final_report "$1" | sed -n '1,6p'
+}
+
+
+# Checkpoint and resume: a run resumed from the checkpoint of generation 5 ends exactly like the uninterrupted run
+"$NOC" --seed 7 --generations 10 "$DESIGNS/mesh3x4_2io.txt" > full.out
+"$NOC" --seed 7 --generations 5 --checkpoint run.ckpt --checkpoint-every 5 "$DESIGNS/mesh3x4_2io.txt" > half.out
+"$NOC" --seed 7 --generations 10 --resume run.ckpt "$DESIGNS/mesh3x4_2io.txt" > resumed.out
+final_report full.out > full.report
+final_report resumed.out > resumed.report
+check "resume: same final schedule as the uninterrupted run" full.report resumed.report
+best_mapping full.out > full.best
+check "resume: best mapping of mesh3x4_2io" "$EXPECTED/resume_mesh3x4_2io.txt" full.best
+
+
+# Branch and bound: proven optimum of every design under every routing (the table of explored partial schedules is used with xy
+# and yx only), and the reported schedule has that total testtime
+for design in mesh3x3_1io mesh3x4_2io mesh3x4_2io_b; do
+    for routing in xy yx west-first torus; do
+        "$NOC" --engine bnb --threads 2 --routing $routing "$DESIGNS/$design.txt" > bnb.out
+        echo "$design $routing:$(grep "optimal total testtime" bnb.out)$(grep "Total testtime for given mapping" bnb.out | tail -1)"
+    done
+done > bnb.results
+check "bnb: optimum of every design and routing" "$EXPECTED/bnb_optimum.txt" bnb.results
+
+
+# Export: a binary schedule mapped with map_schedule_file streams the same CSV and JSON as the driver's own text exports of the
+# same run (an optimal schedule, and a preempted one); a truncated schedule file is rejected
+for format in binary csv json; do
+    "$NOC" --engine bnb --threads 1 --export $format --export-file bnb.$format "$DESIGNS/mesh3x3_1io.txt" > /dev/null
+    "$NOC" --seed 3 --generations 5 --export $format --export-file pso.$format "$DESIGNS/mesh3x4_2io.txt" > /dev/null
+done
+for run in bnb pso; do
+    for format in csv json; do
+        "$SCHEDULE_TEXT" $run.binary $format > $run.mapped.$format
+        check "export: $run schedule mapped from the binary file as $format" $run.$format $run.mapped.$format
+    done
+done
+check "export: optimal schedule of mesh3x3_1io" "$EXPECTED/export_mesh3x3_1io.csv" bnb.csv
+head -c 100 bnb.binary > truncated.binary
+if "$SCHEDULE_TEXT" truncated.binary csv > /dev/null 2>&1; then
+    echo "FAIL export: truncated schedule file is rejected"
+    failed=1
+else
+    echo "PASS export: truncated schedule file is rejected"
+fi
+
+
+# Conflicts: two circuits started at once that share one router port (core 2 on io pair 1 and core 8 on io pair 2 both leave router 4
+# towards router 8 under xy routing) -- the conflict check reports that port and both cores, the replay delays core 8 until core 2 is
+# torn down; the reported schedule of a run has no conflicts, and its replay reports the conflicts and delays of circuit setup
+"$SCHEDULE_CONFLICTS" "$DESIGNS/mesh3x4_2io.txt" 2:1 8:2 > overlap.out
+check "conflicts: known overlap found by the check and the replay" "$EXPECTED/conflicts_overlap.txt" overlap.out
+"$NOC" --seed 3 --generations 3 --validate --check "$DESIGNS/mesh3x4_2io.txt" | grep "Validation:\|Conflict check:" > validate.out
+check "conflicts: check and replay of the reported schedule of mesh3x4_2io" "$EXPECTED/validate_mesh3x4_2io.txt" validate.out
+
+
+# Server: responses to a session of load, evaluate (full, reused and partly reused evaluations, invalid mappings), optimize,
+# stats and unload requests -- timings are left out
+"$NOC" --serve > server.out << EOF
+load $DESIGNS/mesh3x4_2io.txt
+load $DESIGNS/mesh3x4_2io.txt
+load $DESIGNS/mesh3x3_1io.txt
+evaluate 0 10:2 8:2 5:1 7:2 6:1 3:1 11:1 2:2
+evaluate 0 10:2 8:2 5:1 7:2 6:1 3:1 11:1 2:2
+evaluate 0 10:2 8:2 5:1 7:2 6:2 3:1 11:1 2:2
+evaluate $DESIGNS/mesh3x4_2io.txt 10:2:0:0.5 8:2:0:0.24 5:1 7:2 6:1 3:1 11:1 2:2
+evaluate 0 10:2 8:2
+evaluate 0 10:2 8:2 5:1 7:2 6:1 3:1 11:1 4:2
+evaluate 0 10:3 8:2 5:1 7:2 6:1 3:1 11:1 2:2
+evaluate 7 10:2
+optimize 1 5 bnb
+optimize 1 1 nosuch
+stats
+unload 1
+evaluate 1 2:1
+quit
+EOF
+sed -e 's/ time_us [0-9.]*//' -e 's/ time_s [0-9.]*//' server.out > server.responses
+check "server: responses of a session" "$EXPECTED/server_session.txt" server.responses
+
+[ $failed -eq 0 ] && echo "All tests passed"
+exit $failed
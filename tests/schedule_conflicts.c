@@ -0,0 +1,75 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../noc_header.h"
+
+// Test helper -- builds a schedule with a known overlap and prints what check_schedule_conflicts and simulate_schedule report on it
+// Usage: schedule_conflicts <design file> <core>:<io pair> <core>:<io pair>
+// Both tests are evaluated unpreempted at the base frequency (xy routing), then their segments are moved to start at 0 and every other
+// segment is dropped, so the two circuits overlap on every router port they share
+
+int main (int argc, char **argv) {
+    NoC_design design;
+    PSO_context context;
+    Genome mapping;
+    Eval_state *state;
+    Test_segment kept[2];
+    Conflict_report conflicts;
+    Sim_report replay;
+    double freq[1] = {1.0};
+    int num_tests = 0;
+
+    if (argc != 4 || read_noc_design (argv[1], &design) != 0) {
+        fprintf(stderr, "Usage: %s <design file> <core>:<io pair> <core>:<io pair>\n", argv[0]);
+        return 2;
+    }
+
+    init_pso_context (&context, NULL);
+    context.route_table = create_route_table (design.M_rows, design.N_columns, ROUTING_XY);
+    context.freq = freq;
+    context.num_freq = 1;
+
+    // The two tests first, the other test cores after them
+    init_genome (&mapping, design.num_test_cores);
+    for (int t = 0; t < 2; t++)
+        if (sscanf (argv[t + 2], "%hd:%hhu", &mapping.test_core[t], &mapping.io_pair[t]) != 2) {
+            fprintf(stderr, "Bad test %s\n", argv[t + 2]);
+            return 2;
+        }
+    num_tests = 2;
+    for (int i = 0; i < design.num_cores; i++)
+        if (design.noc_nodes[i].core_type == TEST_CORE && design.noc_nodes[i].core_no != mapping.test_core[0] && design.noc_nodes[i].core_no != mapping.test_core[1])
+            mapping.test_core[num_tests++] = (short) design.noc_nodes[i].core_no;
+    for (int i = 0; i < design.num_test_cores; i++) {
+        if (i >= 2)
+            mapping.io_pair[i] = 1;
+        mapping.freq_index[i] = 0;
+        mapping.preemption[i] = PREEMPTION_MAX;
+    }
+
+    state = create_eval_state (design.noc_nodes, design.N_columns, design.num_cores, design.io_pairs, design.num_io_pairs, &context, 0);
+    evaluate_from (state, &mapping, 0, NO_CUTOFF);
+
+    // Keep the segments of the two tests, both starting at 0
+    for (int s = 0; s < state->num_segments; s++)
+        if (state->segments[s].position < 2) {
+            kept[state->segments[s].position] = state->segments[s];
+            kept[state->segments[s].position].endtime -= state->segments[s].starttime;
+            kept[state->segments[s].position].starttime = 0.0;
+        }
+    state->segments[0] = kept[0];
+    state->segments[1] = kept[1];
+    state->num_segments = 2;
+    state->makespan = max(kept[0].endtime, kept[1].endtime);
+
+    check_schedule_conflicts (state, &conflicts);
+    print_conflict_report (stdout, &conflicts);
+    simulate_schedule (state, &mapping, &replay);
+    print_sim_report (stdout, &replay);
+
+    free_eval_state (state);
+    free_genome (&mapping);
+    free_route_table (context.route_table);
+    free_noc_design (&design);
+    return 0;
+}
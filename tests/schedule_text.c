@@ -0,0 +1,25 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../noc_header.h"
+
+// Test helper -- maps a binary schedule file with map_schedule_file and streams it as CSV or JSON text
+// Usage: schedule_text <schedule file> csv|json
+// Exits with 1 if the file is not a valid schedule file
+
+int main (int argc, char **argv) {
+    Schedule_view view;
+
+    if (argc != 3 || (strcmp (argv[2], "csv") != 0 && strcmp (argv[2], "json") != 0)) {
+        fprintf(stderr, "Usage: %s <schedule file> csv|json\n", argv[0]);
+        return 2;
+    }
+    if (map_schedule_file (argv[1], &view) != 0) {
+        fprintf(stderr, "%s is not a valid schedule file\n", argv[1]);
+        return 1;
+    }
+
+    write_schedule_text (stdout, &view, (strcmp (argv[2], "csv") == 0) ? EXPORT_CSV : EXPORT_JSON);
+    free_schedule_view (&view);
+    return 0;
+}